@@ -1,12 +1,29 @@
 #version 450
 
 layout(location = 0) in vec2 fragTexCoords;
+layout(location = 1) flat in uint fragTextureIndex;
+layout(location = 2) flat in float fragBrightness;
 
 layout(location = 0) out vec4 outColor;
 
 layout(binding = 0) uniform sampler2D texSampler;
+layout(binding = 1) uniform sampler2D glyphCacheSampler;
+
+//Atlas holds multi-channel sdf, distance is the median of rgb
+layout(constant_id = 0) const bool isMultiChannel = false;
+
+float median(vec3 value)
+{
+	return max(min(value.r, value.g), min(max(value.r, value.g), value.b));
+}
 
 void main()
 {
-	outColor = vec4(texture(texSampler, fragTexCoords).r, 0.0, 0.0, 1.0);
+	//Sample the atlas outside the branch to keep derivatives for mip selection valid, the glyph cache has no mips
+	vec4 atlasValue = texture(texSampler, fragTexCoords);
+	float value = isMultiChannel ? median(atlasValue.rgb) : atlasValue.r;
+	if(fragTextureIndex == 1)
+		value = textureLod(glyphCacheSampler, fragTexCoords, 0.0).r;
+
+	outColor = vec4(value * fragBrightness, 0.0, 0.0, 1.0);
 }
\ No newline at end of file
@@ -10,11 +10,40 @@ layout (buffer_reference, scalar) readonly buffer QuadReference
 	vec2 scale;
 };
 
+layout (buffer_reference, scalar) readonly buffer GlyphIndexReference
+{
+	uint glyphIndex;
+};
+
+layout (buffer_reference, scalar) readonly buffer GlyphRectReference
+{
+	vec2 uvMin;
+	vec2 uvMax;
+	vec2 tileMin;
+	vec2 tileMax;
+	uint textureIndex;
+};
+
+//Field of view mask, bit x % 32 of word x / 32 in row y is set for visible cells, rows and bits wrap around every fogMaskSize cells
+layout (buffer_reference, scalar) readonly buffer FogReference
+{
+	uint words[];
+};
+
+//Must match RenderEngine::PushConstantsBlock
 layout (push_constant) uniform PushConstants
 {
 	QuadReference quadDataReference;
+	GlyphIndexReference glyphIndexReference;
+	GlyphRectReference glyphRectReference;
+	FogReference fogReference;
+	ivec2 fogOrigin;
 } pushConstants;
 
+//Must match World::cellWidth, World::cellHeight and FieldOfView::maskSize
+const vec2 cellSize = vec2(0.04, 0.08);
+const int fogMaskSize = 128;
+
 vec2 positions[4] = vec2[4](
 	vec2(-1.0, -1.0),
 	vec2(1.0, -1.0),
@@ -23,12 +52,33 @@ vec2 positions[4] = vec2[4](
 );
 
 layout(location = 0) out vec2 fragTexCoords;
+layout(location = 1) flat out uint fragTextureIndex;
+layout(location = 2) flat out float fragBrightness;
+
+bool isCellVisible(vec2 position)
+{
+	ivec2 cell = ivec2(floor(position / cellSize));
+	ivec2 maskCell = cell - pushConstants.fogOrigin;
+	if(any(lessThan(maskCell, ivec2(0))) || any(greaterThanEqual(maskCell, ivec2(fogMaskSize))))
+		return false;
+
+	ivec2 wrappedCell = cell & (fogMaskSize - 1);
+	uint word = pushConstants.fogReference.words[wrappedCell.y * (fogMaskSize / 32) + wrappedCell.x / 32];
+	return ((word >> (wrappedCell.x % 32)) & 1u) != 0u;
+}
 
 void main()
 {
 	QuadReference quadData = pushConstants.quadDataReference[gl_InstanceIndex];
+	GlyphRectReference glyphRect = pushConstants.glyphRectReference[pushConstants.glyphIndexReference[gl_InstanceIndex].glyphIndex];
+
+	//Shrink quad to the part of the tile covered by the glyph
+	vec2 corner = positions[gl_VertexIndex] * 0.5 + 0.5;
+	vec2 position = mix(glyphRect.tileMin, glyphRect.tileMax, corner) * 2.0 - 1.0;
 
-	gl_Position = vec4((positions[gl_VertexIndex].x * quadData.scale.x + quadData.position.x) / 16.0 * 9.0, positions[gl_VertexIndex].y * quadData.scale.y + quadData.position.y, 0.0, 1.0);
-	fragTexCoords = positions[gl_VertexIndex];
-	//fragTexCoords = vec2(1.0 / 16.0 * (quadData.glyphIndex % 16), 1.0 / 16.0 * (quadData.glyphIndex / 16));
+	gl_Position = vec4((position.x * quadData.scale.x + quadData.position.x) / 16.0 * 9.0, position.y * quadData.scale.y + quadData.position.y, 0.0, 1.0);
+	fragTexCoords = mix(glyphRect.uvMin, glyphRect.uvMax, corner);
+	fragTextureIndex = glyphRect.textureIndex;
+	//Quads outside the field of view are dimmed
+	fragBrightness = isCellVisible(quadData.position) ? 1.0 : 0.3;
 }
\ No newline at end of file
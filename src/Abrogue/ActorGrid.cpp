@@ -0,0 +1,54 @@
+module ActorGrid;
+
+void ActorGrid::release()
+{
+	buckets.clear();
+	positions.clear();
+	bucketKeys.clear();
+	bucketIndices.clear();
+}
+
+void ActorGrid::place(std::uint32_t actor, double x, double y)
+{
+	if(actor >= positions.size())
+	{
+		positions.resize(actor + 1);
+		bucketKeys.resize(actor + 1);
+		bucketIndices.resize(actor + 1, notPlaced);
+	}
+
+	positions[actor] = {x, y};
+	auto [bucketX, bucketY] = getBucketOf(x, y);
+	auto key = getBucketKey(bucketX, bucketY);
+	if(bucketIndices[actor] != notPlaced)
+	{
+		if(bucketKeys[actor] == key)
+			return;
+
+		//Last actor of the old bucket takes the place of this one
+		auto& oldBucket = buckets[bucketKeys[actor]];
+		auto movedActor = oldBucket.back();
+		oldBucket[bucketIndices[actor]] = movedActor;
+		bucketIndices[movedActor] = bucketIndices[actor];
+		oldBucket.pop_back();
+	}
+
+	auto& bucket = buckets[key];
+	bucketKeys[actor] = key;
+	bucketIndices[actor] = static_cast<std::uint32_t>(bucket.size());
+	bucket.push_back(actor);
+}
+
+std::span<std::uint32_t const> ActorGrid::getBucket(std::int32_t bucketX, std::int32_t bucketY)
+{
+	auto bucket = buckets.find(getBucketKey(bucketX, bucketY));
+	if(bucket == buckets.end())
+		return {};
+	return bucket->second;
+}
+
+std::pair<std::int32_t, std::int32_t> ActorGrid::getBucketOf(double x, double y)
+{
+	auto [cellX, cellY] = World::getCell(x, y);
+	return {cellX >> bucketShift, cellY >> bucketShift};
+}
@@ -0,0 +1,34 @@
+export module ActorGrid;
+
+export import std;
+export import World;
+
+//Actors bucketed by the square of cells they're in, so queries only look at actors near them
+export class ActorGrid
+{
+public:
+	//Buckets are squares of 1 << bucketShift cells
+	static constexpr std::int32_t bucketShift{3};
+	//Box an actor is hit with around its position, matching its quad
+	static constexpr double halfWidth{0.02}, halfHeight{0.04};
+
+	static void release();
+
+	//Inserts the actor or moves it, it only changes buckets when it crosses into another one
+	static void place(std::uint32_t actor, double x, double y);
+
+	[[nodiscard]] static std::pair<double, double> getPosition(std::uint32_t actor) { return positions[actor]; }
+	[[nodiscard]] static std::span<std::uint32_t const> getBucket(std::int32_t bucketX, std::int32_t bucketY);
+	[[nodiscard]] static std::pair<std::int32_t, std::int32_t> getBucketOf(double x, double y);
+
+private:
+	static constexpr std::uint32_t notPlaced{std::numeric_limits<std::uint32_t>::max()};
+
+	static std::uint64_t getBucketKey(std::int32_t bucketX, std::int32_t bucketY) { return std::uint64_t(std::uint32_t(bucketX)) << 32 | std::uint32_t(bucketY); }
+
+	inline static std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> buckets;
+	//Per actor, its bucket and place in it so moving out of it doesn't search
+	inline static std::vector<std::pair<double, double>> positions;
+	inline static std::vector<std::uint64_t> bucketKeys;
+	inline static std::vector<std::uint32_t> bucketIndices;
+};
@@ -0,0 +1,285 @@
+module DungeonGenerator;
+
+import JobSystem;
+
+DungeonMap DungeonGenerator::generate(std::uint64_t seed, std::int32_t width, std::int32_t height)
+{
+	auto regionsX = std::max(1, (width + regionSize - 1) / regionSize);
+	auto regionsY = std::max(1, (height + regionSize - 1) / regionSize);
+
+	DungeonMap map;
+	map.width = regionsX * regionSize;
+	map.height = regionsY * regionSize;
+	map.wordsPerRow = map.width / 64;
+	map.wallRows.resize(std::size_t(map.wordsPerRow) * map.height);
+
+	JobSystem::parallelFor(std::size_t(regionsX) * regionsY, [&](std::size_t index)
+	{
+		auto regionX = static_cast<std::int32_t>(index % regionsX), regionY = static_cast<std::int32_t>(index / regionsX);
+		auto region = std::make_unique<Region>();
+		generateRegion(*region, seed, regionX, regionY, regionsX, regionsY);
+		for(std::int32_t y = 0; y < regionSize; y++)
+		{
+			auto mapRow = map.wallRows.data() + std::size_t(regionY * regionSize + y) * map.wordsPerRow + regionX * regionWords;
+			std::ranges::copy_n(&(*region)[y * regionWords], regionWords, mapRow);
+		}
+	});
+	return map;
+}
+
+std::pair<std::int32_t, std::int32_t> DungeonGenerator::getSpawnCell(std::int32_t width, std::int32_t height)
+{
+	return {width / regionSize / 2 * regionSize + regionSize / 2, height / regionSize / 2 * regionSize + regionSize / 2};
+}
+
+std::uint64_t DungeonGenerator::Random::next()
+{
+	state += 0x9e3779b97f4a7c15;
+	return mix(state);
+}
+
+std::int32_t DungeonGenerator::Random::next(std::int32_t min, std::int32_t max)
+{
+	return min + static_cast<std::int32_t>(next() % std::uint64_t(max - min));
+}
+
+std::uint64_t DungeonGenerator::mix(std::uint64_t value)
+{
+	//splitmix64 finalizer
+	value = (value ^ value >> 30) * 0xbf58476d1ce4e5b9;
+	value = (value ^ value >> 27) * 0x94d049bb133111eb;
+	return value ^ value >> 31;
+}
+
+std::uint64_t DungeonGenerator::hashPosition(std::uint64_t seed, std::int32_t x, std::int32_t y, std::uint32_t salt)
+{
+	return mix(seed + mix(std::uint64_t(std::uint32_t(x)) | std::uint64_t(std::uint32_t(y)) << 32) + salt * 0x9e3779b97f4a7c15);
+}
+
+void DungeonGenerator::generateRegion(Region& region, std::uint64_t seed, std::int32_t regionX, std::int32_t regionY, std::int32_t regionsX, std::int32_t regionsY)
+{
+	auto regionSeed = hashPosition(seed, regionX, regionY, 0);
+	Random random{regionSeed};
+	if(regionSeed % 3 == 0)
+		generateCaves(region, random);
+	else
+		generateRooms(region, random);
+
+	//Hub room every region connects its doors to, so the whole map is reachable
+	constexpr std::int32_t center{regionSize / 2};
+	carveRect(region, center - 4, center - 2, center + 4, center + 2);
+
+	//Doors are picked per edge, both regions sharing it carve up to the same row or column from their side
+	constexpr std::int32_t doorMargin{8};
+	auto getDoor = [seed](std::int32_t x, std::int32_t y, std::uint32_t salt) { return doorMargin + static_cast<std::int32_t>(hashPosition(seed, x, y, salt) % (regionSize - 2 * doorMargin)); };
+	if(regionX > 0)
+		carveCorridor(region, 0, getDoor(regionX - 1, regionY, 1), center, center, true);
+	if(regionX + 1 < regionsX)
+		carveCorridor(region, regionSize - 1, getDoor(regionX, regionY, 1), center, center, true);
+	if(regionY > 0)
+		carveCorridor(region, getDoor(regionX, regionY - 1, 2), 0, center, center, false);
+	if(regionY + 1 < regionsY)
+		carveCorridor(region, getDoor(regionX, regionY, 2), regionSize - 1, center, center, false);
+
+	//Close the map border
+	for(std::int32_t y = 0; y < regionSize; y++)
+	{
+		auto row = &region[y * regionWords];
+		if(regionX == 0)
+			row[0] |= 1;
+		if(regionX + 1 == regionsX)
+			row[regionWords - 1] |= std::uint64_t{1} << 63;
+		if((regionY == 0 && y == 0) || (regionY + 1 == regionsY && y == regionSize - 1))
+			std::ranges::fill(row, row + regionWords, ~std::uint64_t{});
+	}
+}
+
+void DungeonGenerator::generateCaves(Region& region, Random& random)
+{
+	//Walls with 7/16 chance, built from whole random words instead of per cell
+	for(auto& word : region)
+	{
+		auto a = random.next(), b = random.next(), c = random.next(), d = random.next();
+		word = a & (b | c | d);
+	}
+
+	Region buffer;
+	for(std::uint32_t i = 0; i < 2; i++)
+	{
+		stepCaves(region, buffer);
+		stepCaves(buffer, region);
+	}
+}
+
+void DungeonGenerator::generateRooms(Region& region, Random& random)
+{
+	region.fill(~std::uint64_t{});
+
+	constexpr std::uint32_t maxRooms{16}, maxAttempts{32};
+	std::vector<Room> rooms;
+	rooms.reserve(maxRooms);
+	for(std::uint32_t attempt = 0; attempt < maxAttempts && rooms.size() < maxRooms; attempt++)
+	{
+		Room room{0, 0, random.next(5, 21), random.next(3, 11)};
+		room.x = random.next(2, regionSize - room.width - 2);
+		room.y = random.next(2, regionSize - room.height - 2);
+
+		//Keep a wall between rooms
+		auto isOverlapping = std::ranges::any_of(rooms, [&room](Room const& other)
+		{
+			return room.x - 2 < other.x + other.width && other.x - 2 < room.x + room.width && room.y - 2 < other.y + other.height && other.y - 2 < room.y + room.height;
+		});
+		if(isOverlapping)
+			continue;
+
+		carveRect(region, room.x, room.y, room.x + room.width - 1, room.y + room.height - 1);
+		if(!rooms.empty())
+			carveCorridor(region, rooms.back().getCenterX(), rooms.back().getCenterY(), room.getCenterX(), room.getCenterY(), random.next() & 1);
+		rooms.push_back(room);
+	}
+
+	if(!rooms.empty())
+		carveCorridor(region, rooms.front().getCenterX(), rooms.front().getCenterY(), regionSize / 2, regionSize / 2, random.next() & 1);
+}
+
+void DungeonGenerator::stepCaves(Region const& source, Region& destination)
+{
+	constexpr auto allWalls = ~std::uint64_t{};
+	//West, center and east neighbors of 64 cells, row is null outside the region
+	auto getNeighbors = [](std::uint64_t const* row, std::int32_t word) -> std::array<std::uint64_t, 3>
+	{
+		if(!row)
+			return {allWalls, allWalls, allWalls};
+		auto center = row[word];
+		auto west = center << 1 | (word > 0 ? row[word - 1] >> 63 : 1);
+		auto east = center >> 1 | (word + 1 < regionWords ? row[word + 1] : allWalls) << 63;
+		return {west, center, east};
+	};
+	auto fullAdd = [](std::uint64_t a, std::uint64_t b, std::uint64_t c) -> std::pair<std::uint64_t, std::uint64_t>
+	{
+		return {a ^ b ^ c, (a & b) | (c & (a ^ b))};
+	};
+
+	for(std::int32_t y = 0; y < regionSize; y++)
+	{
+		auto above = y > 0 ? &source[(y - 1) * regionWords] : nullptr;
+		auto middle = &source[y * regionWords];
+		auto below = y + 1 < regionSize ? &source[(y + 1) * regionWords] : nullptr;
+		for(std::int32_t word = 0; word < regionWords; word++)
+		{
+			auto [a, b, c] = getNeighbors(above, word);
+			auto [d, e, f] = getNeighbors(middle, word);
+			auto [g, h, i] = getNeighbors(below, word);
+
+			//Bit sliced sum of the 9 cells, one 4 bit counter per cell spread over count0 to count3
+			auto [sum0, carry0] = fullAdd(a, b, c);
+			auto [sum1, carry1] = fullAdd(d, e, f);
+			auto [sum2, carry2] = fullAdd(g, h, i);
+			auto [count0, carry3] = fullAdd(sum0, sum1, sum2);
+			auto [twos, carry4] = fullAdd(carry0, carry1, carry2);
+			auto count1 = twos ^ carry3;
+			auto carry5 = twos & carry3;
+			auto count2 = carry4 ^ carry5;
+			auto count3 = carry4 & carry5;
+
+			destination[y * regionWords + word] = count3 | (count2 & (count1 | count0));
+		}
+	}
+}
+
+void DungeonGenerator::carveRect(Region& region, std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1)
+{
+	x0 = std::max(x0, 0);
+	y0 = std::max(y0, 0);
+	x1 = std::min(x1, regionSize - 1);
+	y1 = std::min(y1, regionSize - 1);
+	if(x0 > x1 || y0 > y1)
+		return;
+
+	for(std::int32_t word = x0 / 64; word <= x1 / 64; word++)
+	{
+		auto first = std::max(x0, word * 64) - word * 64, last = std::min(x1, word * 64 + 63) - word * 64;
+		auto mask = ~std::uint64_t{} >> (63 - (last - first)) << first;
+		for(std::int32_t y = y0; y <= y1; y++)
+			region[y * regionWords + word] &= ~mask;
+	}
+}
+
+void DungeonGenerator::carveCorridor(Region& region, std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, bool isHorizontalFirst)
+{
+	if(isHorizontalFirst)
+	{
+		carveRect(region, std::min(x0, x1), y0, std::max(x0, x1), y0);
+		carveRect(region, x1, std::min(y0, y1), x1, std::max(y0, y1));
+	}
+	else
+	{
+		carveRect(region, x0, std::min(y0, y1), x0, std::max(y0, y1));
+		carveRect(region, std::min(x0, x1), y1, std::max(x0, x1), y1);
+	}
+}
+
+DungeonLevel::DungeonLevel(std::uint64_t newSeed, std::int32_t width, std::int32_t height) : seed{newSeed},
+	regionsX{std::max(1, (width + DungeonGenerator::regionSize - 1) / DungeonGenerator::regionSize)},
+	regionsY{std::max(1, (height + DungeonGenerator::regionSize - 1) / DungeonGenerator::regionSize)}
+{
+}
+
+bool DungeonLevel::getIsWall(std::int32_t x, std::int32_t y) const
+{
+	if(x < 0 || y < 0 || x >= getWidth() || y >= getHeight())
+		return true;
+	return getWord(x / 64, y) >> (x % 64) & 1;
+}
+
+std::uint32_t DungeonLevel::getRowBits(std::int32_t x, std::int32_t y) const
+{
+	//Floored so cells left of the level land in words outside it
+	auto wordX = (x >= 0 ? x : x - 63) / 64, shift = x - wordX * 64;
+	auto bits = getWord(wordX, y) >> shift;
+	if(shift > 32)
+		bits |= getWord(wordX + 1, y) << (64 - shift);
+	return static_cast<std::uint32_t>(bits);
+}
+
+void DungeonLevel::dropRegions(std::int32_t x, std::int32_t y, std::int32_t radius)
+{
+	auto centerX = x / DungeonGenerator::regionSize, centerY = y / DungeonGenerator::regionSize;
+	std::scoped_lock lock(regionMutex);
+	std::erase_if(regions, [centerX, centerY, radius](auto const& entry)
+	{
+		auto regionX = static_cast<std::int32_t>(entry.first >> 32), regionY = static_cast<std::int32_t>(entry.first & 0xffffffff);
+		return std::max(std::abs(regionX - centerX), std::abs(regionY - centerY)) > radius;
+	});
+}
+
+std::size_t DungeonLevel::getRegionCount() const
+{
+	std::scoped_lock lock(regionMutex);
+	return regions.size();
+}
+
+std::uint64_t DungeonLevel::getWord(std::int32_t wordX, std::int32_t y) const
+{
+	if(wordX < 0 || y < 0 || wordX >= regionsX * DungeonGenerator::regionWords || y >= getHeight())
+		return ~std::uint64_t{};
+
+	auto region = getRegion(wordX / DungeonGenerator::regionWords, y / DungeonGenerator::regionSize);
+	return (*region)[y % DungeonGenerator::regionSize * DungeonGenerator::regionWords + wordX % DungeonGenerator::regionWords];
+}
+
+std::shared_ptr<DungeonGenerator::Region const> DungeonLevel::getRegion(std::int32_t regionX, std::int32_t regionY) const
+{
+	auto key = std::uint64_t(std::uint32_t(regionX)) << 32 | std::uint32_t(regionY);
+	{
+		std::scoped_lock lock(regionMutex);
+		if(auto region = regions.find(key); region != regions.end())
+			return region->second;
+	}
+
+	//Generated outside the lock so readers of other regions don't wait, a region generated twice comes out the same
+	auto region = std::make_shared<DungeonGenerator::Region>();
+	DungeonGenerator::generateRegion(*region, seed, regionX, regionY, regionsX, regionsY);
+	std::scoped_lock lock(regionMutex);
+	return regions.try_emplace(key, std::move(region)).first->second;
+}
@@ -0,0 +1,100 @@
+export module DungeonGenerator;
+
+export import std;
+
+//Wall grid of a whole level, bit x % 64 of word x / 64 in a row is set for walls
+export struct DungeonMap
+{
+	std::int32_t width, height;
+	std::int32_t wordsPerRow;
+	std::vector<std::uint64_t> wallRows;
+
+	[[nodiscard]] bool getIsWall(std::int32_t x, std::int32_t y) const
+	{
+		if(x < 0 || y < 0 || x >= width || y >= height)
+			return true;
+		return wallRows[std::size_t(y) * wordsPerRow + x / 64] >> (x % 64) & 1;
+	}
+};
+
+//Builds levels out of square regions, each either caves or rooms and corridors, generated in parallel
+//Every region only depends on the seed and its position, so the result doesn't depend on the thread count
+export class DungeonGenerator
+{
+public:
+	//Regions cover whole words so workers never write the same word
+	static constexpr std::int32_t regionSize{256};
+	static constexpr std::int32_t regionWords{regionSize / 64};
+
+	//Rows of regionWords words, bit x % 64 of word x / 64 is set for walls
+	using Region = std::array<std::uint64_t, regionSize * regionWords>;
+
+	//Size is rounded up to whole regions
+	static DungeonMap generate(std::uint64_t seed, std::int32_t width, std::int32_t height);
+	//One region of a level regionsX by regionsY regions large, the same as the one generate puts there
+	static void generateRegion(Region& region, std::uint64_t seed, std::int32_t regionX, std::int32_t regionY, std::int32_t regionsX, std::int32_t regionsY);
+	//Middle of the hub room of the central region, always open and connected to the rest of the map
+	static std::pair<std::int32_t, std::int32_t> getSpawnCell(std::int32_t width, std::int32_t height);
+
+private:
+
+	struct Random
+	{
+		std::uint64_t state;
+
+		std::uint64_t next();
+		//In [min, max)
+		std::int32_t next(std::int32_t min, std::int32_t max);
+	};
+
+	struct Room
+	{
+		std::int32_t x, y, width, height;
+
+		[[nodiscard]] std::int32_t getCenterX() const { return x + width / 2; }
+		[[nodiscard]] std::int32_t getCenterY() const { return y + height / 2; }
+	};
+
+	static std::uint64_t mix(std::uint64_t value);
+	static std::uint64_t hashPosition(std::uint64_t seed, std::int32_t x, std::int32_t y, std::uint32_t salt);
+
+	static void generateCaves(Region& region, Random& random);
+	static void generateRooms(Region& region, Random& random);
+	//One cellular automaton step, a cell becomes wall with at least 5 walls in its 3x3 neighborhood, outside counts as wall
+	static void stepCaves(Region const& source, Region& destination);
+
+	static void carveRect(Region& region, std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1);
+	//Horizontal then vertical, or the other way around
+	static void carveCorridor(Region& region, std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, bool isHorizontalFirst);
+};
+
+//Level generated a region at a time when first read, so memory follows where it's read rather than its size
+//Safe to read from any thread, readers of a dropped region keep it alive until they're done
+export class DungeonLevel
+{
+public:
+	//Size is rounded up to whole regions
+	DungeonLevel(std::uint64_t newSeed, std::int32_t width, std::int32_t height);
+
+	[[nodiscard]] std::int32_t getWidth() const { return regionsX * DungeonGenerator::regionSize; }
+	[[nodiscard]] std::int32_t getHeight() const { return regionsY * DungeonGenerator::regionSize; }
+	//Everything outside the level is wall
+	[[nodiscard]] bool getIsWall(std::int32_t x, std::int32_t y) const;
+	//Walls of the 32 cells from x on, bit i for cell x + i
+	[[nodiscard]] std::uint32_t getRowBits(std::int32_t x, std::int32_t y) const;
+
+	//Drops regions more than radius regions away from the one holding the cell, they are generated again when read
+	void dropRegions(std::int32_t x, std::int32_t y, std::int32_t radius);
+	[[nodiscard]] std::size_t getRegionCount() const;
+
+private:
+	//Word x / 64 of row y, all walls outside the level
+	std::uint64_t getWord(std::int32_t wordX, std::int32_t y) const;
+	std::shared_ptr<DungeonGenerator::Region const> getRegion(std::int32_t regionX, std::int32_t regionY) const;
+
+	std::uint64_t seed;
+	std::int32_t regionsX, regionsY;
+
+	mutable std::mutex regionMutex;
+	mutable std::unordered_map<std::uint64_t, std::shared_ptr<DungeonGenerator::Region const>> regions;
+};
\ No newline at end of file
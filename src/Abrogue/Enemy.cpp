@@ -1,21 +1,265 @@
 module Enemy;
 
 import Game;
+import LineOfSight;
+import Projectiles;
+import InfluenceMap;
+import GlyphCache;
 
-Enemy::Enemy()
+Enemy::Enemy(std::uint32_t newIndex) : index{newIndex}
 {
 	setMass(10.0 + (double)std::random_device()() / std::numeric_limits<std::uint32_t>::max() * 10.0);
 	setFrictionCoefficient((double)std::random_device()() / std::numeric_limits<std::uint32_t>::max());
 	setMaxSpeed(0.5 + (double)std::random_device()() / std::numeric_limits<std::uint32_t>::max());
+	setGlyph(restingGlyph);
+	actionDelay = 2 + std::random_device()() % 5;
+
+	Scheduler::schedule({Scheduler::EventType::action, index}, 1);
+}
+
+void Enemy::requestPerception(std::int32_t playerCellX, std::int32_t playerCellY)
+{
+	auto [x, y] = getPosition();
+	auto [cellX, cellY] = World::getCell(x, y);
+	perceptionQuery = LineOfSight::request(cellX, cellY, playerCellX, playerCellY);
+}
+
+bool Enemy::act()
+{
+	if(LineOfSight::getIsVisible(perceptionQuery))
+	{
+		std::tie(targetX, targetY) = Game::getPlayerPosition();
+		hasTarget = true;
+
+		//Shoot at the player every time it's seen
+		auto [x, y] = getPosition();
+		Projectiles::spawn(x, y, targetX - x, targetY - y, false);
+
+		//Seeing the player again starts the alert over
+		Scheduler::cancel(alertExpiry);
+		alertExpiry = Scheduler::schedule({Scheduler::EventType::statusExpiry, index}, alertDuration);
+		isAlert = true;
+		setGlyph(GlyphCache::codepointFlag | alertCodepoint);
+
+		//The player may have moved since the path was searched
+		path.clear();
+	}
+	else if(hasTarget && path.empty() && !pathRequest)
+	{
+		auto [x, y] = getPosition();
+		auto [cellX, cellY] = World::getCell(x, y);
+		auto [targetCellX, targetCellY] = World::getCell(targetX, targetY);
+		pathRequest = PathFinder::request(cellX, cellY, targetCellX, targetCellY);
+	}
+
+	Scheduler::schedule({Scheduler::EventType::action, index}, isAlert ? actionDelay : restingActionDelay);
+
+	return hasTarget && wake();
 }
 
-void Enemy::update()
+void Enemy::expireAlert()
 {
-	auto [playerX, playerY] = Game::getPlayerPosition();
+	isAlert = false;
+	setGlyph(restingGlyph);
+}
+
+bool Enemy::onHit(double impulseX, double impulseY)
+{
+	addImpulse(impulseX, impulseY);
+	return wake();
+}
+
+bool Enemy::wake()
+{
+	if(isAwake)
+		return false;
+	isAwake = true;
+	return true;
+}
+
+bool Enemy::update(std::int32_t playerCellX, std::int32_t playerCellY, std::uint64_t tick)
+{
+	//Head for where the player was last seen and stop once there
 	auto [x, y] = getPosition();
+	if(hasTarget && std::abs(targetX - x) < World::cellWidth && std::abs(targetY - y) < World::cellHeight)
+		hasTarget = false;
+
+	if(!hasTarget && !getIsMoving())
+	{
+		isAwake = false;
+		return false;
+	}
+
+	auto [cellX, cellY] = World::getCell(x, y);
+	followPath(cellX, cellY);
+
+	//Enemies sharing an interval are offset by index so every tick takes an even share of them
+	auto distance = std::max(std::abs(cellX - playerCellX), std::abs(cellY - playerCellY));
+	auto interval = distance <= fullDetailDistance ? 1 : distance <= reducedDetailDistance ? reducedDetailInterval : abstractInterval;
+	if((tick + index) % interval != 0)
+		return true;
+
+	if(distance > reducedDetailDistance)
+	{
+		//Only knocked about with nowhere to go, stopping on the spot lets it sleep next update instead of walking to a stale target
+		if(!hasTarget)
+			setPosition(x, y);
+		else
+			moveAbstractly(interval);
+		return true;
+	}
+
+	auto [directionX, directionY] = !hasTarget ? std::pair{0, 0} : pathStep < path.size() ? getPathSteering() : getSteering();
+	setMovementX(directionX);
+	setMovementY(directionY);
+
+	PhysicsComponent::update(interval);
+	return true;
+}
+
+std::pair<std::int32_t, std::int32_t> Enemy::getSteering() const
+{
+	//Everything in cells so both axes count the same
+	auto [x, y] = getPosition();
+	auto towardsX = static_cast<float>((targetX - x) / World::cellWidth), towardsY = static_cast<float>((targetY - y) / World::cellHeight);
+	auto distance = std::hypot(towardsX, towardsY);
+	if(distance > 0.0f)
+	{
+		towardsX /= distance;
+		towardsY /= distance;
+	}
+
+	//Gradients point up the slope, towards more enemies or more threat
+	auto [crowdX, crowdY] = InfluenceMap::getGradient(InfluenceMap::Layer::crowding, x, y);
+	auto steeringX = towardsX - crowdX * crowdAvoidance, steeringY = towardsY - crowdY * crowdAvoidance;
+	if(InfluenceMap::sample(InfluenceMap::Layer::threat, x, y) > retreatThreshold)
+	{
+		auto [threatX, threatY] = InfluenceMap::getGradient(InfluenceMap::Layer::threat, x, y);
+		steeringX = -threatX;
+		steeringY = -threatY;
+	}
+
+	//Axes well below the steering direction are left out, so moves snap to the nearest of eight directions
+	auto length = std::hypot(steeringX, steeringY);
+	auto getDirection = [length](float steering) { return std::abs(steering) > length * 0.38f ? (steering > 0.0f ? 1 : -1) : 0; };
+	return {getDirection(steeringX), getDirection(steeringY)};
+}
+
+std::pair<std::int32_t, std::int32_t> Enemy::getPathSteering() const
+{
+	//Aims from where the enemy drifts to in a tick, so it brakes in time instead of swinging past narrow openings
+	auto [x, y] = getPosition();
+	auto [velocityX, velocityY] = getVelocity();
+	auto offsetX = (path[pathStep].first + 0.5) * World::cellWidth - x - velocityX * Constants::tickDuration;
+	auto offsetY = (path[pathStep].second + 0.5) * World::cellHeight - y - velocityY * Constants::tickDuration;
+	auto getDirection = [](double offset, double tolerance) { return std::abs(offset) > tolerance ? (offset > 0.0 ? 1 : -1) : 0; };
+	return {getDirection(offsetX, pathToleranceX), getDirection(offsetY, pathToleranceY)};
+}
+
+void Enemy::followPath(std::int32_t cellX, std::int32_t cellY)
+{
+	if(pathRequest)
+	{
+		if(auto foundPath = PathFinder::takePath(*pathRequest))
+		{
+			pathRequest.reset();
+			path = std::move(*foundPath);
+			pathStep = 0;
+
+			//No way there, the enemy gives up until it sees the player again
+			if(path.empty())
+				hasTarget = false;
+			//Searched for a target the player has been seen away from since
+			else if(path.back() != World::getCell(targetX, targetY))
+				path.clear();
+		}
+	}
+
+	//Pushes and sliding can carry the enemy a few cells along the path or off it
+	auto searchedEnd = path.begin() + std::min(path.size(), pathStep + pathLookahead);
+	auto reachedStep = std::find(path.begin() + pathStep, searchedEnd, PathFinder::Cell{cellX, cellY});
+	if(reachedStep != searchedEnd)
+		pathStep = static_cast<std::size_t>(reachedStep - path.begin()) + 1;
+	if(pathStep >= path.size())
+	{
+		path.clear();
+		pathStep = 0;
+	}
+	else if(std::max(std::abs(path[pathStep].first - cellX), std::abs(path[pathStep].second - cellY)) > pathDeviation)
+	{
+		path.clear();
+		pathStep = 0;
+		auto [targetCellX, targetCellY] = World::getCell(targetX, targetY);
+		pathRequest = PathFinder::request(cellX, cellY, targetCellX, targetCellY);
+	}
+}
+
+void Enemy::moveAbstractly(std::uint32_t tickCount)
+{
+	//Walking straight ahead would likely lead off the path or into a wall
+	if(pathRequest)
+		return;
+
+	auto [x, y] = getPosition();
+	auto [cellX, cellY] = World::getCell(x, y);
+	auto [targetCellX, targetCellY] = World::getCell(targetX, targetY);
+	auto getIsOpen = [](std::int32_t neighbourX, std::int32_t neighbourY) { return !World::getIsLevelWall(neighbourX, neighbourY); };
+
+	//Walking force is split so physics caps each axis at maxSpeed / sqrt(2) on its own, and cells are twice as tall as they are wide
+	auto axisDistance = getMaxSpeed() / std::sqrt(2.0) * tickCount * Constants::tickDuration;
+	auto stepsX = static_cast<std::int32_t>(axisDistance / World::cellWidth), stepsY = static_cast<std::int32_t>(axisDistance / World::cellHeight);
+	while((stepsX > 0 || stepsY > 0) && (cellX != targetCellX || cellY != targetCellY))
+	{
+		if(pathStep < path.size())
+		{
+			auto [nextX, nextY] = path[pathStep];
+			auto costX = std::abs(nextX - cellX), costY = std::abs(nextY - cellY);
+			if(costX > stepsX || costY > stepsY)
+				break;
+			stepsX -= costX;
+			stepsY -= costY;
+			std::tie(cellX, cellY) = path[pathStep++];
+			continue;
+		}
+
+		auto stepX = (targetCellX > cellX) - (targetCellX < cellX);
+		auto stepY = (targetCellY > cellY) - (targetCellY < cellY);
+
+		bool isOpenX = stepX != 0 && getIsOpen(cellX + stepX, cellY);
+		bool isOpenY = stepY != 0 && getIsOpen(cellX, cellY + stepY);
+		if(!isOpenX && !isOpenY)
+		{
+			//Stuck behind a wall, the enemy gives up until it sees the player again
+			hasTarget = false;
+			break;
+		}
 
-	setMovementX(playerX > x ? 1 : -1);
-	setMovementY(playerY > y ? 1 : -1);
+		//Once one axis has gone as far as it can this update the other keeps going alone
+		isOpenX &= stepsX > 0;
+		isOpenY &= stepsY > 0;
+		//Diagonal steps only where they don't cut a corner
+		if(isOpenX && isOpenY && getIsOpen(cellX + stepX, cellY + stepY))
+		{
+			cellX += stepX;
+			cellY += stepY;
+			stepsX--;
+			stepsY--;
+		}
+		else if(isOpenX)
+		{
+			cellX += stepX;
+			stepsX--;
+		}
+		else if(isOpenY)
+		{
+			cellY += stepY;
+			stepsY--;
+		}
+		else
+			break;
+	}
 
-	PhysicsComponent::update();
+	if(cellX == targetCellX && cellY == targetCellY)
+		hasTarget = false;
+	setPosition((cellX + 0.5) * World::cellWidth, (cellY + 0.5) * World::cellHeight);
 }
\ No newline at end of file
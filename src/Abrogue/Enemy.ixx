@@ -1,11 +1,76 @@
 export module Enemy;
 
 export import PhysicsComponent;
+export import Scheduler;
+import World;
+import PathFinder;
 
+//Enemies look for the player on scheduled actions and only need updates while awake
 export class Enemy : public PhysicsComponent
 {
 public:
-	Enemy();
+	//Index in the game's enemies, events of the enemy refer to it by that
+	explicit Enemy(std::uint32_t newIndex);
 
-	void update();
+	//Asks whether the player's cell can be seen, answered by LineOfSight::resolve before act
+	void requestPerception(std::int32_t playerCellX, std::int32_t playerCellY);
+	//Takes the perception answer and schedules the next action, returns whether the enemy just woke up
+	bool act();
+	//Returns whether the hit woke the enemy up
+	bool onHit(double impulseX, double impulseY);
+	void expireAlert();
+	//Returns false once the enemy came to rest, it needs no updates until it wakes up again
+	//The farther from the player, the fewer ticks actually move the enemy
+	bool update(std::int32_t playerCellX, std::int32_t playerCellY, std::uint64_t tick);
+
+private:
+	//In cells from the player, nearer enemies run physics every tick and the rest every reducedDetailInterval ticks with a longer step
+	static constexpr std::int32_t fullDetailDistance{32};
+	//Chunks this close to the player are always resident, beyond it enemies walk the level abstractly every abstractInterval ticks
+	static constexpr std::int32_t reducedDetailDistance{World::viewRadius * Chunk::size - 2};
+	static constexpr std::uint32_t reducedDetailInterval{4}, abstractInterval{16};
+
+	//In ticks, enemies that saw the player recently act at their own pace and the rest only look around now and then
+	static constexpr std::uint64_t alertDuration{80};
+	static constexpr std::uint64_t restingActionDelay{32};
+
+	//Alert enemies turn into a gamma, a codepoint outside the tile atlas drawn through the glyph cache
+	static constexpr std::uint32_t restingGlyph{'g'}, alertCodepoint{0x03b3};
+
+	std::uint32_t index{};
+	std::uint64_t actionDelay{};
+	bool isAlert{};
+	Scheduler::Handle alertExpiry{};
+	bool isAwake{};
+
+	//Steering weights of the influence maps, enemies back off down the threat slope above retreatThreshold
+	static constexpr float crowdAvoidance{4.0f};
+	static constexpr float retreatThreshold{0.5f};
+
+	//Returns whether the enemy was resting
+	bool wake();
+	//Direction along either axis, towards the target while spreading out from other enemies, away from it when the threat is too high
+	std::pair<std::int32_t, std::int32_t> getSteering() const;
+	//Direction along either axis to the middle of the next cell of the path
+	std::pair<std::int32_t, std::int32_t> getPathSteering() const;
+	//Takes the path once found, then skips the cells the enemy already got to
+	void followPath(std::int32_t cellX, std::int32_t cellY);
+	//Steps cell by cell towards the target over tickCount ticks, skipping physics and collision sweeps
+	void moveAbstractly(std::uint32_t tickCount);
+
+	std::uint32_t perceptionQuery{};
+	//Where the player was last seen, enemies that never saw it stay put
+	bool hasTarget{};
+	double targetX{}, targetY{};
+
+	//Enemies that lost sight of the player hunt it down along a path to where it was last seen
+	//Cells of the path ahead the enemy may have skipped to
+	static constexpr std::size_t pathLookahead{8};
+	//Paths the enemy strayed farther than this from along either axis are searched again
+	static constexpr std::int32_t pathDeviation{2};
+	//Enemies farther off the middle of path cells than this catch on the corners of corridors one cell wide
+	static constexpr double pathToleranceX{World::cellWidth * 0.05}, pathToleranceY{World::cellHeight * 0.05};
+	std::optional<std::uint32_t> pathRequest;
+	std::vector<PathFinder::Cell> path;
+	std::size_t pathStep{};
 };
\ No newline at end of file
@@ -0,0 +1,223 @@
+module FieldOfView;
+
+bool FieldOfView::update(std::int32_t cellX, std::int32_t cellY)
+{
+	//Window keeps at least two chunks on every side of the origin's chunk, more than the radius
+	static_assert(radius < (windowChunks / 2) * Chunk::size && 2 * radius < maskSize);
+	auto chunkX = (cellX >> Chunk::sizeShift) - windowChunks / 2, chunkY = (cellY >> Chunk::sizeShift) - windowChunks / 2;
+
+	//Chunk revisions change whenever a chunk is loaded, unloaded or edited
+	std::array<std::uint64_t, windowChunks * windowChunks> revisions{};
+	for(std::int32_t y = 0; y < windowChunks; y++)
+	{
+		for(std::int32_t x = 0; x < windowChunks; x++)
+		{
+			auto chunk = World::findChunk(chunkX + x, chunkY + y);
+			revisions[y * windowChunks + x] = chunk ? chunk->revision : 0;
+		}
+	}
+
+	bool isWindowChanged = !isValid || chunkX != windowChunkX || chunkY != windowChunkY || revisions != windowRevisions;
+	if(isValid && cellX == originX && cellY == originY && !isWindowChanged)
+		return false;
+
+	if(isWindowChanged)
+	{
+		windowChunkX = chunkX;
+		windowChunkY = chunkY;
+		windowRevisions = revisions;
+		for(std::int32_t y = 0; y < windowChunks; y++)
+		{
+			for(std::int32_t x = 0; x < windowChunks; x++)
+			{
+				//Chunks that aren't resident are solid
+				auto chunk = World::findChunk(chunkX + x, chunkY + y);
+				std::array<std::uint32_t, Chunk::size> block;
+				if(chunk)
+					block = chunk->wallRows;
+				else
+					block.fill(~std::uint32_t{});
+
+				for(std::int32_t row = 0; row < Chunk::size; row++)
+					windowRows[(y * Chunk::size + row) * windowChunks + x] = block[row];
+				transposeBlock(block);
+				for(std::int32_t column = 0; column < Chunk::size; column++)
+					windowColumns[(x * Chunk::size + column) * windowChunks + y] = block[column];
+			}
+		}
+	}
+
+	isValid = true;
+	originX = cellX;
+	originY = cellY;
+
+	Mask mask{};
+	reveal(mask, originX, originY);
+	for(std::uint32_t quadrant = 0; quadrant < 4; quadrant++)
+		scan(mask, quadrant, 1, -1, 1, 1, 1);
+
+	for(std::int32_t row = 0; row < maskSize; row++)
+	{
+		bool isChanged = false;
+		for(std::int32_t word = 0; word < maskWords; word++)
+			isChanged |= mask[row * maskWords + word] != maskRows[row * maskWords + word];
+		if(isChanged)
+			changedRows[row / 64] |= std::uint64_t{1} << (row % 64);
+	}
+	maskRows = mask;
+	return true;
+}
+
+void FieldOfView::release()
+{
+	isValid = false;
+	windowRevisions = {};
+	maskRows = {};
+	changedRows = {};
+}
+
+bool FieldOfView::getIsVisible(std::int32_t cellX, std::int32_t cellY)
+{
+	if(!isValid || std::abs(cellX - originX) > radius || std::abs(cellY - originY) > radius)
+		return false;
+
+	auto x = cellX & (maskSize - 1), y = cellY & (maskSize - 1);
+	return maskRows[y * maskWords + x / 64] >> (x % 64) & 1;
+}
+
+std::array<std::uint64_t, FieldOfView::maskWords> FieldOfView::takeChangedRows()
+{
+	return std::exchange(changedRows, {});
+}
+
+void FieldOfView::scan(Mask& mask, std::uint32_t quadrant, std::int32_t depth, std::int32_t startNumerator, std::int32_t startDenominator, std::int32_t endNumerator,
+					   std::int32_t endDenominator)
+{
+	//Denominators are positive, floor and ceil of the divisions below round half up at the start and half down at the end
+	auto floorDivide = [](std::int32_t numerator, std::int32_t denominator) { return numerator / denominator - (numerator % denominator < 0); };
+	auto ceilDivide = [&floorDivide](std::int32_t numerator, std::int32_t denominator) { return -floorDivide(-numerator, denominator); };
+
+	//Rows only split into a new scan at walls, open rows continue in the loop
+	for(; depth <= radius; depth++)
+	{
+		auto minColumn = floorDivide(2 * depth * startNumerator + startDenominator, 2 * startDenominator);
+		auto maxColumn = ceilDivide(2 * depth * endNumerator - endDenominator, 2 * endDenominator);
+
+		if(!getHasWall(quadrant, depth, minColumn, maxColumn))
+		{
+			//Floors are only seen from cells that can see back, which keeps vision symmetric
+			auto firstColumn = std::max(ceilDivide(depth * startNumerator, startDenominator), -radiusColumns[depth]);
+			auto lastColumn = std::min(floorDivide(depth * endNumerator, endDenominator), radiusColumns[depth]);
+			revealColumns(mask, quadrant, depth, firstColumn, lastColumn);
+			continue;
+		}
+
+		//0 before the first cell, 1 after a floor, 2 after a wall
+		std::uint32_t previous{};
+		for(auto column = minColumn; column <= maxColumn; column++)
+		{
+			auto [cellX, cellY] = getQuadrantCell(quadrant, depth, column);
+			bool isWall = getIsWindowWall(cellX, cellY);
+			bool isSymmetric = column * startDenominator >= depth * startNumerator && column * endDenominator <= depth * endNumerator;
+			if((isWall || isSymmetric) && std::abs(column) <= radiusColumns[depth])
+				reveal(mask, cellX, cellY);
+
+			if(previous == 2 && !isWall)
+			{
+				startNumerator = 2 * column - 1;
+				startDenominator = 2 * depth;
+			}
+			if(previous == 1 && isWall)
+				scan(mask, quadrant, depth + 1, startNumerator, startDenominator, 2 * column - 1, 2 * depth);
+			previous = isWall ? 2 : 1;
+		}
+
+		if(previous != 1)
+			return;
+	}
+}
+
+std::pair<std::int32_t, std::int32_t> FieldOfView::getQuadrantCell(std::uint32_t quadrant, std::int32_t depth, std::int32_t column)
+{
+	switch(quadrant)
+	{
+		case 0: return {originX + column, originY - depth};
+		case 1: return {originX + depth, originY + column};
+		case 2: return {originX + column, originY + depth};
+		default: return {originX - depth, originY + column};
+	}
+}
+
+bool FieldOfView::getIsWindowWall(std::int32_t cellX, std::int32_t cellY)
+{
+	auto x = cellX - windowChunkX * Chunk::size, y = cellY - windowChunkY * Chunk::size;
+	return windowRows[y * windowChunks + (x >> Chunk::sizeShift)] >> (x & (Chunk::size - 1)) & 1;
+}
+
+bool FieldOfView::getHasWall(std::uint32_t quadrant, std::int32_t depth, std::int32_t firstColumn, std::int32_t lastColumn)
+{
+	//North and south rows run along window rows, east and west ones along window columns
+	bool isVertical = quadrant % 2 == 1;
+	auto const& lines = isVertical ? windowColumns : windowRows;
+	auto [cellX, cellY] = getQuadrantCell(quadrant, depth, 0);
+	auto line = isVertical ? cellX - windowChunkX * Chunk::size : cellY - windowChunkY * Chunk::size;
+	auto offset = isVertical ? cellY - windowChunkY * Chunk::size : cellX - windowChunkX * Chunk::size;
+
+	auto first = offset + firstColumn, last = offset + lastColumn;
+	for(auto word = first >> Chunk::sizeShift; word <= last >> Chunk::sizeShift; word++)
+	{
+		auto wordFirst = std::max(first - word * Chunk::size, 0), wordLast = std::min(last - word * Chunk::size, Chunk::size - 1);
+		auto bits = ~std::uint32_t{} >> (Chunk::size - 1 - (wordLast - wordFirst)) << wordFirst;
+		if(lines[line * windowChunks + word] & bits)
+			return true;
+	}
+	return false;
+}
+
+void FieldOfView::reveal(Mask& mask, std::int32_t cellX, std::int32_t cellY)
+{
+	auto x = cellX & (maskSize - 1), y = cellY & (maskSize - 1);
+	mask[y * maskWords + x / 64] |= std::uint64_t{1} << (x % 64);
+}
+
+void FieldOfView::revealColumns(Mask& mask, std::uint32_t quadrant, std::int32_t depth, std::int32_t firstColumn, std::int32_t lastColumn)
+{
+	if(firstColumn > lastColumn)
+		return;
+
+	if(quadrant % 2 == 1)
+	{
+		for(auto column = firstColumn; column <= lastColumn; column++)
+		{
+			auto [cellX, cellY] = getQuadrantCell(quadrant, depth, column);
+			reveal(mask, cellX, cellY);
+		}
+		return;
+	}
+
+	//Horizontal runs are set a word at a time, wrapping around the mask
+	auto [firstX, cellY] = getQuadrantCell(quadrant, depth, firstColumn);
+	auto row = &mask[(cellY & (maskSize - 1)) * maskWords];
+	for(auto x = firstX, lastX = firstX + lastColumn - firstColumn; x <= lastX;)
+	{
+		auto maskX = x & (maskSize - 1);
+		auto count = std::min(64 - maskX % 64, lastX - x + 1);
+		row[maskX / 64] |= ~std::uint64_t{} >> (64 - count) << (maskX % 64);
+		x += count;
+	}
+}
+
+void FieldOfView::transposeBlock(std::array<std::uint32_t, Chunk::size>& block)
+{
+	//Swaps ever smaller off diagonal sub blocks
+	std::uint32_t lowBits{0x0000ffff};
+	for(std::uint32_t width = 16; width != 0; width >>= 1, lowBits ^= lowBits << width)
+	{
+		for(std::uint32_t row = 0; row < Chunk::size; row = (row + width + 1) & ~width)
+		{
+			auto swapped = ((block[row] >> width) ^ block[row + width]) & lowBits;
+			block[row] ^= swapped << width;
+			block[row + width] ^= swapped;
+		}
+	}
+}
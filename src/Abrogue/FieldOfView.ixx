@@ -0,0 +1,71 @@
+export module FieldOfView;
+
+export import std;
+export import World;
+
+//Symmetric shadowcasting from one cell, walls in view are visible too but block sight
+export class FieldOfView
+{
+public:
+	static constexpr std::int32_t radius{60};
+	//Visibility is kept for a square around the origin, row and bit of a cell are its world cell modulo the size
+	static constexpr std::int32_t maskSize{128};
+	static constexpr std::int32_t maskWords{maskSize / 64};
+
+	//Recomputes only if the origin moved to another cell or chunks around it changed, returns whether it did
+	static bool update(std::int32_t cellX, std::int32_t cellY);
+	static void release();
+
+	[[nodiscard]] static bool getIsVisible(std::int32_t cellX, std::int32_t cellY);
+	//Lowest cell covered by the mask
+	[[nodiscard]] static std::pair<std::int32_t, std::int32_t> getMaskOrigin() { return {originX - maskSize / 2, originY - maskSize / 2}; }
+	[[nodiscard]] static auto const& getMaskRows() { return maskRows; }
+	//Mask rows that changed since the last call, bit y % 64 of word y / 64
+	static std::array<std::uint64_t, maskWords> takeChangedRows();
+
+private:
+	//Chunks around the origin are copied out of the world so scanning doesn't look up a chunk per cell
+	static constexpr std::int32_t windowChunks{5};
+	static constexpr std::int32_t windowSize{windowChunks * Chunk::size};
+
+	using Mask = std::array<std::uint64_t, maskSize * maskWords>;
+	using WindowLines = std::array<std::uint32_t, windowSize * windowChunks>;
+
+	//Widest column still inside the radius for each depth
+	static constexpr auto radiusColumns = []()
+	{
+		std::array<std::int32_t, radius + 1> columns{};
+		for(std::int32_t depth = 0; depth <= radius; depth++)
+		{
+			while(columns[depth] * columns[depth] + depth * depth <= radius * radius + radius)
+				columns[depth]++;
+			columns[depth]--;
+		}
+		return columns;
+	}();
+
+	//Slopes are fractions so no cell flips between scans from rounding
+	static void scan(Mask& mask, std::uint32_t quadrant, std::int32_t depth, std::int32_t startNumerator, std::int32_t startDenominator, std::int32_t endNumerator,
+					 std::int32_t endDenominator);
+	//Offset from the origin along the quadrant's axis and across it to a world cell
+	static std::pair<std::int32_t, std::int32_t> getQuadrantCell(std::uint32_t quadrant, std::int32_t depth, std::int32_t column);
+	static bool getIsWindowWall(std::int32_t cellX, std::int32_t cellY);
+	//Whether cells first to last of a window row, or of a window column for the east and west quadrants, hold a wall
+	static bool getHasWall(std::uint32_t quadrant, std::int32_t depth, std::int32_t firstColumn, std::int32_t lastColumn);
+	static void reveal(Mask& mask, std::int32_t cellX, std::int32_t cellY);
+	static void revealColumns(Mask& mask, std::uint32_t quadrant, std::int32_t depth, std::int32_t firstColumn, std::int32_t lastColumn);
+	//32x32 bit block, bit x of row y moves to bit y of row x
+	static void transposeBlock(std::array<std::uint32_t, Chunk::size>& block);
+
+	inline static bool isValid{};
+	inline static std::int32_t originX{}, originY{};
+
+	//Chunk rows of the window, windowChunks per cell row, and the same transposed so columns can be tested a word at a time
+	inline static std::int32_t windowChunkX{}, windowChunkY{};
+	inline static WindowLines windowRows{};
+	inline static WindowLines windowColumns{};
+	inline static std::array<std::uint64_t, windowChunks * windowChunks> windowRevisions{};
+
+	inline static Mask maskRows{};
+	inline static std::array<std::uint64_t, maskWords> changedRows{};
+};
@@ -2,33 +2,69 @@ module;
 
 #include <SDL3/SDL_timer.h>
 #include <SDL3/SDL_scancode.h>
+#include <SDL3/SDL_events.h>
 
 export module Game;
 
 export import RenderEngine;
 export import Player;
 export import Enemy;
+import AssetManager;
+import LineOfSight;
+import TileCollision;
+import Scheduler;
+import Projectiles;
+import InfluenceMap;
+import PathFinder;
 
 export class Game
 {
 public:
 	static bool init()
 	{
+		auto initStartTime = SDL_GetTicksNS();
+		//Benchmarks always walk the same world
+		if(!World::init(Configuration::getIsBenchmark() ? 0 : std::random_device{}()))
+			return false;
+
 		renderEngine = std::make_unique<RenderEngine>();
 		if(renderEngine->getHasError())
 			return false;
 
+		Scheduler::schedule({Scheduler::EventType::spawn, 0}, spawnDelay);
+
 		lastUpdateTime = SDL_GetTicksNS();
+		Logger::logInfo(std::format("Render engine started in {:.2f} ms", (lastUpdateTime - initStartTime) / 1.e6));
 		lastFPSLogTime = lastUpdateTime;
+		lastFrameTime = lastUpdateTime;
+		benchmarkStartTime = lastUpdateTime;
+
+		if(Configuration::getIsBenchmark())
+		{
+			//Enough for an uncapped run without reallocating mid-benchmark
+			frameTimes.reserve(Configuration::getBenchmarkDurationNS() / 100000);
+			Logger::logInfo(std::format("Running benchmark for {} s", Configuration::getBenchmarkDurationNS() / 1.e9));
+		}
 		return true;
 	}
 	static void release()
 	{
 		renderEngine.reset();
+		PathFinder::release();
+		InfluenceMap::release();
+		Projectiles::release();
+		ActorGrid::release();
+		Scheduler::release();
+		TileCollision::release();
+		LineOfSight::release();
+		FieldOfView::release();
+		World::release();
 	}
 
 	static bool update()
 	{
+		AssetManager::update();
+
 		player.setMovementX(pressedButtons[SDL_SCANCODE_D] - pressedButtons[SDL_SCANCODE_A]);
 		player.setMovementY(pressedButtons[SDL_SCANCODE_S] - pressedButtons[SDL_SCANCODE_W]);
 
@@ -38,9 +74,79 @@ public:
 		{
 			player.update();
 
-			if(lastUpdateTime / 5000000000 > enemies.size())
-				enemies.emplace_back();
-			for(auto& enemy : enemies) enemy.update();
+			//Only enemies with an action due look for the player, their perception checks are answered in one batch
+			auto const& dueEvents = Scheduler::advance();
+			auto [playerX, playerY] = player.getPosition();
+			auto [playerCellX, playerCellY] = World::getCell(playerX, playerY);
+			for(auto const& event : dueEvents)
+			{
+				if(event.type == Scheduler::EventType::action)
+					enemies[event.target].requestPerception(playerCellX, playerCellY);
+			}
+			LineOfSight::resolve();
+
+			for(auto const& event : dueEvents)
+			{
+				switch(event.type)
+				{
+				case Scheduler::EventType::action:
+					if(enemies[event.target].act())
+						awakeEnemies.push_back(event.target);
+					break;
+				case Scheduler::EventType::statusExpiry:
+					enemies[event.target].expireAlert();
+					break;
+				case Scheduler::EventType::spawn:
+				{
+					auto enemyIndex = static_cast<std::uint32_t>(enemies.size());
+					auto [enemyX, enemyY] = enemies.emplace_back(enemyIndex).getPosition();
+					ActorGrid::place(enemyIndex, enemyX, enemyY);
+					Scheduler::schedule({Scheduler::EventType::spawn, 0}, spawnDelay);
+					break;
+				}
+			}
+
+			//Hunters that lost sight of the player asked for paths, found ones can be taken from the next tick on
+			PathFinder::update();
+
+			//Resting enemies are skipped until an action wakes them
+			std::erase_if(awakeEnemies, [playerCellX, playerCellY](std::uint32_t index) { return !enemies[index].update(playerCellX, playerCellY, Scheduler::getTick()); });
+
+			//Moves of all actors are swept against the tiles in one batch
+			TileCollision::resolve();
+			player.applyMovement();
+			for(auto index : awakeEnemies)
+			{
+				enemies[index].applyMovement();
+				auto [enemyX, enemyY] = enemies[index].getPosition();
+				ActorGrid::place(index, enemyX, enemyY);
+			}
+
+			//Arrow keys shoot every tick, hits push actors away
+			auto [shooterX, shooterY] = player.getPosition();
+			Projectiles::spawn(shooterX, shooterY, pressedButtons[SDL_SCANCODE_RIGHT] - pressedButtons[SDL_SCANCODE_LEFT], pressedButtons[SDL_SCANCODE_DOWN] - pressedButtons[SDL_SCANCODE_UP], true);
+			for(auto const& hit : Projectiles::update(shooterX, shooterY))
+			{
+				auto impulseX = hit.velocityX * Projectiles::mass, impulseY = hit.velocityY * Projectiles::mass;
+				if(hit.target == Projectiles::playerTarget)
+					player.addImpulse(impulseX, impulseY);
+				else if(enemies[hit.target].onHit(impulseX, impulseY))
+					awakeEnemies.push_back(hit.target);
+			}
+
+			//Enemies steer by these in the next tick
+			InfluenceMap::addSource(InfluenceMap::Layer::threat, shooterX, shooterY, playerThreat);
+			for(std::uint32_t i = 0; i < Projectiles::getCount(); i++)
+			{
+				if(Projectiles::getFromPlayerFlags()[i])
+					InfluenceMap::addSource(InfluenceMap::Layer::threat, Projectiles::getPositionsX()[i], Projectiles::getPositionsY()[i], shotThreat);
+			}
+			for(auto index : awakeEnemies)
+			{
+				auto [enemyX, enemyY] = enemies[index].getPosition();
+				InfluenceMap::addSource(InfluenceMap::Layer::crowding, enemyX, enemyY, 1.0f);
+			}
+			InfluenceMap::update(playerCellX, playerCellY);
 
 			lastUpdateTime += Constants::tickDurationNS;
 
@@ -53,8 +159,41 @@ public:
 			}
 		}
 
+		auto [playerX, playerY] = player.getPosition();
+		World::update(playerX, playerY);
+		auto [playerCellX, playerCellY] = World::getCell(playerX, playerY);
+		bool isViewChanged = FieldOfView::update(playerCellX, playerCellY);
+
+		//Nothing on screen changed, sleep until the next tick or event instead of presenting the same frame
+		bool hasChanges = QuadPool::getIsDirty() || World::getIsDirty() || Projectiles::getIsDirty() || isViewChanged || hasPendingInput || renderEngine->getRedrawRequested();
+		if(!hasChanges && !Configuration::getIsBenchmark())
+		{
+			uint64_t nextTickTime = lastUpdateTime + Constants::tickDurationNS;
+			uint64_t timeNow = SDL_GetTicksNS();
+			if(nextTickTime > timeNow)
+				SDL_WaitEventTimeout(nullptr, static_cast<Sint32>((nextTickTime - timeNow + 999999) / 1000000));
+			return true;
+		}
+
 		if(!renderEngine->drawFrame())
 			return false;
+		QuadPool::clearDirty();
+		World::clearDirty();
+		Projectiles::clearDirty();
+		hasPendingInput = false;
+
+		if(Configuration::getIsBenchmark())
+		{
+			uint64_t frameEndTime = SDL_GetTicksNS();
+			frameTimes.emplace_back(frameEndTime - lastFrameTime);
+			lastFrameTime = frameEndTime;
+
+			if(frameEndTime - benchmarkStartTime >= Configuration::getBenchmarkDurationNS())
+			{
+				logBenchmarkReport(frameEndTime - benchmarkStartTime);
+				isFinished = true;
+			}
+		}
 
 		framesDrawn++;
 		uint64_t timeSinceLastLog = currentTime - lastFPSLogTime;
@@ -71,15 +210,54 @@ public:
 	static void onKeyPressed(SDL_Scancode scanCode)
 	{
 		pressedButtons[scanCode] = true;
+		hasPendingInput = true;
+
+		//Cycle through present modes
+		if(scanCode == SDL_SCANCODE_F5 && !Configuration::getIsBenchmark())
+		{
+			auto nextPresentMode = static_cast<PresentMode>((std::to_underlying(renderEngine->getPresentMode()) + 1) % Configuration::presentModeCount);
+			renderEngine->setPresentMode(nextPresentMode);
+			Configuration::setPresentMode(nextPresentMode);
+			Logger::logInfo(std::format("Switching present mode to {}", Configuration::getPresentModeName(nextPresentMode)));
+		}
 	}
 	static void onKeyReleased(SDL_Scancode scanCode)
 	{
 		pressedButtons[scanCode] = false;
+		hasPendingInput = true;
+	}
+	static void onWindowChanged()
+	{
+		renderEngine->requestRedraw();
 	}
 
 	static std::pair<double, double> getPlayerPosition() { return player.getPosition(); }
 
+	static auto getIsFinished() { return isFinished; }
+
 private:
+	static void logBenchmarkReport(uint64_t elapsedTime)
+	{
+		if(frameTimes.empty())
+			return;
+
+		std::ranges::sort(frameTimes);
+		auto getPercentile = [](double percentile)
+		{
+			auto index = static_cast<size_t>(percentile * (frameTimes.size() - 1));
+			return frameTimes[index] / 1.e6;
+		};
+		double averageFrameTime = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0) / frameTimes.size() / 1.e6;
+
+		Logger::logInfo(std::format("Benchmark finished: {} frames in {:.2f} s", frameTimes.size(), elapsedTime / 1.e9));
+		Logger::logInfo(std::format("\tAverage: {:.3f} ms ({:.1f} FPS)", averageFrameTime, 1000.0 / averageFrameTime));
+		Logger::logInfo(std::format("\tMin: {:.3f} ms", frameTimes.front() / 1.e6));
+		Logger::logInfo(std::format("\t50%: {:.3f} ms", getPercentile(0.5)));
+		Logger::logInfo(std::format("\t95%: {:.3f} ms", getPercentile(0.95)));
+		Logger::logInfo(std::format("\t99%: {:.3f} ms", getPercentile(0.99)));
+		Logger::logInfo(std::format("\tMax: {:.3f} ms", frameTimes.back() / 1.e6));
+	}
+
 	inline static std::unique_ptr<RenderEngine> renderEngine;
 
 	inline static uint64_t lastUpdateTime{};
@@ -87,8 +265,20 @@ private:
 	inline static uint64_t framesDrawn{};
 	inline static uint64_t lastFPSLogTime{};
 
+	inline static uint64_t lastFrameTime{};
+	inline static uint64_t benchmarkStartTime{};
+	inline static std::vector<uint64_t> frameTimes;
+	inline static bool isFinished{};
+
+	//Ticks between enemy spawns
+	static constexpr std::uint64_t spawnDelay{80};
+	//Strength of the threat sources, an enemy crowds the map with 1
+	static constexpr float playerThreat{1.0f}, shotThreat{0.25f};
+
 	inline static Player player;
 	inline static std::vector<Enemy> enemies;
+	inline static std::vector<std::uint32_t> awakeEnemies;
 
 	inline static std::array<bool, SDL_Scancode::SDL_SCANCODE_COUNT> pressedButtons{};
+	inline static bool hasPendingInput{};
 };
\ No newline at end of file
@@ -0,0 +1,202 @@
+module InfluenceMap;
+
+import JobSystem;
+
+void InfluenceMap::release()
+{
+	isValid = false;
+	sources.clear();
+	for(auto& grids : layers)
+		grids = {};
+}
+
+void InfluenceMap::addSource(Layer layer, double x, double y, float strength)
+{
+	auto [cellX, cellY] = World::getCell(x, y);
+	sources.push_back({layer, cellX, cellY, strength});
+}
+
+void InfluenceMap::update(std::int32_t centerCellX, std::int32_t centerCellY)
+{
+	//Moving in whole blocks keeps the splat grids comparable, but everything is blurred again then
+	bool isMoved = !isValid || std::abs(centerCellX - (originX + size / 2)) > blockSize || std::abs(centerCellY - (originY + size / 2)) > blockSize;
+	if(isMoved)
+	{
+		originX = (centerCellX - size / 2) & ~(blockSize - 1);
+		originY = (centerCellY - size / 2) & ~(blockSize - 1);
+		if(!isValid)
+		{
+			for(auto& grids : layers)
+			{
+				for(std::uint32_t i = 0; i < 2; i++)
+				{
+					grids.splats[i].assign(size * size, 0.0f);
+					grids.splatRows[i].assign(blockCount * blockCount, 0);
+				}
+				grids.horizontalRows.assign(blockCount * blockCount, 0);
+				grids.horizontal.assign(size * size, 0.0f);
+				grids.blurred.assign(size * size, 0.0f);
+			}
+			isValid = true;
+		}
+	}
+
+	//The grid of the update before the last one is reused, only rows that held sources need clearing
+	currentSplat ^= 1;
+	for(auto& grids : layers)
+	{
+		auto& splat = grids.splats[currentSplat];
+		auto& splatRows = grids.splatRows[currentSplat];
+		for(std::int32_t block = 0; block < blockCount * blockCount; block++)
+		{
+			auto firstX = block % blockCount * blockSize, firstY = block / blockCount * blockSize;
+			for(auto rows = std::exchange(splatRows[block], 0); rows != 0; rows &= rows - 1)
+				std::fill_n(splat.data() + (firstY + std::countr_zero(rows)) * size + firstX, blockSize, 0.0f);
+		}
+	}
+
+	for(auto const& source : sources)
+	{
+		auto localX = source.cellX - originX, localY = source.cellY - originY;
+		if(localX < 0 || localY < 0 || localX >= size || localY >= size)
+			continue;
+
+		auto& grids = layers[std::to_underlying(source.layer)];
+		grids.splats[currentSplat][localY * size + localX] += source.strength;
+		grids.splatRows[currentSplat][localY / blockSize * blockCount + localX / blockSize] |= std::uint32_t{1} << (localY % blockSize);
+	}
+	sources.clear();
+
+	//Rows blurred along x only change near changed splats, and the result only near those rows
+	std::vector<std::pair<std::uint32_t, std::int32_t>> horizontalBlocks, verticalBlocks;
+	for(std::uint32_t layer = 0; layer < layerCount; layer++)
+	{
+		std::vector<std::uint8_t> changedBlocks(blockCount * blockCount, isMoved);
+		for(std::int32_t block = 0; block < blockCount * blockCount && !isMoved; block++)
+			changedBlocks[block] = getIsBlockChanged(layers[layer], block);
+
+		//Sources reach no farther than the neighbouring blocks along the row
+		auto& grids = layers[layer];
+		auto const& splatRows = grids.splatRows[currentSplat];
+		for(std::int32_t block = 0; block < blockCount * blockCount; block++)
+		{
+			auto blockX = block % blockCount;
+			grids.horizontalRows[block] = splatRows[block] | (blockX > 0 ? splatRows[block - 1] : 0) | (blockX < blockCount - 1 ? splatRows[block + 1] : 0);
+		}
+
+		auto horizontalChanges = dilateBlocks(changedBlocks, false);
+		auto verticalChanges = dilateBlocks(horizontalChanges, true);
+		for(std::int32_t block = 0; block < blockCount * blockCount; block++)
+		{
+			if(horizontalChanges[block])
+				horizontalBlocks.emplace_back(layer, block);
+			if(verticalChanges[block])
+				verticalBlocks.emplace_back(layer, block);
+		}
+	}
+
+	JobSystem::parallelFor(horizontalBlocks.size(), [&horizontalBlocks](std::size_t i) { blurBlock(layers[horizontalBlocks[i].first], horizontalBlocks[i].second, false); });
+	JobSystem::parallelFor(verticalBlocks.size(), [&verticalBlocks](std::size_t i) { blurBlock(layers[verticalBlocks[i].first], verticalBlocks[i].second, true); });
+}
+
+float InfluenceMap::sample(Layer layer, double x, double y)
+{
+	auto [cellX, cellY] = World::getCell(x, y);
+	return getValue(layers[std::to_underlying(layer)], cellX - originX, cellY - originY);
+}
+
+std::pair<float, float> InfluenceMap::getGradient(Layer layer, double x, double y)
+{
+	auto [cellX, cellY] = World::getCell(x, y);
+	auto const& grids = layers[std::to_underlying(layer)];
+	auto localX = cellX - originX, localY = cellY - originY;
+	return {(getValue(grids, localX + 1, localY) - getValue(grids, localX - 1, localY)) / 2.0f,
+			(getValue(grids, localX, localY + 1) - getValue(grids, localX, localY - 1)) / 2.0f};
+}
+
+float InfluenceMap::getValue(LayerGrids const& grids, std::int32_t cellX, std::int32_t cellY)
+{
+	if(!isValid || cellX < 0 || cellY < 0 || cellX >= size || cellY >= size)
+		return 0.0f;
+	return grids.blurred[cellY * size + cellX];
+}
+
+bool InfluenceMap::getIsBlockChanged(LayerGrids const& grids, std::int32_t block)
+{
+	//Rows without a source in either grid are zero in both
+	auto firstX = block % blockCount * blockSize, firstY = block / blockCount * blockSize;
+	for(auto rows = grids.splatRows[0][block] | grids.splatRows[1][block]; rows != 0; rows &= rows - 1)
+	{
+		auto offset = (firstY + std::countr_zero(rows)) * size + firstX;
+		if(!std::equal(grids.splats[0].begin() + offset, grids.splats[0].begin() + offset + blockSize, grids.splats[1].begin() + offset))
+			return true;
+	}
+	return false;
+}
+
+std::vector<std::uint8_t> InfluenceMap::dilateBlocks(std::vector<std::uint8_t> const& blocks, bool isVertical)
+{
+	auto dilated = blocks;
+	for(std::int32_t block = 0; block < blockCount * blockCount; block++)
+	{
+		if(!blocks[block])
+			continue;
+
+		auto blockX = block % blockCount, blockY = block / blockCount;
+		auto along = isVertical ? blockY : blockX;
+		auto step = isVertical ? blockCount : 1;
+		if(along > 0)
+			dilated[block - step] = 1;
+		if(along < blockCount - 1)
+			dilated[block + step] = 1;
+	}
+	return dilated;
+}
+
+void InfluenceMap::blurBlock(LayerGrids& grids, std::int32_t block, bool isVertical)
+{
+	//Sources are sparse, so each nonzero cell or row adds its falloff around it instead of every cell gathering taps
+	auto const& input = isVertical ? grids.horizontal : grids.splats[currentSplat];
+	auto& output = isVertical ? grids.blurred : grids.horizontal;
+	auto blockX = block % blockCount, blockY = block / blockCount;
+	auto firstX = blockX * blockSize, firstY = blockY * blockSize;
+	for(auto y = firstY; y < firstY + blockSize; y++)
+		std::fill_n(output.data() + y * size + firstX, blockSize, 0.0f);
+
+	if(isVertical)
+	{
+		//Rows are added as whole segments, so the inner loop runs over contiguous cells and vectorizes
+		for(auto inputBlockY = std::max(blockY - 1, 0); inputBlockY <= std::min(blockY + 1, blockCount - 1); inputBlockY++)
+		{
+			for(auto rows = grids.horizontalRows[inputBlockY * blockCount + blockX]; rows != 0; rows &= rows - 1)
+			{
+				auto inputY = inputBlockY * blockSize + std::countr_zero(rows);
+				auto inputRow = input.data() + inputY * size + firstX;
+				for(auto y = std::max(inputY - radius, firstY); y <= std::min(inputY + radius, firstY + blockSize - 1); y++)
+				{
+					auto weight = weights[std::abs(y - inputY)];
+					auto outputRow = output.data() + y * size + firstX;
+					for(std::int32_t x = 0; x < blockSize; x++)
+						outputRow[x] += weight * inputRow[x];
+				}
+			}
+		}
+		return;
+	}
+
+	//Rows with a source in reach hold only a few, found by scanning for nonzero cells
+	for(auto rows = grids.horizontalRows[block]; rows != 0; rows &= rows - 1)
+	{
+		auto y = firstY + std::countr_zero(rows);
+		auto inputRow = input.data() + y * size;
+		auto outputRow = output.data() + y * size;
+		for(auto x = std::max(0, firstX - radius); x < std::min(size, firstX + blockSize + radius); x++)
+		{
+			if(inputRow[x] == 0.0f)
+				continue;
+
+			for(auto outputX = std::max(x - radius, firstX); outputX <= std::min(x + radius, firstX + blockSize - 1); outputX++)
+				outputRow[outputX] += weights[std::abs(outputX - x)] * inputRow[x];
+		}
+	}
+}
@@ -0,0 +1,82 @@
+export module InfluenceMap;
+
+export import std;
+export import World;
+
+//Influence of sources spread over the cells around the player, falling off by decay per cell of distance along either axis
+//Only blocks near sources that changed are blurred again
+export class InfluenceMap
+{
+public:
+	enum class Layer : std::uint32_t
+	{
+		//Where the player and its shots are
+		threat,
+		//Where enemies gather
+		crowding
+	};
+	static constexpr std::uint32_t layerCount{2};
+
+	//In cells, the area is a square of size cells split into blocks, it moves with the player in whole blocks
+	static constexpr std::int32_t size{512};
+	static constexpr std::int32_t blockSize{32};
+	static constexpr std::int32_t blockCount{size / blockSize};
+	//Sources reach at most radius cells along either axis, no farther than the neighbouring block
+	static constexpr std::int32_t radius{24};
+	static constexpr float decay{0.85f};
+	//Row masks hold a bit for each row of a block
+	static_assert(radius <= blockSize && blockSize <= 32);
+
+	static void release();
+
+	//Taken into the next update only, sources outside the area are dropped
+	static void addSource(Layer layer, double x, double y, float strength);
+	//Moves the area if the center strayed from its middle, then blurs what the sources changed
+	static void update(std::int32_t centerCellX, std::int32_t centerCellY);
+
+	//Zero outside the area
+	[[nodiscard]] static float sample(Layer layer, double x, double y);
+	//Change per cell along either axis
+	[[nodiscard]] static std::pair<float, float> getGradient(Layer layer, double x, double y);
+
+private:
+	struct Source
+	{
+		Layer layer;
+		std::int32_t cellX, cellY;
+		float strength;
+	};
+
+	struct LayerGrids
+	{
+		//Sources summed per cell, of this update and the last one so changes can be found
+		std::array<std::vector<float>, 2> splats;
+		//Rows of each block of either splat grid holding any source, bit y % blockSize
+		std::array<std::vector<std::uint32_t>, 2> splatRows;
+		std::vector<float> horizontal;
+		std::vector<float> blurred;
+		//Rows of each block that can be nonzero after blurring along x, the others are just cleared and add nothing along y
+		std::vector<std::uint32_t> horizontalRows;
+	};
+
+	static constexpr auto weights = []()
+	{
+		std::array<float, radius + 1> falloff{};
+		falloff[0] = 1.0f;
+		for(std::int32_t distance = 1; distance <= radius; distance++)
+			falloff[distance] = falloff[distance - 1] * decay;
+		return falloff;
+	}();
+
+	static float getValue(LayerGrids const& grids, std::int32_t cellX, std::int32_t cellY);
+	static bool getIsBlockChanged(LayerGrids const& grids, std::int32_t block);
+	//Blocks next to marked ones along an axis get marked too
+	static std::vector<std::uint8_t> dilateBlocks(std::vector<std::uint8_t> const& blocks, bool isVertical);
+	static void blurBlock(LayerGrids& grids, std::int32_t block, bool isVertical);
+
+	inline static bool isValid{};
+	inline static std::int32_t originX{}, originY{};
+	inline static std::uint32_t currentSplat{};
+	inline static std::vector<Source> sources;
+	inline static std::array<LayerGrids, layerCount> layers;
+};
@@ -0,0 +1,118 @@
+module LineOfSight;
+
+import JobSystem;
+
+void LineOfSight::release()
+{
+	queries.clear();
+	answers.clear();
+	misses.clear();
+	missStamps.clear();
+	cache = {};
+}
+
+std::uint32_t LineOfSight::request(std::int32_t fromX, std::int32_t fromY, std::int32_t toX, std::int32_t toY)
+{
+	//Lines are symmetric, so both directions share a cache entry
+	if(std::tie(fromX, fromY) > std::tie(toX, toY))
+	{
+		std::swap(fromX, toX);
+		std::swap(fromY, toY);
+	}
+
+	queries.push_back({fromX, fromY, toX, toY});
+	return static_cast<std::uint32_t>(queries.size() - 1);
+}
+
+void LineOfSight::resolve()
+{
+	answers.assign(queries.size(), 0);
+	misses.clear();
+	for(std::uint32_t i = 0; i < queries.size(); i++)
+	{
+		auto const& entry = cache[getCacheIndex(queries[i])];
+		if(entry.isFilled && entry.query == queries[i] && getIsCurrent(queries[i], entry.stamps))
+			answers[i] = entry.isVisible;
+		else
+			misses.push_back(i);
+	}
+
+	//Lines are short, hand them out in blocks so a job is worth its overhead
+	constexpr std::size_t blockSize{64};
+	missStamps.resize(misses.size());
+	JobSystem::parallelFor((misses.size() + blockSize - 1) / blockSize, [](std::size_t block)
+	{
+		for(auto i = block * blockSize; i < std::min(misses.size(), (block + 1) * blockSize); i++)
+			answers[misses[i]] = trace(queries[misses[i]], missStamps[i]);
+	});
+
+	for(std::size_t i = 0; i < misses.size(); i++)
+		cache[getCacheIndex(queries[misses[i]])] = {queries[misses[i]], missStamps[i], true, answers[misses[i]] != 0};
+	queries.clear();
+}
+
+bool LineOfSight::trace(Query const& query, ChunkStamps& stamps)
+{
+	stamps.count = 0;
+	auto deltaX = std::abs(query.toX - query.fromX), deltaY = std::abs(query.toY - query.fromY);
+	if(deltaX * deltaX + deltaY * deltaY > maxDistance * maxDistance + maxDistance)
+		return false;
+
+	auto stepX = query.toX > query.fromX ? 1 : -1, stepY = query.toY > query.fromY ? 1 : -1;
+	auto x = query.fromX, y = query.fromY;
+	//Chunk is only looked up again once the line leaves it
+	Chunk const* chunk{};
+	auto firstChunkX = x >> Chunk::sizeShift, firstChunkY = y >> Chunk::sizeShift;
+	auto chunkX = firstChunkX, chunkY = firstChunkY;
+	bool hasChunk{};
+	for(std::int32_t stepsX = 0, stepsY = 0; stepsX < deltaX || stepsY < deltaY;)
+	{
+		//Sign tells whether the line leaves the current cell through its vertical or horizontal side first
+		auto decision = (1 + 2 * stepsX) * deltaY - (1 + 2 * stepsY) * deltaX;
+		if(decision <= 0)
+		{
+			x += stepX;
+			stepsX++;
+		}
+		if(decision >= 0)
+		{
+			y += stepY;
+			stepsY++;
+		}
+		if(x == query.toX && y == query.toY)
+			return true;
+
+		if(!hasChunk || x >> Chunk::sizeShift != chunkX || y >> Chunk::sizeShift != chunkY)
+		{
+			chunkX = x >> Chunk::sizeShift;
+			chunkY = y >> Chunk::sizeShift;
+			chunk = World::findChunk(chunkX, chunkY);
+			hasChunk = true;
+			stamps.revisions[stamps.count] = chunk ? chunk->revision : 0;
+			stamps.offsets[stamps.count] = {std::int8_t(chunkX - firstChunkX), std::int8_t(chunkY - firstChunkY)};
+			stamps.count++;
+		}
+		if(!chunk || chunk->getIsWall(x & (Chunk::size - 1), y & (Chunk::size - 1)))
+			return false;
+	}
+	return true;
+}
+
+std::uint32_t LineOfSight::getCacheIndex(Query const& query)
+{
+	auto hash = std::uint64_t(std::uint32_t(query.fromX)) * 0x9e3779b97f4a7c15 ^ std::uint64_t(std::uint32_t(query.fromY)) * 0xc2b2ae3d27d4eb4f ^
+				std::uint64_t(std::uint32_t(query.toX)) * 0x165667b19e3779f9 ^ std::uint64_t(std::uint32_t(query.toY)) * 0x27d4eb2f165667c5;
+	return static_cast<std::uint32_t>(hash ^ hash >> 32) & (cacheSize - 1);
+}
+
+bool LineOfSight::getIsCurrent(Query const& query, ChunkStamps const& stamps)
+{
+	auto firstChunkX = query.fromX >> Chunk::sizeShift, firstChunkY = query.fromY >> Chunk::sizeShift;
+	for(std::uint8_t i = 0; i < stamps.count; i++)
+	{
+		auto chunk = World::findChunk(firstChunkX + stamps.offsets[i].first, firstChunkY + stamps.offsets[i].second);
+		if((chunk ? chunk->revision : 0) != stamps.revisions[i])
+			return false;
+	}
+	return true;
+}
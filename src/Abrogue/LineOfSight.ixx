@@ -0,0 +1,65 @@
+export module LineOfSight;
+
+export import std;
+export import World;
+import FieldOfView;
+
+//Cell to cell visibility queries, collected over a tick and answered together
+//Answers are cached per pair of cells until a chunk the line crossed is loaded, unloaded or edited
+export class LineOfSight
+{
+public:
+	//Nothing is visible beyond the player's own view radius, measured the same way so enemies can't see a player who can't see them
+	static constexpr std::int32_t maxDistance{FieldOfView::radius};
+
+	static void release();
+
+	//Index of the answer once resolve ran, queries made after it go into the next batch
+	static std::uint32_t request(std::int32_t fromX, std::int32_t fromY, std::int32_t toX, std::int32_t toY);
+	//Answers all queries made since the last call from the cache, tracing the rest in parallel
+	static void resolve();
+	[[nodiscard]] static bool getIsVisible(std::uint32_t query) { return query < answers.size() && answers[query]; }
+
+private:
+	struct Query
+	{
+		std::int32_t fromX, fromY, toX, toY;
+
+		bool operator==(Query const& rhs) const = default;
+	};
+
+	//A line of at most maxDistance cells crosses at most this many chunks along each axis, and one more per step along a monotonic path
+	static constexpr std::int32_t maxAxisChunks{maxDistance / Chunk::size + 2};
+	static constexpr std::int32_t maxLineChunks{2 * maxAxisChunks - 1};
+
+	//Chunks a trace read before it had its answer, 0 revisions for chunks that weren't resident
+	struct ChunkStamps
+	{
+		std::array<std::uint64_t, maxLineChunks> revisions;
+		//Offsets from the chunk of the query's first cell
+		std::array<std::pair<std::int8_t, std::int8_t>, maxLineChunks> offsets;
+		std::uint8_t count;
+	};
+
+	struct CacheEntry
+	{
+		Query query;
+		ChunkStamps stamps;
+		bool isFilled;
+		bool isVisible;
+	};
+
+	static constexpr std::uint32_t cacheSize{32768};
+
+	//Walks the cells a line between the cell centers crosses, passing diagonally through exact corners, noting each chunk it reads
+	static bool trace(Query const& query, ChunkStamps& stamps);
+	static std::uint32_t getCacheIndex(Query const& query);
+	static bool getIsCurrent(Query const& query, ChunkStamps const& stamps);
+
+	inline static std::vector<Query> queries;
+	inline static std::vector<std::uint8_t> answers;
+	//Queries missing from the cache, traced in parallel
+	inline static std::vector<std::uint32_t> misses;
+	inline static std::vector<ChunkStamps> missStamps;
+	inline static std::array<CacheEntry, cacheSize> cache{};
+};
@@ -10,6 +10,8 @@ export struct QuadData
 {
 	glm::vec2 pos;
 	glm::vec2 scale;
+
+	bool operator==(QuadData const& rhs) const = default;
 };
 
 export class QuadPool
@@ -23,23 +25,46 @@ public:
 
 		void set(QuadData const& newData) const
 		{
+			if(data[index] == newData)
+				return;
+
 			data[index] = newData;
+			isDirty = true;
+		}
+
+		void setGlyph(std::uint32_t newGlyph) const
+		{
+			if(glyphs[index] == newGlyph)
+				return;
+
+			glyphs[index] = newGlyph;
+			isDirty = true;
 		}
 
 	private:
 		size_t index{};
 	};
 
-	[[nodiscard]] static Reference insert(QuadData const& newData)
+	[[nodiscard]] static Reference insert(QuadData const& newData, std::uint32_t glyph = 0)
 	{
 		data[size] = newData;
+		glyphs[size] = glyph;
+		isDirty = true;
 		return Reference{size++};
 	}
 
 	[[nodiscard]] static auto getData() { return data.data(); }
+	//Index into the glyph rects of the tile atlas, kept apart from quad data
+	[[nodiscard]] static auto getGlyphData() { return glyphs.data(); }
 	[[nodiscard]] static auto getSize() { return size; }
 
+	//Set whenever quad data changed since the last clear
+	[[nodiscard]] static auto getIsDirty() { return isDirty; }
+	static void clearDirty() { isDirty = false; }
+
 private:
 	inline static std::array<QuadData, 2048> data;
+	inline static std::array<std::uint32_t, 2048> glyphs;
 	inline static size_t size{};
+	inline static bool isDirty{};
 };
\ No newline at end of file
@@ -0,0 +1,628 @@
+module PathFinder;
+
+import JobSystem;
+
+void PathFinder::release()
+{
+	//The search may still be reading the level and the clusters
+	while(isSearching.load(std::memory_order_acquire))
+		std::this_thread::yield();
+
+	queuedRequests.clear();
+	foundPaths.clear();
+	searchLevel.reset();
+	searchedRequests.clear();
+	searchedPaths.clear();
+	clusters.clear();
+	clusterIndices.clear();
+	sectors.clear();
+	sectorIndices.clear();
+	recentPaths.clear();
+	recentPathIndices.clear();
+}
+
+std::uint32_t PathFinder::request(std::int32_t fromX, std::int32_t fromY, std::int32_t toX, std::int32_t toY)
+{
+	queuedRequests.push_back({nextRequestId, {fromX, fromY, toX, toY}});
+	return nextRequestId++;
+}
+
+void PathFinder::update()
+{
+	if(isSearching.load(std::memory_order_acquire))
+		return;
+
+	for(auto& [id, path] : searchedPaths)
+		foundPaths[id] = std::move(path);
+	searchedPaths.clear();
+	if(queuedRequests.empty())
+		return;
+
+	std::swap(searchedRequests, queuedRequests);
+	queuedRequests.clear();
+	//A new level makes every cluster, sector and path stale
+	if(auto level = World::getLevel(); level != searchLevel)
+	{
+		clusters.clear();
+		clusterIndices.clear();
+		sectors.clear();
+		sectorIndices.clear();
+		recentPaths.clear();
+		recentPathIndices.clear();
+		searchLevel = std::move(level);
+	}
+	std::tie(levelOffsetX, levelOffsetY) = World::getLevelOffset();
+
+	//Without workers the main thread searches right away, paths are taken on the next update either way
+	if(JobSystem::getThreadCount() == 1)
+	{
+		search();
+		return;
+	}
+
+	isSearching.store(true, std::memory_order_relaxed);
+	JobSystem::submit([]()
+	{
+		search();
+		isSearching.store(false, std::memory_order_release);
+	});
+}
+
+std::optional<std::vector<PathFinder::Cell>> PathFinder::takePath(std::uint32_t request)
+{
+	auto foundPath = foundPaths.find(request);
+	if(foundPath == foundPaths.end())
+		return {};
+
+	auto path = std::move(foundPath->second);
+	foundPaths.erase(foundPath);
+	return path;
+}
+
+void PathFinder::search()
+{
+	for(auto const& [id, query] : searchedRequests)
+	{
+		auto key = getQueryKey(query);
+		auto recentPath = recentPathIndices.find(key);
+		if(recentPath != recentPathIndices.end() && recentPath->second->query == query)
+		{
+			recentPaths.splice(recentPaths.begin(), recentPaths, recentPath->second);
+			searchedPaths.emplace_back(id, recentPaths.front().path);
+			continue;
+		}
+
+		auto path = findPath(query);
+		trimCaches();
+		searchedPaths.emplace_back(id, path);
+		recentPaths.push_front({query, std::move(path)});
+		recentPathIndices[key] = recentPaths.begin();
+		if(recentPaths.size() > cacheSize)
+		{
+			//Queries sharing a key replaced the index of older ones, those have none left to remove
+			auto oldestIndex = recentPathIndices.find(getQueryKey(recentPaths.back().query));
+			if(oldestIndex != recentPathIndices.end() && oldestIndex->second == std::prev(recentPaths.end()))
+				recentPathIndices.erase(oldestIndex);
+			recentPaths.pop_back();
+		}
+	}
+	searchedRequests.clear();
+}
+
+std::vector<PathFinder::Cell> PathFinder::findPath(Query const& query)
+{
+	Cell from{query.fromX, query.fromY}, to{query.toX, query.toY};
+	if(getIsWall(from) || getIsWall(to))
+		return {};
+
+	//Costs from the start and the goal to every cell of their chunks connect them to the entrances
+	auto& fromCluster = getCluster(from.first >> Chunk::sizeShift, from.second >> Chunk::sizeShift);
+	auto const& toCluster = getCluster(to.first >> Chunk::sizeShift, to.second >> Chunk::sizeShift);
+	auto fromCosts = std::make_unique<ChunkCosts>(), toCosts = std::make_unique<ChunkCosts>();
+	auto fromParents = std::make_unique<ChunkParents>(), toParents = std::make_unique<ChunkParents>();
+	searchCluster(fromCluster, from, *fromCosts, *fromParents);
+	searchCluster(toCluster, to, *toCosts, *toParents);
+
+	std::vector<Cell> path{from};
+	if(&fromCluster == &toCluster && (*fromCosts)[getLocalCell(fromCluster, to)] != noCost)
+	{
+		appendTrace(path, fromCluster, *fromParents, to, false);
+		return path;
+	}
+
+	bool isLong = std::max(std::abs(to.first - from.first), std::abs(to.second - from.second)) >= sectorSize;
+	auto hops = isLong ? findSectorPath(to, fromCluster, *fromCosts, toCluster, *toCosts) : findEntrancePath(to, fromCluster, *fromCosts, toCluster, *toCosts);
+	if(hops.empty())
+		return {};
+
+	//Hops into the next chunk are single steps, those inside a chunk are traced back to cells
+	appendTrace(path, fromCluster, *fromParents, hops.front(), false);
+	for(std::size_t i = 0; i + 1 < hops.size(); i++)
+	{
+		auto [chunkX, chunkY] = Cell{hops[i].first >> Chunk::sizeShift, hops[i].second >> Chunk::sizeShift};
+		auto [nextChunkX, nextChunkY] = Cell{hops[i + 1].first >> Chunk::sizeShift, hops[i + 1].second >> Chunk::sizeShift};
+		if(chunkX != nextChunkX || chunkY != nextChunkY)
+		{
+			path.push_back(hops[i + 1]);
+			continue;
+		}
+
+		auto& cluster = getCluster(chunkX, chunkY);
+		auto& entrance = *std::ranges::find(cluster.entrances, hops[i], &Entrance::cell);
+		appendTrace(path, cluster, getParents(cluster, entrance), hops[i + 1], false);
+	}
+	appendTrace(path, toCluster, *toParents, hops.back(), true);
+
+	//Looked up before everything the search built, the chunks of the start and the goal would be dropped first though the next requests likely start or end near them
+	getCluster(from.first >> Chunk::sizeShift, from.second >> Chunk::sizeShift);
+	getCluster(to.first >> Chunk::sizeShift, to.second >> Chunk::sizeShift);
+	return path;
+}
+
+std::vector<PathFinder::Cell> PathFinder::findEntrancePath(Cell to, Cluster& fromCluster, ChunkCosts const& fromCosts, Cluster const& toCluster, ChunkCosts const& toCosts)
+{
+	//A* over the entrances, their state is kept in them and told apart from that of older searches by the search index
+	//The goal isn't an entrance, nothing in the queue stands for it
+	searchIndex++;
+	auto goalCost = noCost;
+	Entrance const* goalParent{};
+	using OpenEntrance = std::pair<std::uint32_t, Entrance*>;
+	std::priority_queue<OpenEntrance, std::vector<OpenEntrance>, std::greater<>> openEntrances;
+	auto reach = [&openEntrances, to](Entrance& entrance, std::uint32_t cost, Entrance const* parent)
+	{
+		if(entrance.searchIndex == searchIndex && cost >= entrance.searchCost)
+			return;
+		entrance.searchIndex = searchIndex;
+		entrance.searchCost = cost;
+		entrance.searchParent = parent;
+		openEntrances.emplace(cost + getCostEstimate(entrance.cell, to, entranceEstimateWeight), &entrance);
+	};
+
+	for(auto& entrance : fromCluster.entrances)
+	{
+		auto cost = fromCosts[getLocalCell(fromCluster, entrance.cell)];
+		if(cost != noCost)
+			reach(entrance, cost, nullptr);
+	}
+
+	while(!openEntrances.empty())
+	{
+		auto [estimate, entrance] = openEntrances.top();
+		openEntrances.pop();
+		if(entrance == nullptr)
+			break;
+
+		//Reached again more cheaply after this was queued
+		auto cost = entrance->searchCost;
+		if(estimate != cost + getCostEstimate(entrance->cell, to, entranceEstimateWeight))
+			continue;
+
+		auto& cluster = getCluster(entrance->cell.first >> Chunk::sizeShift, entrance->cell.second >> Chunk::sizeShift);
+		for(std::size_t i = 0; i < cluster.entrances.size(); i++)
+		{
+			if(entrance->costs[i] != noCost && &cluster.entrances[i] != entrance)
+				reach(cluster.entrances[i], cost + entrance->costs[i], entrance);
+		}
+		for(std::size_t i = 0; i < entrance->partners.size(); i++)
+		{
+			auto partner = entrance->partners[i];
+			auto& partnerCluster = getCluster(partner.first >> Chunk::sizeShift, partner.second >> Chunk::sizeShift);
+			if(entrance->partnerEntrances.size() <= i)
+				entrance->partnerEntrances.push_back(static_cast<std::uint16_t>(std::ranges::find(partnerCluster.entrances, partner, &Entrance::cell) - partnerCluster.entrances.begin()));
+			reach(partnerCluster.entrances[entrance->partnerEntrances[i]], cost + straightCost, entrance);
+		}
+
+		auto toCost = &cluster == &toCluster ? toCosts[getLocalCell(cluster, entrance->cell)] : noCost;
+		if(toCost != noCost && cost + toCost < goalCost)
+		{
+			goalCost = cost + toCost;
+			goalParent = entrance;
+			openEntrances.emplace(goalCost, nullptr);
+		}
+	}
+
+	std::vector<Cell> hops;
+	for(auto entrance = goalParent; entrance != nullptr; entrance = entrance->searchParent)
+		hops.push_back(entrance->cell);
+	std::ranges::reverse(hops);
+	return hops;
+}
+
+std::vector<PathFinder::Cell> PathFinder::findSectorPath(Cell to, Cluster const& fromCluster, ChunkCosts const& fromCosts, Cluster const& toCluster, ChunkCosts const& toCosts)
+{
+	auto& fromSector = getSector(fromCluster.originX >> sectorShift, fromCluster.originY >> sectorShift);
+	auto const& toSector = getSector(toCluster.originX >> sectorShift, toCluster.originY >> sectorShift);
+	std::vector<std::uint32_t> goalCosts;
+	for(auto const& node : toSector.nodes)
+		goalCosts.push_back(getNodeCost(toSector, toCluster, toCosts, node).first);
+
+	//The same A* as over entrances, but over the nodes of sectors, neighbouring nodes of a sector are all connected
+	searchIndex++;
+	auto goalCost = noCost;
+	SectorNode const* goalParent{};
+	using OpenNode = std::pair<std::uint32_t, SectorNode*>;
+	std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<>> openNodes;
+	auto reach = [&openNodes, to](SectorNode& node, std::uint32_t cost, SectorNode const* parent)
+	{
+		if(node.searchIndex == searchIndex && cost >= node.searchCost)
+			return;
+		node.searchIndex = searchIndex;
+		node.searchCost = cost;
+		node.searchParent = parent;
+		openNodes.emplace(cost + getCostEstimate(node.cell, to, sectorEstimateWeight), &node);
+	};
+
+	for(auto& node : fromSector.nodes)
+	{
+		auto cost = getNodeCost(fromSector, fromCluster, fromCosts, node).first;
+		if(cost != noCost)
+			reach(node, cost, nullptr);
+	}
+
+	while(!openNodes.empty())
+	{
+		auto [estimate, node] = openNodes.top();
+		openNodes.pop();
+		if(node == nullptr)
+			break;
+
+		//Reached again more cheaply after this was queued
+		auto cost = node->searchCost;
+		if(estimate != cost + getCostEstimate(node->cell, to, sectorEstimateWeight))
+			continue;
+
+		auto& sector = getSector(node->cell.first >> sectorShift, node->cell.second >> sectorShift);
+		auto nodeIndex = static_cast<std::size_t>(node - sector.nodes.data());
+		auto const* nodeCosts = sector.nodeCosts.data() + nodeIndex * sector.nodes.size();
+		for(std::size_t i = 0; i < sector.nodes.size(); i++)
+		{
+			if(nodeCosts[i] != noCost && i != nodeIndex)
+				reach(sector.nodes[i], cost + nodeCosts[i], node);
+		}
+		for(std::size_t i = 0; i < node->partners.size(); i++)
+		{
+			auto partner = node->partners[i];
+			auto& partnerSector = getSector(partner.first >> sectorShift, partner.second >> sectorShift);
+			if(node->partnerNodes.size() <= i)
+				node->partnerNodes.push_back(static_cast<std::uint16_t>(std::ranges::find(partnerSector.nodes, partner, &SectorNode::cell) - partnerSector.nodes.begin()));
+			reach(partnerSector.nodes[node->partnerNodes[i]], cost + straightCost, node);
+		}
+
+		auto toCost = &sector == &toSector ? goalCosts[nodeIndex] : noCost;
+		if(toCost != noCost && cost + toCost < goalCost)
+		{
+			goalCost = cost + toCost;
+			goalParent = node;
+			openNodes.emplace(goalCost, nullptr);
+		}
+	}
+
+	if(goalParent == nullptr)
+		return {};
+
+	std::vector<SectorNode const*> passedNodes;
+	for(auto node = goalParent; node != nullptr; node = node->searchParent)
+		passedNodes.push_back(node);
+	std::ranges::reverse(passedNodes);
+
+	//Nodes of a sector lead to the entrances between them, leaving out the entrance started from
+	std::vector<Cell> hops;
+	auto appendEntrances = [&hops](Sector const& sector, SectorNode const& node, std::uint16_t entrance)
+	{
+		while(entrance != node.entrance)
+		{
+			entrance = node.nextEntrances[entrance];
+			hops.push_back(sector.entrances[entrance]);
+		}
+	};
+
+	auto firstEntrance = getNodeCost(fromSector, fromCluster, fromCosts, *passedNodes.front()).second;
+	hops.push_back(fromSector.entrances[firstEntrance]);
+	appendEntrances(fromSector, *passedNodes.front(), firstEntrance);
+	for(std::size_t i = 0; i + 1 < passedNodes.size(); i++)
+	{
+		auto [sectorX, sectorY] = Cell{passedNodes[i]->cell.first >> sectorShift, passedNodes[i]->cell.second >> sectorShift};
+		auto [nextSectorX, nextSectorY] = Cell{passedNodes[i + 1]->cell.first >> sectorShift, passedNodes[i + 1]->cell.second >> sectorShift};
+		if(sectorX != nextSectorX || sectorY != nextSectorY)
+			hops.push_back(passedNodes[i + 1]->cell);
+		else
+			appendEntrances(getSector(sectorX, sectorY), *passedNodes[i + 1], passedNodes[i]->entrance);
+	}
+
+	//Entrances lead to nodes, so the way from the last node to the goal's chunk is found backwards
+	auto const& lastNode = *passedNodes.back();
+	auto lastHop = hops.size();
+	for(auto entrance = getNodeCost(toSector, toCluster, toCosts, lastNode).second; entrance != lastNode.entrance; entrance = lastNode.nextEntrances[entrance])
+		hops.push_back(toSector.entrances[entrance]);
+	std::reverse(hops.begin() + lastHop, hops.end());
+	return hops;
+}
+
+PathFinder::Cluster& PathFinder::getCluster(std::int32_t chunkX, std::int32_t chunkY)
+{
+	auto key = getCellKey({chunkX, chunkY});
+	auto cluster = clusterIndices.find(key);
+	if(cluster == clusterIndices.end())
+	{
+		clusters.push_front(buildCluster(chunkX, chunkY));
+		clusterIndices.emplace(key, clusters.begin());
+	}
+	else
+		clusters.splice(clusters.begin(), clusters, cluster->second);
+	return clusters.front();
+}
+
+PathFinder::Cluster PathFinder::buildCluster(std::int32_t chunkX, std::int32_t chunkY)
+{
+	Cluster cluster{chunkX * Chunk::size, chunkY * Chunk::size, {}, {}};
+	for(std::int32_t y = 0; y < Chunk::size; y++)
+		cluster.wallRows[y] = searchLevel ? searchLevel->getRowBits(cluster.originX + levelOffsetX, cluster.originY + y + levelOffsetY) : ~std::uint32_t{};
+
+	auto addEntrance = [&cluster](Cell cell, Cell partner)
+	{
+		auto entrance = std::ranges::find(cluster.entrances, cell, &Entrance::cell);
+		if(entrance != cluster.entrances.end())
+			entrance->partners.push_back(partner);
+		else
+			cluster.entrances.push_back({cell, {partner}, {}, {}, {}, {}, {}, {}});
+	};
+
+	//Openings are runs of cells open on both sides of a border, the neighbour finds the same ones from its side
+	constexpr auto last = Chunk::size - 1;
+	for(auto [cellX, cellY, stepX, stepY, partnerX, partnerY] : {std::array{0, 0, 0, 1, -1, 0}, std::array{last, 0, 0, 1, 1, 0}, std::array{0, 0, 1, 0, 0, -1}, std::array{0, last, 1, 0, 0, 1}})
+	{
+		auto getIsOpen = [&](std::int32_t i)
+		{
+			Cell cell{cluster.originX + cellX + stepX * i, cluster.originY + cellY + stepY * i};
+			return !getIsWall(cell) && !getIsWall({cell.first + partnerX, cell.second + partnerY});
+		};
+		auto addTransition = [&](std::int32_t i)
+		{
+			Cell cell{cluster.originX + cellX + stepX * i, cluster.originY + cellY + stepY * i};
+			addEntrance(cell, {cell.first + partnerX, cell.second + partnerY});
+		};
+
+		for(std::int32_t first = 0; first < Chunk::size; first++)
+		{
+			if(!getIsOpen(first))
+				continue;
+
+			auto end = first + 1;
+			while(end < Chunk::size && getIsOpen(end))
+				end++;
+			if(end - first >= wideOpening)
+			{
+				addTransition(first);
+				addTransition(end - 1);
+			}
+			else
+				addTransition((first + end - 1) / 2);
+			first = end;
+		}
+	}
+
+	auto costs = std::make_unique<ChunkCosts>();
+	auto parents = std::make_unique<ChunkParents>();
+	for(auto& entrance : cluster.entrances)
+	{
+		searchCluster(cluster, entrance.cell, *costs, *parents);
+		for(auto const& other : cluster.entrances)
+			entrance.costs.push_back((*costs)[getLocalCell(cluster, other.cell)]);
+	}
+	return cluster;
+}
+
+PathFinder::Sector& PathFinder::getSector(std::int32_t sectorX, std::int32_t sectorY)
+{
+	auto key = getCellKey({sectorX, sectorY});
+	auto sector = sectorIndices.find(key);
+	if(sector == sectorIndices.end())
+	{
+		sectors.push_front(buildSector(sectorX, sectorY));
+		sectorIndices.emplace(key, sectors.begin());
+	}
+	else
+		sectors.splice(sectors.begin(), sectors, sector->second);
+	return sectors.front();
+}
+
+PathFinder::Sector PathFinder::buildSector(std::int32_t sectorX, std::int32_t sectorY)
+{
+	Sector sector{sectorX * sectorChunks, sectorY * sectorChunks, {}, {}, {}, {}};
+	for(std::int32_t chunk = 0; chunk < sectorChunks * sectorChunks; chunk++)
+	{
+		sector.firstEntrances[chunk] = static_cast<std::uint16_t>(sector.entrances.size());
+		for(auto const& entrance : getCluster(sector.chunkX + chunk % sectorChunks, sector.chunkY + chunk / sectorChunks).entrances)
+			sector.entrances.push_back(entrance.cell);
+	}
+	sector.firstEntrances.back() = static_cast<std::uint16_t>(sector.entrances.size());
+
+	//Entrances of a chunk are connected by their costs, partners inside the sector by a step, partners outside make the entrance a node
+	auto getIsInside = [sectorX, sectorY](Cell cell) { return cell.first >> sectorShift == sectorX && cell.second >> sectorShift == sectorY; };
+	std::vector<std::vector<std::pair<std::uint16_t, std::uint32_t>>> edges(sector.entrances.size());
+	for(std::int32_t chunk = 0; chunk < sectorChunks * sectorChunks; chunk++)
+	{
+		auto const& cluster = getCluster(sector.chunkX + chunk % sectorChunks, sector.chunkY + chunk / sectorChunks);
+		for(std::size_t i = 0; i < cluster.entrances.size(); i++)
+		{
+			auto const& entrance = cluster.entrances[i];
+			auto index = static_cast<std::uint16_t>(sector.firstEntrances[chunk] + i);
+			for(std::size_t other = 0; other < cluster.entrances.size(); other++)
+			{
+				if(other != i && entrance.costs[other] != noCost)
+					edges[index].emplace_back(static_cast<std::uint16_t>(sector.firstEntrances[chunk] + other), entrance.costs[other]);
+			}
+
+			std::vector<Cell> outsidePartners;
+			for(auto partner : entrance.partners)
+			{
+				if(!getIsInside(partner))
+				{
+					outsidePartners.push_back(partner);
+					continue;
+				}
+
+				auto partnerChunk = getSectorChunk(sector, partner);
+				auto first = sector.entrances.begin() + sector.firstEntrances[partnerChunk], last = sector.entrances.begin() + sector.firstEntrances[partnerChunk + 1];
+				edges[index].emplace_back(static_cast<std::uint16_t>(std::find(first, last, partner) - sector.entrances.begin()), straightCost);
+			}
+			if(!outsidePartners.empty())
+				sector.nodes.push_back({entrance.cell, index, std::move(outsidePartners), {}, {}, {}, {}, {}, {}});
+		}
+	}
+
+	//Dijkstra from every node over the entrances, the next entrance of each leads back towards the node since costs are the same both ways
+	using OpenEntrance = std::pair<std::uint32_t, std::uint16_t>;
+	for(auto& node : sector.nodes)
+	{
+		node.costs.assign(sector.entrances.size(), noCost);
+		node.nextEntrances.assign(sector.entrances.size(), node.entrance);
+		node.costs[node.entrance] = 0;
+		std::priority_queue<OpenEntrance, std::vector<OpenEntrance>, std::greater<>> openEntrances;
+		openEntrances.emplace(0, node.entrance);
+		while(!openEntrances.empty())
+		{
+			auto [cost, entrance] = openEntrances.top();
+			openEntrances.pop();
+			if(cost != node.costs[entrance])
+				continue;
+
+			for(auto [neighbour, edgeCost] : edges[entrance])
+			{
+				if(cost + edgeCost < node.costs[neighbour])
+				{
+					node.costs[neighbour] = cost + edgeCost;
+					node.nextEntrances[neighbour] = entrance;
+					openEntrances.emplace(cost + edgeCost, neighbour);
+				}
+			}
+		}
+	}
+
+	//Searches over sectors read the costs from a node to all others in a row
+	for(auto const& node : sector.nodes)
+	{
+		for(auto const& other : sector.nodes)
+			sector.nodeCosts.push_back(other.costs[node.entrance]);
+	}
+	return sector;
+}
+
+void PathFinder::trimCaches()
+{
+	while(clusters.size() > clusterCacheSize)
+	{
+		clusterIndices.erase(getCellKey({clusters.back().originX >> Chunk::sizeShift, clusters.back().originY >> Chunk::sizeShift}));
+		clusters.pop_back();
+	}
+	while(sectors.size() > sectorCacheSize)
+	{
+		sectorIndices.erase(getCellKey({sectors.back().chunkX >> sectorChunksShift, sectors.back().chunkY >> sectorChunksShift}));
+		sectors.pop_back();
+	}
+}
+
+void PathFinder::searchCluster(Cluster const& cluster, Cell from, ChunkCosts& costs, ChunkParents& parents)
+{
+	costs.fill(noCost);
+	auto start = getLocalCell(cluster, from);
+	costs[start] = 0;
+	parents[start] = start;
+
+	auto getIsClusterWall = [&cluster](std::int32_t x, std::int32_t y) { return x < 0 || y < 0 || x >= Chunk::size || y >= Chunk::size || (cluster.wallRows[y] >> x & 1); };
+	//Steps cost less than there are buckets, so cells are queued by their cost around the one being taken from without ever reaching it
+	std::array<std::vector<std::uint16_t>, diagonalCost + 1> openCells;
+	openCells[0].push_back(start);
+	std::size_t openCount{1};
+	for(std::uint32_t cost = 0; openCount != 0; cost++)
+	{
+		auto& bucket = openCells[cost % openCells.size()];
+		openCount -= bucket.size();
+		for(auto cell : bucket)
+		{
+			if(cost != costs[cell])
+				continue;
+
+			std::int32_t x = cell % Chunk::size, y = cell / Chunk::size;
+			for(std::int32_t offsetY = -1; offsetY <= 1; offsetY++)
+			{
+				for(std::int32_t offsetX = -1; offsetX <= 1; offsetX++)
+				{
+					bool isDiagonal = offsetX != 0 && offsetY != 0;
+					if((offsetX == 0 && offsetY == 0) || getIsClusterWall(x + offsetX, y + offsetY) ||
+					   (isDiagonal && (getIsClusterWall(x + offsetX, y) || getIsClusterWall(x, y + offsetY))))
+						continue;
+
+					auto neighbour = static_cast<std::uint16_t>(x + offsetX + (y + offsetY) * Chunk::size);
+					auto neighbourCost = cost + (isDiagonal ? diagonalCost : straightCost);
+					if(neighbourCost < costs[neighbour])
+					{
+						costs[neighbour] = neighbourCost;
+						parents[neighbour] = cell;
+						openCells[neighbourCost % openCells.size()].push_back(neighbour);
+						openCount++;
+					}
+				}
+			}
+		}
+		bucket.clear();
+	}
+}
+
+PathFinder::ChunkParents const& PathFinder::getParents(Cluster const& cluster, Entrance& entrance)
+{
+	if(!entrance.parents)
+	{
+		auto costs = std::make_unique<ChunkCosts>();
+		entrance.parents = std::make_unique<ChunkParents>();
+		searchCluster(cluster, entrance.cell, *costs, *entrance.parents);
+	}
+	return *entrance.parents;
+}
+
+std::pair<std::uint32_t, std::uint16_t> PathFinder::getNodeCost(Sector const& sector, Cluster const& cluster, ChunkCosts const& costs, SectorNode const& node)
+{
+	auto firstEntrance = sector.firstEntrances[getSectorChunk(sector, {cluster.originX, cluster.originY})];
+	std::pair<std::uint32_t, std::uint16_t> best{noCost, 0};
+	for(std::size_t i = 0; i < cluster.entrances.size(); i++)
+	{
+		auto cellCost = costs[getLocalCell(cluster, cluster.entrances[i].cell)];
+		auto entrance = static_cast<std::uint16_t>(firstEntrance + i);
+		if(cellCost != noCost && node.costs[entrance] != noCost && cellCost + node.costs[entrance] < best.first)
+			best = {cellCost + node.costs[entrance], entrance};
+	}
+	return best;
+}
+
+void PathFinder::appendTrace(std::vector<Cell>& path, Cluster const& cluster, ChunkParents const& parents, Cell cell, bool isTowardsStart)
+{
+	auto toCell = [&cluster](std::uint16_t localCell) { return Cell{cluster.originX + localCell % Chunk::size, cluster.originY + localCell / Chunk::size}; };
+	auto localCell = getLocalCell(cluster, cell);
+	if(isTowardsStart)
+	{
+		while(parents[localCell] != localCell)
+		{
+			localCell = parents[localCell];
+			path.push_back(toCell(localCell));
+		}
+		return;
+	}
+
+	auto firstCell = path.size();
+	for(; parents[localCell] != localCell; localCell = parents[localCell])
+		path.push_back(toCell(localCell));
+	std::reverse(path.begin() + firstCell, path.end());
+}
+
+std::uint32_t PathFinder::getCostEstimate(Cell from, Cell to, std::uint32_t weight)
+{
+	//Diagonal steps as far as both axes go, straight ones for the rest
+	auto distanceX = static_cast<std::uint32_t>(std::abs(to.first - from.first)), distanceY = static_cast<std::uint32_t>(std::abs(to.second - from.second));
+	auto cost = straightCost * std::max(distanceX, distanceY) + (diagonalCost - straightCost) * std::min(distanceX, distanceY);
+	return cost * weight / estimateScale;
+}
+
+std::uint64_t PathFinder::getQueryKey(Query const& query)
+{
+	return getCellKey({query.fromX, query.fromY}) * 0x9E3779B97F4A7C15 ^ getCellKey({query.toX, query.toY});
+}
@@ -0,0 +1,164 @@
+export module PathFinder;
+
+export import std;
+export import World;
+
+//Paths between cells of the level, searched over the entrances between chunks rather than over every cell
+//Long paths are searched over the entrances leading out of sectors of chunks first, and only then down to chunk entrances and cells
+//Requests are answered together on a worker, recently used chunks, sectors and paths are kept for later searches
+export class PathFinder
+{
+public:
+	using Cell = std::pair<std::int32_t, std::int32_t>;
+
+	//Recent paths kept for repeated requests
+	static constexpr std::uint32_t cacheSize{256};
+	//Chunks and sectors kept once searched, older ones are built again when a search needs them
+	//There's room for the chunks of every kept sector, paths through them are traced without building their chunks again
+	static constexpr std::uint32_t clusterCacheSize{4096}, sectorCacheSize{64};
+
+	static void release();
+
+	//Returns the id the path can be taken with once it was found
+	static std::uint32_t request(std::int32_t fromX, std::int32_t fromY, std::int32_t toX, std::int32_t toY);
+	//Takes the paths the worker found and hands it the requests made since
+	static void update();
+	//Nothing while the path is still being searched, cells from the start to the goal once found, no cells if there's no way
+	static std::optional<std::vector<Cell>> takePath(std::uint32_t request);
+
+private:
+	struct Query
+	{
+		std::int32_t fromX, fromY, toX, toY;
+
+		bool operator==(Query const& rhs) const = default;
+	};
+
+	struct Request
+	{
+		std::uint32_t id;
+		Query query;
+	};
+
+	//Costs of straight and diagonal steps, diagonal steps can't cut past walls
+	static constexpr std::uint32_t straightCost{10}, diagonalCost{14};
+	static constexpr std::uint32_t noCost{std::numeric_limits<std::uint32_t>::max()};
+	//Estimates are inflated so searches head for the goal instead of trying every detour first, paths come out a few percent longer
+	//Searches over sectors inflate them more, every node they take from the queue queues most nodes of its sector
+	static constexpr std::uint32_t entranceEstimateWeight{3}, sectorEstimateWeight{4}, estimateScale{2};
+	//Openings between chunks at least this wide get an entrance at either end, narrower ones one in the middle
+	static constexpr std::int32_t wideOpening{6};
+	//Sectors are squares of chunks, paths reaching at least a sector's width along either axis are searched over them first
+	static constexpr std::int32_t sectorChunksShift{3};
+	static constexpr std::int32_t sectorChunks{1 << sectorChunksShift};
+	static constexpr std::int32_t sectorShift{Chunk::sizeShift + sectorChunksShift};
+	static constexpr std::int32_t sectorSize{1 << sectorShift};
+
+	//Cells of a chunk are numbered x + y * Chunk::size, parents lead back to where the search started
+	using ChunkCosts = std::array<std::uint32_t, Chunk::cellCount>;
+	using ChunkParents = std::array<std::uint16_t, Chunk::cellCount>;
+
+	struct Entrance
+	{
+		Cell cell;
+		//Cells across the chunk border it leads to
+		std::vector<Cell> partners;
+		//Cost to every entrance of the chunk, noCost if it can't be reached inside the chunk
+		std::vector<std::uint32_t> costs;
+		//Only traced once a path passes through, most entrances are only ever searched over
+		std::unique_ptr<ChunkParents> parents;
+		//Indices of the partners among the entrances of their chunks, found when first needed since those chunks may not be built yet
+		std::vector<std::uint16_t> partnerEntrances;
+		//Left by the last search over entrances that reached it
+		std::uint32_t searchIndex, searchCost;
+		Entrance const* searchParent;
+	};
+
+	struct Cluster
+	{
+		std::int32_t originX, originY;
+		std::array<std::uint32_t, Chunk::size> wallRows;
+		std::vector<Entrance> entrances;
+	};
+
+	//Entrance of a chunk in the sector leading out of it
+	struct SectorNode
+	{
+		Cell cell;
+		//Index among the entrances of the sector
+		std::uint16_t entrance;
+		//Cells in other sectors it leads to
+		std::vector<Cell> partners;
+		//Cost from every entrance of the sector to this one inside the sector, and the next entrance on the way
+		std::vector<std::uint32_t> costs;
+		std::vector<std::uint16_t> nextEntrances;
+		//Indices of the partners among the nodes of their sectors, found when first needed
+		std::vector<std::uint16_t> partnerNodes;
+		//Left by the last search over nodes that reached it
+		std::uint32_t searchIndex, searchCost;
+		SectorNode const* searchParent;
+	};
+
+	struct Sector
+	{
+		std::int32_t chunkX, chunkY;
+		//Entrances of all chunks of the sector, those of each chunk in the order the chunk keeps them
+		std::vector<Cell> entrances;
+		//Where the entrances of each chunk start, row by row, and where the last ones end
+		std::array<std::uint16_t, sectorChunks * sectorChunks + 1> firstEntrances;
+		std::vector<SectorNode> nodes;
+		//Cost from each node to every node inside the sector, a row per node
+		std::vector<std::uint32_t> nodeCosts;
+	};
+
+	struct CacheEntry
+	{
+		Query query;
+		std::vector<Cell> path;
+	};
+
+	//Runs on the worker, answers the handed over requests
+	static void search();
+	static std::vector<Cell> findPath(Query const& query);
+	//Entrances passed from the start to the goal, searched over the entrances of every chunk or over the nodes of sectors, none if there's no way
+	static std::vector<Cell> findEntrancePath(Cell to, Cluster& fromCluster, ChunkCosts const& fromCosts, Cluster const& toCluster, ChunkCosts const& toCosts);
+	static std::vector<Cell> findSectorPath(Cell to, Cluster const& fromCluster, ChunkCosts const& fromCosts, Cluster const& toCluster, ChunkCosts const& toCosts);
+	//Clusters and sectors stay where they are until the search is done with its request, only then are the least recently used ones dropped
+	static Cluster& getCluster(std::int32_t chunkX, std::int32_t chunkY);
+	static Cluster buildCluster(std::int32_t chunkX, std::int32_t chunkY);
+	static Sector& getSector(std::int32_t sectorX, std::int32_t sectorY);
+	static Sector buildSector(std::int32_t sectorX, std::int32_t sectorY);
+	static void trimCaches();
+	static void searchCluster(Cluster const& cluster, Cell from, ChunkCosts& costs, ChunkParents& parents);
+	static ChunkParents const& getParents(Cluster const& cluster, Entrance& entrance);
+	//Cheapest way from a cell to a node of its sector through the entrances of the cell's chunk, and the entrance it leaves the chunk by
+	static std::pair<std::uint32_t, std::uint16_t> getNodeCost(Sector const& sector, Cluster const& cluster, ChunkCosts const& costs, SectorNode const& node);
+	//Appends the cells from where the search started to the cell, or from the cell to where it started, leaving out the first
+	static void appendTrace(std::vector<Cell>& path, Cluster const& cluster, ChunkParents const& parents, Cell cell, bool isTowardsStart);
+	static bool getIsWall(Cell cell) { return !searchLevel || searchLevel->getIsWall(cell.first + levelOffsetX, cell.second + levelOffsetY); }
+	static std::uint32_t getCostEstimate(Cell from, Cell to, std::uint32_t weight);
+	static std::uint16_t getLocalCell(Cluster const& cluster, Cell cell) { return static_cast<std::uint16_t>(cell.first - cluster.originX + (cell.second - cluster.originY) * Chunk::size); }
+	static std::int32_t getSectorChunk(Sector const& sector, Cell cell) { return (cell.first >> Chunk::sizeShift) - sector.chunkX + ((cell.second >> Chunk::sizeShift) - sector.chunkY) * sectorChunks; }
+	static std::uint64_t getCellKey(Cell cell) { return std::uint64_t(std::uint32_t(cell.first)) << 32 | std::uint32_t(cell.second); }
+	static std::uint64_t getQueryKey(Query const& query);
+
+	//Only touched by the main thread
+	inline static std::uint32_t nextRequestId{};
+	inline static std::vector<Request> queuedRequests;
+	inline static std::unordered_map<std::uint32_t, std::vector<Cell>> foundPaths;
+
+	//Owned by the search while isSearching is set, by the main thread otherwise
+	inline static std::atomic<bool> isSearching{};
+	inline static std::shared_ptr<DungeonLevel const> searchLevel;
+	inline static std::int32_t levelOffsetX{}, levelOffsetY{};
+	inline static std::vector<Request> searchedRequests;
+	inline static std::vector<std::pair<std::uint32_t, std::vector<Cell>>> searchedPaths;
+	inline static std::uint32_t searchIndex{};
+	//Most recently used first
+	inline static std::list<Cluster> clusters;
+	inline static std::unordered_map<std::uint64_t, std::list<Cluster>::iterator> clusterIndices;
+	inline static std::list<Sector> sectors;
+	inline static std::unordered_map<std::uint64_t, std::list<Sector>::iterator> sectorIndices;
+	inline static std::list<CacheEntry> recentPaths;
+	inline static std::unordered_map<std::uint64_t, std::list<CacheEntry>::iterator> recentPathIndices;
+};
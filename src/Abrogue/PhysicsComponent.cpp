@@ -1,23 +1,35 @@
 module PhysicsComponent;
 
+import TileCollision;
+
 PhysicsComponent::PhysicsComponent()
 {
 	quadReference = QuadPool::insert(QuadData{{x, y}, {0.02f, 0.04f}});
 }
 
-void PhysicsComponent::update()
+void PhysicsComponent::setPosition(double newX, double newY)
+{
+	x = newX;
+	y = newY;
+	velocityX = 0.0;
+	velocityY = 0.0;
+	quadReference.set(QuadData{{x, y}, {0.02f, 0.04f}});
+}
+
+void PhysicsComponent::update(std::uint32_t tickCount)
 {
+	auto duration = Constants::tickDuration * tickCount;
 	double frictionCoefficient{1.0};
 	double resistanceCoefficient{20.0};
 	double walkingForce{maxSpeed * resistanceCoefficient};
 
-	auto calculateVelocityAfterFriction = [this, frictionCoefficient, resistanceCoefficient](double velocity)
+	auto calculateVelocityAfterFriction = [this, frictionCoefficient, resistanceCoefficient, duration](double velocity)
 	{
 		if(std::abs(velocity) > 0.0)
 		{
 			auto velocitySign = std::signbit(velocity);
 			auto slowSpeed = std::max(0.2 * maxSpeed, std::abs(velocity));
-			velocity -= std::copysign(slowSpeed, velocity) * frictionCoefficient * resistanceCoefficient / mass * Constants::tickDuration;
+			velocity -= std::copysign(slowSpeed, velocity) * frictionCoefficient * resistanceCoefficient / mass * duration;
 			if(std::signbit(velocity) != velocitySign)
 				velocity = 0.0;
 		}
@@ -25,8 +37,8 @@ void PhysicsComponent::update()
 		return velocity;
 	};
 
-	x += velocityX * Constants::tickDuration;
-	y += velocityY * Constants::tickDuration;
+	moveRequest = TileCollision::request(x, y, collisionHalfWidth, collisionHalfHeight, velocityX * duration, velocityY * duration);
+	isMovePending = true;
 
 	velocityX = calculateVelocityAfterFriction(velocityX);
 	velocityY = calculateVelocityAfterFriction(velocityY);
@@ -34,8 +46,25 @@ void PhysicsComponent::update()
 	double forceX = movementDirectionX * walkingForce * (movementDirectionX != 0 ? 1.0 / std::sqrt(2.0) : 1.0);
 	double forceY = movementDirectionY * walkingForce * (movementDirectionY != 0 ? 1.0 / std::sqrt(2.0) : 1.0);
 
-	velocityX += forceX / mass * frictionCoefficient * Constants::tickDuration;
-	velocityY += forceY / mass * frictionCoefficient * Constants::tickDuration;
+	velocityX += forceX / mass * frictionCoefficient * duration;
+	velocityY += forceY / mass * frictionCoefficient * duration;
+}
+
+void PhysicsComponent::applyMovement()
+{
+	if(!isMovePending)
+		return;
+	isMovePending = false;
+
+	auto result = TileCollision::getResult(moveRequest);
+	x = result.x;
+	y = result.y;
+
+	//Walls take the velocity going into them, the rest slides along
+	if(result.isBlockedX)
+		velocityX = 0.0;
+	if(result.isBlockedY)
+		velocityY = 0.0;
 
 	quadReference.set(QuadData{{x, y}, {0.02f, 0.04f}});
 }
\ No newline at end of file
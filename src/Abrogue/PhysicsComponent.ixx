@@ -10,16 +10,33 @@ public:
 	PhysicsComponent();
 
 	std::pair<double, double> getPosition() const { return {x, y}; }
+	std::pair<double, double> getVelocity() const { return {velocityX, velocityY}; }
+	bool getIsMoving() const { return velocityX != 0.0 || velocityY != 0.0; }
+	double getMaxSpeed() const { return maxSpeed; }
 
 	void setMass(double newMass) { mass = newMass; }
 	void setFrictionCoefficient(double newFriction) { frictionCoefficient = newFriction; }
 	void setMaxSpeed(double newMaxSpeed) { maxSpeed = newMaxSpeed; }
 	void setMovementX(std::int32_t direction) { movementDirectionX = direction; }
 	void setMovementY(std::int32_t direction) { movementDirectionY = direction; }
-
-	void update();
+	void setGlyph(std::uint32_t glyph) { quadReference.setGlyph(glyph); }
+	void addImpulse(double impulseX, double impulseY)
+	{
+		velocityX += impulseX / mass;
+		velocityY += impulseY / mass;
+	}
+	//Places the component without sweeping and stops it
+	void setPosition(double newX, double newY);
+
+	//Integrates velocity over tickCount ticks and requests the move, applyMovement takes the result once TileCollision::resolve ran
+	void update(std::uint32_t tickCount = 1);
+	//Does nothing if update wasn't called since the last time
+	void applyMovement();
 
 private:
+	//Slightly smaller than the quad so actors fit through corridors one cell wide without lining up exactly
+	static constexpr double collisionHalfWidth{0.016}, collisionHalfHeight{0.032};
+
 	double x{}, y{};
 	double velocityX{}, velocityY{};
 	double mass{1.0};
@@ -27,6 +44,8 @@ private:
 	double maxSpeed{1.0};
 
 	std::int32_t movementDirectionX{}, movementDirectionY{};
+	std::uint32_t moveRequest{};
+	bool isMovePending{};
 
 	QuadPool::Reference quadReference;
 };
\ No newline at end of file
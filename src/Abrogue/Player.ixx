@@ -6,6 +6,11 @@ export import PhysicsComponent;
 export class Player : public PhysicsComponent
 {
 public:
+	Player()
+	{
+		setGlyph('@');
+	}
+
 	void update()
 	{
 		PhysicsComponent::update();
@@ -0,0 +1,178 @@
+module Projectiles;
+
+import Constants;
+import JobSystem;
+
+void Projectiles::release()
+{
+	count = 0;
+	hits.clear();
+	isDirty = true;
+}
+
+bool Projectiles::spawn(double x, double y, double directionX, double directionY, bool isFromPlayer)
+{
+	auto length = std::hypot(directionX, directionY);
+	if(count == capacity || length == 0.0)
+		return false;
+
+	positionsX[count] = static_cast<float>(x);
+	positionsY[count] = static_cast<float>(y);
+	velocitiesX[count] = static_cast<float>(directionX / length) * speed;
+	velocitiesY[count] = static_cast<float>(directionY / length) * speed;
+	lifetimes[count] = lifetime;
+	fromPlayerFlags[count] = isFromPlayer;
+	count++;
+	isDirty = true;
+	return true;
+}
+
+std::vector<Projectiles::Hit> const& Projectiles::update(double playerX, double playerY)
+{
+	hits.clear();
+	if(count == 0)
+		return hits;
+
+	//Plain integration over the packed arrays, branch free so the compiler vectorizes it
+	constexpr auto duration = static_cast<float>(Constants::tickDuration);
+	for(std::uint32_t i = 0; i < count; i++)
+	{
+		endsX[i] = positionsX[i] + velocitiesX[i] * duration;
+		endsY[i] = positionsY[i] + velocitiesY[i] * duration;
+		lifetimes[i] -= duration;
+	}
+
+	//Segments only read the world and the actor grid, hand them out in blocks so a job is worth its overhead
+	constexpr std::uint32_t blockSize{256};
+	JobSystem::parallelFor((count + blockSize - 1) / blockSize, [playerX, playerY](std::size_t block)
+	{
+		for(auto i = static_cast<std::uint32_t>(block) * blockSize; i < std::min(count, static_cast<std::uint32_t>(block + 1) * blockSize); i++)
+			targets[i] = trace(i, playerX, playerY);
+	});
+
+	//Going backwards, the projectile moved into the place of a despawned one was already handled
+	for(auto i = count; i-- > 0;)
+	{
+		if(targets[i] == noTarget && lifetimes[i] > 0.0f)
+		{
+			positionsX[i] = endsX[i];
+			positionsY[i] = endsY[i];
+			continue;
+		}
+
+		if(targets[i] != noTarget && targets[i] != wallTarget)
+			hits.push_back({targets[i], velocitiesX[i], velocitiesY[i]});
+		despawn(i);
+	}
+
+	isDirty = true;
+	return hits;
+}
+
+std::uint32_t Projectiles::trace(std::uint32_t projectile, double playerX, double playerY)
+{
+	auto startX = positionsX[projectile], startY = positionsY[projectile];
+	auto endX = endsX[projectile], endY = endsY[projectile];
+	auto moveX = endX - startX, moveY = endY - startY;
+
+	auto time = traceWalls(startX, startY, endX, endY);
+	auto target = time != never ? wallTarget : noTarget;
+	if(!fromPlayerFlags[projectile])
+	{
+		if(getActorHitTime(startX, startY, moveX, moveY, playerX, playerY) < time)
+			target = playerTarget;
+		return target;
+	}
+
+	//Buckets the segment passes, widened by the hit box since actors are bucketed by their center
+	auto [firstBucketX, firstBucketY] = ActorGrid::getBucketOf(std::min(startX, endX) - ActorGrid::halfWidth, std::min(startY, endY) - ActorGrid::halfHeight);
+	auto [lastBucketX, lastBucketY] = ActorGrid::getBucketOf(std::max(startX, endX) + ActorGrid::halfWidth, std::max(startY, endY) + ActorGrid::halfHeight);
+	for(auto bucketY = firstBucketY; bucketY <= lastBucketY; bucketY++)
+	{
+		for(auto bucketX = firstBucketX; bucketX <= lastBucketX; bucketX++)
+		{
+			for(auto actor : ActorGrid::getBucket(bucketX, bucketY))
+			{
+				auto [actorX, actorY] = ActorGrid::getPosition(actor);
+				auto actorTime = getActorHitTime(startX, startY, moveX, moveY, actorX, actorY);
+				if(actorTime < time)
+				{
+					time = actorTime;
+					target = actor;
+				}
+			}
+		}
+	}
+	return target;
+}
+
+float Projectiles::traceWalls(float startX, float startY, float endX, float endY)
+{
+	auto [cellX, cellY] = World::getCell(startX, startY);
+	auto [endCellX, endCellY] = World::getCell(endX, endY);
+	if(World::getIsWall(cellX, cellY))
+		return 0.0f;
+
+	//Grid lines crossed in order of time, like the collision sweep but for a point
+	auto moveX = endX - startX, moveY = endY - startY;
+	std::int32_t stepX = moveX > 0.0f ? 1 : -1, stepY = moveY > 0.0f ? 1 : -1;
+	auto timeX = moveX != 0.0f ? ((cellX + (moveX > 0.0f)) * World::cellWidth - startX) / moveX : never;
+	auto timeY = moveY != 0.0f ? ((cellY + (moveY > 0.0f)) * World::cellHeight - startY) / moveY : never;
+	auto timeStepX = moveX != 0.0f ? World::cellWidth / std::abs(moveX) : never;
+	auto timeStepY = moveY != 0.0f ? World::cellHeight / std::abs(moveY) : never;
+	while(cellX != endCellX || cellY != endCellY)
+	{
+		auto time = std::min(timeX, timeY);
+		//Rounding can step past the end cell
+		if(time > 1.0f)
+			break;
+
+		if(timeX <= timeY)
+		{
+			cellX += stepX;
+			timeX += timeStepX;
+		}
+		else
+		{
+			cellY += stepY;
+			timeY += timeStepY;
+		}
+		if(World::getIsWall(cellX, cellY))
+			return time;
+	}
+	return never;
+}
+
+float Projectiles::getActorHitTime(float startX, float startY, float moveX, float moveY, double actorX, double actorY)
+{
+	//Overlap of the times the segment is within the box on either axis
+	auto enterTime = 0.0f, exitTime = 1.0f;
+	auto clipAxis = [&enterTime, &exitTime](float start, float move, float min, float max)
+	{
+		if(move == 0.0f)
+			return start >= min && start <= max;
+
+		auto firstTime = (min - start) / move, secondTime = (max - start) / move;
+		if(firstTime > secondTime)
+			std::swap(firstTime, secondTime);
+		enterTime = std::max(enterTime, firstTime);
+		exitTime = std::min(exitTime, secondTime);
+		return enterTime <= exitTime;
+	};
+
+	if(!clipAxis(startX, moveX, static_cast<float>(actorX - ActorGrid::halfWidth), static_cast<float>(actorX + ActorGrid::halfWidth)) ||
+	   !clipAxis(startY, moveY, static_cast<float>(actorY - ActorGrid::halfHeight), static_cast<float>(actorY + ActorGrid::halfHeight)))
+		return never;
+	return enterTime;
+}
+
+void Projectiles::despawn(std::uint32_t projectile)
+{
+	count--;
+	positionsX[projectile] = positionsX[count];
+	positionsY[projectile] = positionsY[count];
+	velocitiesX[projectile] = velocitiesX[count];
+	velocitiesY[projectile] = velocitiesY[count];
+	lifetimes[projectile] = lifetimes[count];
+	fromPlayerFlags[projectile] = fromPlayerFlags[count];
+}
@@ -0,0 +1,67 @@
+export module Projectiles;
+
+export import std;
+export import ActorGrid;
+
+//Pool of projectiles with one array per field, live projectiles are packed at the front so despawning is a swap with the last
+//They fly straight and vanish at the first wall or actor they touch or once their lifetime ran out
+export class Projectiles
+{
+public:
+	static constexpr std::uint32_t capacity{65536};
+	//In world units per second and seconds
+	static constexpr float speed{3.0f}, lifetime{1.0f};
+	//Momentum a hit passes on is the projectile's velocity times this
+	static constexpr double mass{0.5};
+	static constexpr float halfWidth{0.01f}, halfHeight{0.02f};
+	//Target of hits on the player, who isn't in the actor grid
+	static constexpr std::uint32_t playerTarget{std::numeric_limits<std::uint32_t>::max() - 1};
+
+	struct Hit
+	{
+		//Actor in the grid or playerTarget
+		std::uint32_t target;
+		float velocityX, velocityY;
+	};
+
+	static void release();
+
+	//Projectiles of the player hit actors in the grid, the rest hit the player, returns false if the pool is full or there's no direction
+	static bool spawn(double x, double y, double directionX, double directionY, bool isFromPlayer);
+	//Moves every projectile through one tick, the hits are kept until the next call
+	static std::vector<Hit> const& update(double playerX, double playerY);
+
+	[[nodiscard]] static auto getCount() { return count; }
+	[[nodiscard]] static auto const& getPositionsX() { return positionsX; }
+	[[nodiscard]] static auto const& getPositionsY() { return positionsY; }
+	[[nodiscard]] static auto const& getFromPlayerFlags() { return fromPlayerFlags; }
+
+	//Set whenever projectiles moved or were despawned since the last clear
+	[[nodiscard]] static auto getIsDirty() { return isDirty; }
+	static void clearDirty() { isDirty = false; }
+
+private:
+	static constexpr std::uint32_t noTarget{std::numeric_limits<std::uint32_t>::max()};
+	static constexpr std::uint32_t wallTarget{std::numeric_limits<std::uint32_t>::max() - 2};
+	static constexpr float never{std::numeric_limits<float>::infinity()};
+
+	//First thing the projectile's segment of this tick touches
+	static std::uint32_t trace(std::uint32_t projectile, double playerX, double playerY);
+	//Fraction of the segment at which it enters a wall cell, never if it doesn't
+	static float traceWalls(float startX, float startY, float endX, float endY);
+	//Fraction of the segment at which it enters the hit box of an actor, never if it misses
+	static float getActorHitTime(float startX, float startY, float moveX, float moveY, double actorX, double actorY);
+	static void despawn(std::uint32_t projectile);
+
+	inline static std::uint32_t count{};
+	inline static std::array<float, capacity> positionsX, positionsY;
+	inline static std::array<float, capacity> velocitiesX, velocitiesY;
+	inline static std::array<float, capacity> lifetimes;
+	inline static std::array<std::uint8_t, capacity> fromPlayerFlags;
+	//Scratch of update, where each projectile ends up this tick and what it hit
+	inline static std::array<float, capacity> endsX, endsY;
+	inline static std::array<std::uint32_t, capacity> targets;
+
+	inline static std::vector<Hit> hits;
+	inline static bool isDirty{};
+};
@@ -8,6 +8,11 @@ module;
 module RenderEngine;
 
 import ImageLoader;
+import JobSystem;
+import GlyphAtlas;
+import GlyphCache;
+import AssetManager;
+import Projectiles;
 
 VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
 
@@ -28,13 +33,16 @@ RenderEngine::SwapchainResources::SwapchainResources(RenderEngine const& engine)
 	Logger::logInfo(std::format("Chose format {} with color space {}",
 								vk::to_string(selectedFormat.format), vk::to_string(selectedFormat.colorSpace)));
 
-	//Choose present mode
+	//Choose present mode, FIFO is always supported
+	vk::PresentModeKHR requestedPresentMode{getVulkanPresentMode(engine.presentMode)};
 	vk::PresentModeKHR selectedPresentMode{vk::PresentModeKHR::eFifo};
 	for(auto presentMode : info.presentModes)
 	{
-		if(presentMode == vk::PresentModeKHR::eMailbox)
+		if(presentMode == requestedPresentMode)
 			selectedPresentMode = presentMode;
 	}
+	if(selectedPresentMode != requestedPresentMode)
+		Logger::logInfo(std::format("Present mode {} not supported", vk::to_string(requestedPresentMode)));
 	Logger::logInfo(std::format("Chose present mode {}", vk::to_string(selectedPresentMode)));
 
 	//Choose swapchain extent
@@ -50,15 +58,32 @@ RenderEngine::SwapchainResources::SwapchainResources(RenderEngine const& engine)
 
 	//Choose swapchain image count
 	uint32_t imageCount{surfaceCapabilities.minImageCount + 1};
+	if(Configuration::getSwapchainImageCount() > 0)
+		imageCount = std::max(Configuration::getSwapchainImageCount(), surfaceCapabilities.minImageCount);
 	if(surfaceCapabilities.maxImageCount > 0 && imageCount > surfaceCapabilities.maxImageCount)
 		imageCount = surfaceCapabilities.maxImageCount;
 	Logger::logInfo(std::format("Image count is {}", imageCount));
 
+	//Dynamic resolution needs blitting from an offscreen image into the swapchain
+	if(Configuration::getDynamicResolution())
+	{
+		auto formatFeatures = engine.physicalDevice.getFormatProperties(imageFormat).optimalTilingFeatures;
+		auto requiredFeatures = vk::FormatFeatureFlagBits::eColorAttachment | vk::FormatFeatureFlagBits::eBlitSrc |
+			vk::FormatFeatureFlagBits::eBlitDst | vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+		useOffscreenTarget = (surfaceCapabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferDst) &&
+			(formatFeatures & requiredFeatures) == requiredFeatures;
+		if(!useOffscreenTarget)
+			Logger::logInfo("Dynamic resolution not supported by surface, rendering at native resolution");
+	}
+	vk::ImageUsageFlags swapchainUsage{vk::ImageUsageFlagBits::eColorAttachment};
+	if(useOffscreenTarget)
+		swapchainUsage |= vk::ImageUsageFlagBits::eTransferDst;
+
 	//Create swapchain
 	vk::SharingMode sharingMode{info.graphicsIndex != info.presentationIndex ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive};
 	std::vector<uint32_t> queueFamilyIndices{sharingMode == vk::SharingMode::eConcurrent ? std::vector{info.graphicsIndex, info.presentationIndex} : std::vector<uint32_t>{}};
 	vk::SwapchainCreateInfoKHR swapchainCreateInfo{{}, engine.surface.get(), imageCount, selectedFormat.format, selectedFormat.colorSpace,
-		imageExtent, 1, vk::ImageUsageFlagBits::eColorAttachment, sharingMode, queueFamilyIndices,
+		imageExtent, 1, swapchainUsage, sharingMode, queueFamilyIndices,
 		surfaceCapabilities.currentTransform, vk::CompositeAlphaFlagBitsKHR::eOpaque, selectedPresentMode, VK_TRUE, engine.oldSwapchainResources.swapchain.get()};
 	if(engine.checkVulkanErrorOccured(swapchain, engine.device->createSwapchainKHRUnique(swapchainCreateInfo), "Created swapchain", "Failed to create swapchain"))
 		return;
@@ -79,27 +104,47 @@ RenderEngine::SwapchainResources::SwapchainResources(RenderEngine const& engine)
 			return;
 	}
 
-	//Define attachment
+	//Define attachment, layout transitions are done by the render graph
 	vk::AttachmentDescription colorAttachment{{}, imageFormat, vk::SampleCountFlagBits::e1,
 											  vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore,
 											  vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eDontCare,
-											  vk::ImageLayout::eUndefined, vk::ImageLayout::ePresentSrcKHR};
+											  vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eColorAttachmentOptimal};
 	vk::AttachmentReference colorAttachmentReference{0, vk::ImageLayout::eColorAttachmentOptimal};
 
 	//Create render pass
 	vk::SubpassDescription subpassDescription{{}, vk::PipelineBindPoint::eGraphics, {}, colorAttachmentReference};
-	vk::SubpassDependency subpassDependency{VK_SUBPASS_EXTERNAL, 0, vk::PipelineStageFlagBits::eColorAttachmentOutput,
-											vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, vk::AccessFlagBits::eColorAttachmentWrite};
-	vk::RenderPassCreateInfo renderPassCreateInfo{{}, colorAttachment, subpassDescription, subpassDependency};
+	vk::RenderPassCreateInfo renderPassCreateInfo{{}, colorAttachment, subpassDescription};
 	if(engine.checkVulkanErrorOccured(renderPass, engine.device->createRenderPassUnique(renderPassCreateInfo),
 									  "Created render pass", "Failed to create render pass"))
 		return;
 
-	//Create swapchain framebuffers
-	framebuffers.resize(imageViews.size());
+	//Build render graph, with dynamic resolution the scene is drawn offscreen and upscaled into the swapchain image
+	swapchainImageHandle = renderGraph.importImage("swapchain image", images, RenderGraph::ResourceUsage::present);
+	auto sceneTargetHandle = swapchainImageHandle;
+	if(useOffscreenTarget)
+	{
+		sceneColorHandle = renderGraph.createTransientImage("scene color", imageFormat, imageExtent);
+		sceneTargetHandle = sceneColorHandle;
+	}
+
+	renderGraph.addPass("scene", {}, {{sceneTargetHandle, RenderGraph::ResourceUsage::colorAttachment}},
+						[&engine](vk::CommandBuffer commandBuffer, uint32_t imageIndex) { engine.recordScenePass(commandBuffer, imageIndex); });
+	if(useOffscreenTarget)
+	{
+		renderGraph.addPass("upscale", {{sceneColorHandle, RenderGraph::ResourceUsage::transferSource}}, {{swapchainImageHandle, RenderGraph::ResourceUsage::transferDestination}},
+							[&engine](vk::CommandBuffer commandBuffer, uint32_t imageIndex) { engine.recordUpscalePass(commandBuffer, imageIndex); });
+	}
+
+	if(!renderGraph.compile(engine))
+		return;
+	Logger::logInfo("Compiled render graph");
+
+	//Create framebuffers, a single one for the offscreen target
+	framebuffers.resize(useOffscreenTarget ? 1 : imageViews.size());
 	for(size_t i = 0; i < framebuffers.size(); i++)
 	{
-		vk::FramebufferCreateInfo framebufferCreateInfo{{}, renderPass.get(), imageViews[i].get(),
+		auto attachmentView = useOffscreenTarget ? renderGraph.getImageView(sceneColorHandle) : imageViews[i].get();
+		vk::FramebufferCreateInfo framebufferCreateInfo{{}, renderPass.get(), attachmentView,
 			imageExtent.width, imageExtent.height, 1};
 		if(engine.checkVulkanErrorOccured(framebuffers[i], engine.device->createFramebufferUnique(framebufferCreateInfo), "", "Failed to create swapchain buffer"))
 			return;
@@ -116,6 +161,14 @@ RenderEngine::RenderEngine()
 		return;
 	}
 
+	//Start loading assets first, workers read and decode them while the device is created
+	//Prefer the precomputed atlas with mips, fall back to decoding the png
+	auto texturePath = AssetPack::contains("textures/tiles.ktx2") ? "textures/tiles.ktx2"sv : "textures/tiles.png"sv;
+	auto tileImageHandle = AssetManager::load<ImageLoader>(texturePath);
+	auto glyphAtlasHandle = AssetManager::load<GlyphAtlas>("textures/tiles.glyphs");
+	auto vertexShaderHandle = AssetManager::load<Asset>("shaders/quadVert.spv");
+	auto fragmentShaderHandle = AssetManager::load<Asset>("shaders/quadFrag.spv");
+
 	VULKAN_HPP_DEFAULT_DISPATCHER.init();
 
 	//Get available instance extensions
@@ -275,6 +328,7 @@ RenderEngine::RenderEngine()
 	vk::PhysicalDeviceFeatures2 requiredPhysicalDeviceFeatures({}, &features11);
 	requiredPhysicalDeviceFeatures.features.shaderInt64 = VK_TRUE;
 	requiredPhysicalDeviceFeatures.features.samplerAnisotropy = VK_TRUE;
+	requiredPhysicalDeviceFeatures.features.textureCompressionBC = physicalDevice.getFeatures().textureCompressionBC;
 	vk::DeviceCreateInfo deviceCreateInfo{{}, queueCreateInfos, requiredLayers, requiredPhysicalDeviceExtensions, nullptr, &requiredPhysicalDeviceFeatures};
 	if(checkVulkanErrorOccured(device, physicalDevice.createDeviceUnique(deviceCreateInfo),
 							   "Created logical device", "Failed to create logical device"))
@@ -287,6 +341,7 @@ RenderEngine::RenderEngine()
 	graphicsQueue = device->getQueue(physicalDeviceInfo.graphicsIndex, 0);
 	presentationQueue = device->getQueue(physicalDeviceInfo.presentationIndex, 0);
 
+	presentMode = Configuration::getIsBenchmark() ? PresentMode::immediate : Configuration::getPresentMode();
 	swapchainResources = SwapchainResources(*this);
 
 	//Create command pool
@@ -294,14 +349,55 @@ RenderEngine::RenderEngine()
 	if(checkVulkanErrorOccured(commandPool, device->createCommandPoolUnique(poolCreateInfo), "Created command pool", "Failed to create command pool"))
 		return;
 
-	textureResources = TextureResources(*this, "textures/tiles.png");
+	//Create per thread command pools for recording secondary command buffers
+	vk::CommandPoolCreateInfo recordingPoolCreateInfo{vk::CommandPoolCreateFlagBits::eTransient, physicalDeviceInfo.graphicsIndex};
+	for(auto& contexts : recordingContexts)
+	{
+		contexts.resize(JobSystem::getThreadCount());
+		for(auto& context : contexts)
+		{
+			if(checkVulkanErrorOccured(context.commandPool, device->createCommandPoolUnique(recordingPoolCreateInfo), "", "Failed to create recording command pool"))
+				return;
+		}
+	}
+	Logger::logInfo(std::format("Created {} recording command pools", maxFramesInFlight * JobSystem::getThreadCount()));
+
+	//Create timestamp queries for measuring GPU frame time, two per frame
+	if(physicalDeviceInfo.properties.limits.timestampComputeAndGraphics)
+	{
+		vk::QueryPoolCreateInfo queryPoolCreateInfo({}, vk::QueryType::eTimestamp, maxFramesInFlight * 2);
+		if(checkVulkanErrorOccured(timestampQueryPool, device->createQueryPoolUnique(queryPoolCreateInfo), "Created timestamp query pool", "Failed to create timestamp query pool"))
+			return;
+	}
+
+	auto tileImage = AssetManager::wait(tileImageHandle);
+	if(!tileImage)
+	{
+		hasError = true;
+		Logger::logError(std::format("Failed to load texture {}", texturePath));
+		return;
+	}
+
+	//All initial uploads go to the GPU in one submission
+	{
+		SingleUseCommandBuffer uploadCommandBuffer(*this, graphicsQueue);
+		if(!hasError)
+			textureResources = TextureResources(*this, *tileImage, texturePath, uploadCommandBuffer.get());
+		if(!hasError)
+			glyphCacheTexture = TextureResources(*this, GlyphCache::textureWidth, GlyphCache::textureHeight, uploadCommandBuffer.get());
+	}
+	textureResources.stagingBuffer = {};
+	AssetManager::unload(tileImageHandle);
+	if(hasError)
+		return;
 
-	vk::DescriptorSetLayoutBinding layoutBinding(0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment, {});
-	vk::DescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo({}, layoutBinding);
+	std::array<vk::DescriptorSetLayoutBinding, 2> layoutBindings{vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment, {}),
+																 vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment, {})};
+	vk::DescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo({}, layoutBindings);
 	if(checkVulkanErrorOccured(descriptorSetLayout, device->createDescriptorSetLayoutUnique(descriptorSetLayoutCreateInfo), "Created descriptor set layout", "Failed to create descriptor set layout"))
 		return;
 
-	vk::DescriptorPoolSize descriptorPoolSize(vk::DescriptorType::eSampler, maxFramesInFlight);
+	vk::DescriptorPoolSize descriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, maxFramesInFlight * (uint32_t)layoutBindings.size());
 	vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo({}, maxFramesInFlight, descriptorPoolSize);
 	if(checkVulkanErrorOccured(descriptorPool, device->createDescriptorPoolUnique(descriptorPoolCreateInfo), "Created descriptor pool", "Failed to create descriptor pool"))
 		return;
@@ -317,21 +413,26 @@ RenderEngine::RenderEngine()
 	for(size_t i = 0; i < maxFramesInFlight; i++)
 	{
 		vk::DescriptorImageInfo imageInfo(textureResources.sampler.get(), textureResources.imageView.get(), vk::ImageLayout::eShaderReadOnlyOptimal);
-		vk::WriteDescriptorSet writeDescriptorSet(descriptorSets[i], 0, 0, vk::DescriptorType::eCombinedImageSampler, imageInfo);
-		device->updateDescriptorSets(writeDescriptorSet, {});
+		vk::DescriptorImageInfo glyphCacheImageInfo(glyphCacheTexture.sampler.get(), glyphCacheTexture.imageView.get(), vk::ImageLayout::eShaderReadOnlyOptimal);
+		std::array<vk::WriteDescriptorSet, 2> writeDescriptorSets{vk::WriteDescriptorSet(descriptorSets[i], 0, 0, vk::DescriptorType::eCombinedImageSampler, imageInfo),
+																  vk::WriteDescriptorSet(descriptorSets[i], 1, 0, vk::DescriptorType::eCombinedImageSampler, glyphCacheImageInfo)};
+		device->updateDescriptorSets(writeDescriptorSets, {});
 	}
 
 	//Create shader modules
-	auto vertexShaderModule = createShaderModule("shaders/quadVert.spv");
-	if(!vertexShaderModule)
-		return;
-	auto fragmentShaderModule = createShaderModule("shaders/quadFrag.spv");
-	if(!fragmentShaderModule)
+	auto vertexShaderModule = createShaderModule(AssetManager::wait(vertexShaderHandle), "shaders/quadVert.spv");
+	auto fragmentShaderModule = createShaderModule(AssetManager::wait(fragmentShaderHandle), "shaders/quadFrag.spv");
+	AssetManager::unload(vertexShaderHandle);
+	AssetManager::unload(fragmentShaderHandle);
+	if(!vertexShaderModule || !fragmentShaderModule)
 		return;
 
-	//Define shader stages
+	//Define shader stages, the fragment shader takes the median of the channels of multi-channel sdf atlases
+	vk::Bool32 isMultiChannel = textureResources.format == vk::Format::eR8G8B8A8Unorm;
+	vk::SpecializationMapEntry specializationMapEntry(0, 0, sizeof(vk::Bool32));
+	vk::SpecializationInfo fragmentSpecializationInfo(1, &specializationMapEntry, sizeof(isMultiChannel), &isMultiChannel);
 	std::vector<vk::PipelineShaderStageCreateInfo> stageCreateInfos{{{}, vk::ShaderStageFlagBits::eVertex, vertexShaderModule.get(), "main"},
-																	{{}, vk::ShaderStageFlagBits::eFragment, fragmentShaderModule.get(), "main"}};
+																	{{}, vk::ShaderStageFlagBits::eFragment, fragmentShaderModule.get(), "main", &fragmentSpecializationInfo}};
 
 	//Define dynamic states
 	std::vector<vk::DynamicState> dynamicStates{vk::DynamicState::eViewport, vk::DynamicState::eScissor};
@@ -367,7 +468,7 @@ RenderEngine::RenderEngine()
 	vk::PipelineColorBlendStateCreateInfo colorBlendStateCreateInfo{{}, VK_FALSE, vk::LogicOp::eNoOp, colorBlendAttachmentState, {1.0f, 1.0f, 1.0f, 1.0f}};
 
 	//Create pipeline layout
-	vk::PushConstantRange pushConstantRange(vk::ShaderStageFlagBits::eVertex, 0, sizeof(QuadData));
+	vk::PushConstantRange pushConstantRange(vk::ShaderStageFlagBits::eVertex, 0, sizeof(PushConstantsBlock));
 	vk::PipelineLayoutCreateInfo layoutCreateInfo({}, descriptorSetLayout.get(), pushConstantRange);
 	if(checkVulkanErrorOccured(pipelineLayout, device->createPipelineLayoutUnique(layoutCreateInfo),
 							   "Created pipeline layout", "Failed to create pipeline layout"))
@@ -383,11 +484,42 @@ RenderEngine::RenderEngine()
 		return;
 
 	for(uint64_t i{0}; i < quadDataBuffers.size(); i++)
+	{
 		quadDataBuffers[i] = BufferResources<QuadData>(*this, 2048, vk::BufferUsageFlagBits::eShaderDeviceAddress);
+		quadGlyphBuffers[i] = BufferResources<uint32_t>(*this, 2048, vk::BufferUsageFlagBits::eShaderDeviceAddress);
+		worldQuadBuffers[i] = BufferResources<QuadData>(*this, World::maxResidentChunks * Chunk::cellCount, vk::BufferUsageFlagBits::eShaderDeviceAddress);
+		worldGlyphBuffers[i] = BufferResources<uint32_t>(*this, World::maxResidentChunks * Chunk::cellCount, vk::BufferUsageFlagBits::eShaderDeviceAddress);
+		fogBuffers[i] = BufferResources<uint64_t>(*this, FieldOfView::maskSize * FieldOfView::maskWords, vk::BufferUsageFlagBits::eShaderDeviceAddress);
+		//Mapped memory starts out undefined
+		fogPendingRows[i].fill(~uint64_t{});
+		projectileQuadBuffers[i] = BufferResources<QuadData>(*this, Projectiles::capacity, vk::BufferUsageFlagBits::eShaderDeviceAddress);
+		projectileGlyphBuffers[i] = BufferResources<uint32_t>(*this, Projectiles::capacity, vk::BufferUsageFlagBits::eShaderDeviceAddress);
+	}
 	if(hasError)
 		return;
+	//All projectiles look the same, only their quads are written per frame
+	for(auto& glyphBuffer : projectileGlyphBuffers)
+		std::fill_n(static_cast<uint32_t*>(glyphBuffer.data), Projectiles::capacity, uint32_t{'*'});
 	Logger::logInfo("Created quad data buffers");
 
+	//Glyph rects come from the packed atlas sidecar, or cover the grid cells without one, glyph cache cells follow them
+	auto glyphAtlas = AssetManager::wait(glyphAtlasHandle);
+	auto glyphRects = glyphAtlas->rects;
+	auto isPackedAtlas = glyphAtlas->isPacked;
+	AssetManager::unload(glyphAtlasHandle);
+	glyphCacheRectOffset = (uint32_t)glyphRects.size();
+	std::ranges::copy(GlyphCache::getSlotRects(), std::back_inserter(glyphRects));
+	glyphRectBuffer = BufferResources<GlyphRect>(*this, (uint32_t)glyphRects.size(), vk::BufferUsageFlagBits::eShaderDeviceAddress);
+	if(hasError)
+		return;
+	memcpy(glyphRectBuffer.data, glyphRects.data(), sizeof(GlyphRect) * glyphRects.size());
+	Logger::logInfo(std::format("Created glyph rect buffer for {} atlas", isPackedAtlas ? "packed" : "grid"));
+
+	for(auto& uploadBuffer : glyphUploadBuffers)
+		uploadBuffer = BufferResources<uint8_t>(*this, glyphUploadsPerFrame * GlyphCache::cellSize, vk::BufferUsageFlagBits::eTransferSrc);
+	if(hasError)
+		return;
+
 	//Allocate command buffers
 	vk::CommandBufferAllocateInfo bufferAllocateInfo{commandPool.get(), vk::CommandBufferLevel::ePrimary, maxFramesInFlight};
 	std::vector<vk::CommandBuffer> allocatedBuffers;
@@ -422,6 +554,26 @@ bool RenderEngine::drawFrame()
 	if(checkVulkanErrorOccured(device->waitForFences(inFlightFences[currentFrameIndex].get(), VK_TRUE, timeout), "", "Failed to wait for fence"))
 		return false;
 
+	if(timestampsWritten[currentFrameIndex])
+	{
+		timestampsWritten[currentFrameIndex] = false;
+		auto [queryResult, timestamps] = device->getQueryPoolResults<uint64_t>(timestampQueryPool.get(), currentFrameIndex * 2, 2, sizeof(uint64_t) * 2,
+																			   sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+		if(queryResult == vk::Result::eSuccess && swapchainResources.useOffscreenTarget)
+			updateRenderScale((timestamps[1] - timestamps[0]) * physicalDeviceInfo.properties.limits.timestampPeriod / 1.e6);
+	}
+
+	if(swapchainRecreationRequested)
+		return recreateSwapchain();
+
+	//Secondary command buffers of this frame are done, reset them all at once
+	for(auto& context : recordingContexts[currentFrameIndex])
+	{
+		if(checkVulkanErrorOccured(device->resetCommandPool(context.commandPool.get()), "", "Failed to reset recording command pool"))
+			return false;
+		context.usedCount = 0;
+	}
+
 	auto [result, imageIndex] = device->acquireNextImageKHR(swapchainResources.swapchain.get(), timeout, imageAvailableSemaphores[currentFrameIndex].get(), {});
 	if(result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR)
 		return recreateSwapchain();
@@ -434,12 +586,23 @@ bool RenderEngine::drawFrame()
 	if(checkVulkanErrorOccured(commandBuffers[currentFrameIndex].reset(), "", "Failed to reset command buffer"))
 		return false;
 
+	//Resolve glyphs before taking uploads so cache slots drawn this frame aren't evicted
+	memcpy(quadDataBuffers[currentFrameIndex].data, QuadPool::getData(), sizeof(QuadData) * QuadPool::getSize());
+	auto glyphIndices = static_cast<uint32_t*>(quadGlyphBuffers[currentFrameIndex].data);
+	auto glyphs = QuadPool::getGlyphData();
+	for(size_t i = 0; i < QuadPool::getSize(); i++)
+		glyphIndices[i] = getGlyphRectIndex(glyphs[i]);
+	writeWorldQuads();
+	writeProjectileQuads();
+	writeFogRows();
+	bool glyphsUploaded = stageGlyphUploads();
+
 	if(!recordCommandBuffer(commandBuffers[currentFrameIndex], imageIndex))
 		return false;
 
-	memcpy(quadDataBuffers[currentFrameIndex].data, QuadPool::getData(), sizeof(QuadData) * QuadPool::getSize());
+	timestampsWritten[currentFrameIndex] = static_cast<bool>(timestampQueryPool);
 
-	vk::PipelineStageFlags waitStage(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+	vk::PipelineStageFlags waitStage(swapchainResources.renderGraph.getFirstUseStage(swapchainResources.swapchainImageHandle));
 	vk::SubmitInfo submitInfo(imageAvailableSemaphores[currentFrameIndex].get(), waitStage, commandBuffers[currentFrameIndex], renderFinishedSemaphores[currentFrameIndex].get());
 	if(checkVulkanErrorOccured(graphicsQueue.submit(submitInfo, inFlightFences[currentFrameIndex].get()), "", "Failed to submit to graphics queue"))
 		return false;
@@ -452,6 +615,8 @@ bool RenderEngine::drawFrame()
 		return false;
 
 	currentFrameIndex = (currentFrameIndex + 1) % maxFramesInFlight;
+	//Quads waiting on uploaded glyphs show them from the next frame on
+	redrawRequested = glyphsUploaded;
 	if(oldSwapchainResources.swapchain)
 	{
 		if(oldRendersRemaining == 0)
@@ -477,43 +642,307 @@ bool RenderEngine::recreateSwapchain()
 	if(checkVulkanErrorOccured(physicalDeviceInfo.presentModes, physicalDevice.getSurfacePresentModesKHR(surface.get()), "", "Failed to get surface present modes"))
 		return false;
 
+	//Previous old swapchain may still be in use if recreated again quickly
+	if(oldSwapchainResources.swapchain && checkVulkanErrorOccured(device->waitIdle(), "", "Failed to wait for device idle"))
+		return false;
+
 	oldSwapchainResources = std::move(swapchainResources);
-	oldRendersRemaining = oldSwapchainResources.framebuffers.size();
+	oldRendersRemaining = oldSwapchainResources.images.size();
 	swapchainResources = SwapchainResources(*this);
+	swapchainRecreationRequested = false;
+	redrawRequested = true;
 	return !hasError;
 }
 
+void RenderEngine::setPresentMode(PresentMode newPresentMode)
+{
+	if(newPresentMode == presentMode)
+		return;
+
+	presentMode = newPresentMode;
+	swapchainRecreationRequested = true;
+}
+
+vk::Extent2D RenderEngine::getRenderExtent() const
+{
+	auto extent = swapchainResources.imageExtent;
+	if(!swapchainResources.useOffscreenTarget)
+		return extent;
+
+	return {std::max(1u, static_cast<uint32_t>(extent.width * renderScale)), std::max(1u, static_cast<uint32_t>(extent.height * renderScale))};
+}
+
+void RenderEngine::updateRenderScale(double gpuFrameTimeMs)
+{
+	//Smooth out per frame noise and give each scale time to settle before judging it
+	averageGpuFrameTime = averageGpuFrameTime == 0.0 ? gpuFrameTimeMs : averageGpuFrameTime * 0.9 + gpuFrameTimeMs * 0.1;
+	framesSinceScaleChange++;
+	if(framesSinceScaleChange < 30)
+		return;
+
+	auto targetFrameTime = Configuration::getDynamicResolutionTargetMs();
+	auto hysteresis = Configuration::getDynamicResolutionHysteresis();
+	if(averageGpuFrameTime <= targetFrameTime * (1.0 + hysteresis) && averageGpuFrameTime >= targetFrameTime * (1.0 - hysteresis))
+		return;
+	if(averageGpuFrameTime < targetFrameTime && renderScale == 1.0)
+		return;
+
+	//Fill cost is proportional to pixel count, so scale each axis by the square root, growing back slowly
+	auto newScale = renderScale * std::sqrt(targetFrameTime / averageGpuFrameTime);
+	newScale = std::clamp(std::min(newScale, renderScale + 0.05), Configuration::getDynamicResolutionMinScale(), 1.0);
+	if(newScale == renderScale)
+		return;
+
+	renderScale = newScale;
+	framesSinceScaleChange = 0;
+	redrawRequested = true;
+	Logger::logInfo(std::format("GPU frame time {:.2f} ms, render scale changed to {:.2f}", averageGpuFrameTime, renderScale));
+}
+
+uint32_t RenderEngine::getGlyphRectIndex(uint32_t glyph)
+{
+	if(!(glyph & GlyphCache::codepointFlag))
+		return glyph;
+
+	auto slot = GlyphCache::findGlyph(glyph & ~GlyphCache::codepointFlag);
+	return slot ? glyphCacheRectOffset + *slot : GlyphCache::placeholderGlyph;
+}
+
+void RenderEngine::writeWorldQuads()
+{
+	//Each frame has its own buffers, so a slot is rewritten once per frame in flight after its chunk changed
+	auto& slotRevisions = worldSlotRevisions[currentFrameIndex];
+	auto quads = static_cast<QuadData*>(worldQuadBuffers[currentFrameIndex].data);
+	auto glyphIndices = static_cast<uint32_t*>(worldGlyphBuffers[currentFrameIndex].data);
+	for(auto const& [key, chunk] : World::getResidentChunks())
+	{
+		if(slotRevisions[chunk->slot] == chunk->revision)
+			continue;
+
+		auto slotOffset = chunk->slot * Chunk::cellCount;
+		uint32_t quadCount{};
+		for(int32_t y = 0; y < Chunk::size; y++)
+		{
+			for(int32_t x = 0; x < Chunk::size; x++)
+			{
+				if(!chunk->getIsWall(x, y))
+					continue;
+
+				glm::vec2 pos{(chunk->x * Chunk::size + x + 0.5f) * World::cellWidth, (chunk->y * Chunk::size + y + 0.5f) * World::cellHeight};
+				quads[slotOffset + quadCount] = QuadData{pos, {World::cellWidth / 2.0f, World::cellHeight / 2.0f}};
+				glyphIndices[slotOffset + quadCount] = '#';
+				quadCount++;
+			}
+		}
+
+		worldSlotQuadCounts[currentFrameIndex][chunk->slot] = quadCount;
+		slotRevisions[chunk->slot] = chunk->revision;
+	}
+}
+
+void RenderEngine::writeProjectileQuads()
+{
+	auto quads = static_cast<QuadData*>(projectileQuadBuffers[currentFrameIndex].data);
+	auto const& positionsX = Projectiles::getPositionsX();
+	auto const& positionsY = Projectiles::getPositionsY();
+	for(uint32_t i = 0; i < Projectiles::getCount(); i++)
+		quads[i] = QuadData{{positionsX[i], positionsY[i]}, {Projectiles::halfWidth, Projectiles::halfHeight}};
+	projectileQuadCounts[currentFrameIndex] = Projectiles::getCount();
+}
+
+void RenderEngine::writeFogRows()
+{
+	auto changedRows = FieldOfView::takeChangedRows();
+	for(auto& pendingRows : fogPendingRows)
+	{
+		for(size_t i = 0; i < pendingRows.size(); i++)
+			pendingRows[i] |= changedRows[i];
+	}
+
+	auto& pendingRows = fogPendingRows[currentFrameIndex];
+	auto const& maskRows = FieldOfView::getMaskRows();
+	auto fogRows = static_cast<uint64_t*>(fogBuffers[currentFrameIndex].data);
+	for(int32_t row = 0; row < FieldOfView::maskSize; row++)
+	{
+		if(pendingRows[row / 64] >> (row % 64) & 1)
+			memcpy(fogRows + row * FieldOfView::maskWords, maskRows.data() + row * FieldOfView::maskWords, sizeof(uint64_t) * FieldOfView::maskWords);
+	}
+	pendingRows = {};
+}
+
+bool RenderEngine::stageGlyphUploads()
+{
+	//Upload buffer of this frame is free again once its fence signaled
+	glyphUploadCopies.clear();
+	auto uploads = GlyphCache::takeUploads(glyphUploadsPerFrame);
+	for(size_t i = 0; i < uploads.size(); i++)
+	{
+		auto const& upload = uploads[i];
+		vk::DeviceSize bufferOffset = i * GlyphCache::cellSize;
+		memcpy(static_cast<uint8_t*>(glyphUploadBuffers[currentFrameIndex].data) + bufferOffset, upload.pixels.data(), GlyphCache::cellSize);
+
+		vk::ImageSubresourceLayers subresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1);
+		vk::Offset3D offset{(int32_t)GlyphCache::getSlotX(upload.slot), (int32_t)GlyphCache::getSlotY(upload.slot), 0};
+		glyphUploadCopies.emplace_back(bufferOffset, 0, 0, subresourceLayers, offset, vk::Extent3D{GlyphCache::cellWidth, GlyphCache::cellHeight, 1});
+	}
+
+	return !uploads.empty();
+}
+
+vk::PresentModeKHR RenderEngine::getVulkanPresentMode(PresentMode mode)
+{
+	switch(mode)
+	{
+		case PresentMode::fifoRelaxed: return vk::PresentModeKHR::eFifoRelaxed;
+		case PresentMode::mailbox: return vk::PresentModeKHR::eMailbox;
+		case PresentMode::immediate: return vk::PresentModeKHR::eImmediate;
+		default: return vk::PresentModeKHR::eFifo;
+	}
+}
+
 bool RenderEngine::recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t imageIndex) const
 {
 	vk::CommandBufferBeginInfo beginInfo;
 	if(checkVulkanErrorOccured(commandBuffer.begin(beginInfo), "", "Failed to begin command buffer"))
 		return false;
 
-	vk::Rect2D renderArea({0, 0}, swapchainResources.imageExtent);
+	if(timestampQueryPool)
+	{
+		commandBuffer.resetQueryPool(timestampQueryPool.get(), currentFrameIndex * 2, 2);
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, timestampQueryPool.get(), currentFrameIndex * 2);
+	}
+
+	recordGlyphUploads(commandBuffer);
+	swapchainResources.renderGraph.execute(commandBuffer, imageIndex);
+
+	if(checkVulkanErrorOccured(commandBuffer.end(), "", "Failed to end command buffer"))
+		return false;
+
+	return !hasError;
+}
+
+void RenderEngine::recordGlyphUploads(vk::CommandBuffer commandBuffer) const
+{
+	if(glyphUploadCopies.empty())
+		return;
+
+	//Earlier frames may still sample slots being overwritten
+	vk::ImageSubresourceRange range(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+	vk::ImageMemoryBarrier transferBarrier(vk::AccessFlagBits::eNone, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eTransferDstOptimal,
+										   VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, glyphCacheTexture.image.get(), range);
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, transferBarrier);
+
+	commandBuffer.copyBufferToImage(glyphUploadBuffers[currentFrameIndex].buffer.get(), glyphCacheTexture.image.get(), vk::ImageLayout::eTransferDstOptimal, glyphUploadCopies);
+
+	vk::ImageMemoryBarrier sampleBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+										 VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, glyphCacheTexture.image.get(), range);
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, sampleBarrier);
+}
+
+void RenderEngine::recordScenePass(vk::CommandBuffer commandBuffer, uint32_t imageIndex) const
+{
+	auto renderExtent = getRenderExtent();
+	auto framebuffer = swapchainResources.framebuffers[swapchainResources.useOffscreenTarget ? 0 : imageIndex].get();
+
+	//World goes first so entities are drawn over it, projectiles over both
+	drawBatches.clear();
+	for(auto const& [key, chunk] : World::getResidentChunks())
+	{
+		vk::DeviceAddress slotOffset{chunk->slot * Chunk::cellCount};
+		addDrawBatches(worldQuadBuffers[currentFrameIndex].bufferAddress + slotOffset * sizeof(QuadData), worldGlyphBuffers[currentFrameIndex].bufferAddress + slotOffset * sizeof(uint32_t),
+					   worldSlotQuadCounts[currentFrameIndex][chunk->slot]);
+	}
+	addDrawBatches(quadDataBuffers[currentFrameIndex].bufferAddress, quadGlyphBuffers[currentFrameIndex].bufferAddress, QuadPool::getSize());
+	addDrawBatches(projectileQuadBuffers[currentFrameIndex].bufferAddress, projectileGlyphBuffers[currentFrameIndex].bufferAddress, projectileQuadCounts[currentFrameIndex]);
+
+	//Record batches in parallel, each thread using its own command pool
+	std::atomic<bool> recordingFailed{};
+	drawBatchCommandBuffers.resize(drawBatches.size());
+	JobSystem::parallelFor(drawBatches.size(), [&](size_t batchIndex)
+	{
+		auto& context = recordingContexts[currentFrameIndex][JobSystem::getThreadIndex()];
+		if(context.usedCount == context.commandBuffers.size())
+		{
+			vk::CommandBufferAllocateInfo allocateInfo(context.commandPool.get(), vk::CommandBufferLevel::eSecondary, 1);
+			auto [result, allocatedBuffers] = device->allocateCommandBuffers(allocateInfo);
+			if(result != vk::Result::eSuccess)
+			{
+				recordingFailed = true;
+				return;
+			}
+			context.commandBuffers.emplace_back(allocatedBuffers[0]);
+		}
+
+		auto secondaryCommandBuffer = context.commandBuffers[context.usedCount++];
+		if(!recordDrawBatch(secondaryCommandBuffer, drawBatches[batchIndex], framebuffer, renderExtent))
+			recordingFailed = true;
+		drawBatchCommandBuffers[batchIndex] = secondaryCommandBuffer;
+	});
+	if(recordingFailed)
+	{
+		hasError = true;
+		Logger::logError("Failed to record secondary command buffer");
+		return;
+	}
+
+	vk::Rect2D renderArea({0, 0}, renderExtent);
 	vk::ClearValue clearValue(vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f));
-	vk::RenderPassBeginInfo renderPassBeginInfo(swapchainResources.renderPass.get(), swapchainResources.framebuffers[imageIndex].get(), renderArea, clearValue);
-	commandBuffer.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
+	vk::RenderPassBeginInfo renderPassBeginInfo(swapchainResources.renderPass.get(), framebuffer, renderArea, clearValue);
+	commandBuffer.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eSecondaryCommandBuffers);
+
+	if(!drawBatchCommandBuffers.empty())
+		commandBuffer.executeCommands(drawBatchCommandBuffers);
+
+	commandBuffer.endRenderPass();
+
+	//Ends before the upscale blit, which waits for the swapchain image and would count vsync as GPU time
+	if(timestampQueryPool)
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, timestampQueryPool.get(), currentFrameIndex * 2 + 1);
+}
+
+bool RenderEngine::recordDrawBatch(vk::CommandBuffer commandBuffer, DrawBatch const& batch, vk::Framebuffer framebuffer, vk::Extent2D renderExtent) const
+{
+	vk::CommandBufferInheritanceInfo inheritanceInfo(swapchainResources.renderPass.get(), 0, framebuffer);
+	vk::CommandBufferBeginInfo beginInfo(vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eOneTimeSubmit, &inheritanceInfo);
+	if(commandBuffer.begin(beginInfo) != vk::Result::eSuccess)
+		return false;
 
 	commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, graphicsPipeline.get());
 
-	vk::Viewport viewport(0.0f, 0.0f, swapchainResources.imageExtent.width, swapchainResources.imageExtent.height, 0.0f, 1.0f);
+	vk::Viewport viewport(0.0f, 0.0f, renderExtent.width, renderExtent.height, 0.0f, 1.0f);
 	commandBuffer.setViewport(0, viewport);
 
-	vk::Rect2D scissor({0, 0}, swapchainResources.imageExtent);
+	vk::Rect2D scissor({0, 0}, renderExtent);
 	commandBuffer.setScissor(0, scissor);
 
-	PushConstantsBlock pushConstants{quadDataBuffers[currentFrameIndex].bufferAddress};
+	auto [fogOriginX, fogOriginY] = FieldOfView::getMaskOrigin();
+	PushConstantsBlock pushConstants{batch.quadReference, batch.glyphIndexReference, glyphRectBuffer.bufferAddress, fogBuffers[currentFrameIndex].bufferAddress, fogOriginX, fogOriginY};
 	commandBuffer.pushConstants<PushConstantsBlock>(pipelineLayout.get(), vk::ShaderStageFlagBits::eVertex, 0u, pushConstants);
 
 	commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout.get(), 0, descriptorSets[currentFrameIndex], {});
-	commandBuffer.draw(4, QuadPool::getSize(), 0, 0);
+	commandBuffer.draw(4, batch.instanceCount, 0, batch.firstInstance);
 
-	commandBuffer.endRenderPass();
+	return commandBuffer.end() == vk::Result::eSuccess;
+}
 
-	if(checkVulkanErrorOccured(commandBuffer.end(), "", "Failed to end command buffer"))
-		return false;
+void RenderEngine::addDrawBatches(vk::DeviceAddress quadReference, vk::DeviceAddress glyphIndexReference, uint32_t instanceCount) const
+{
+	for(uint32_t firstInstance = 0; firstInstance < instanceCount; firstInstance += quadsPerDrawBatch)
+		drawBatches.push_back(DrawBatch{quadReference, glyphIndexReference, firstInstance, std::min(quadsPerDrawBatch, instanceCount - firstInstance)});
+}
 
-	return true;
+void RenderEngine::recordUpscalePass(vk::CommandBuffer commandBuffer, uint32_t imageIndex) const
+{
+	auto const& graph = swapchainResources.renderGraph;
+	auto renderExtent = getRenderExtent();
+	auto const& imageExtent = swapchainResources.imageExtent;
+
+	vk::ImageSubresourceLayers subresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1);
+	std::array<vk::Offset3D, 2> sourceOffsets{vk::Offset3D{0, 0, 0}, vk::Offset3D{(int32_t)renderExtent.width, (int32_t)renderExtent.height, 1}};
+	std::array<vk::Offset3D, 2> destinationOffsets{vk::Offset3D{0, 0, 0}, vk::Offset3D{(int32_t)imageExtent.width, (int32_t)imageExtent.height, 1}};
+	vk::ImageBlit imageBlit(subresourceLayers, sourceOffsets, subresourceLayers, destinationOffsets);
+	commandBuffer.blitImage(graph.getImage(swapchainResources.sceneColorHandle, imageIndex), vk::ImageLayout::eTransferSrcOptimal,
+							graph.getImage(swapchainResources.swapchainImageHandle, imageIndex), vk::ImageLayout::eTransferDstOptimal, imageBlit, vk::Filter::eLinear);
 }
 
 template<class Value, class Result>
@@ -685,24 +1114,19 @@ int32_t RenderEngine::getMemoryType(vk::MemoryRequirements const& requirements,
 	return selectedMemoryType;
 }
 
-vk::UniqueShaderModule RenderEngine::createShaderModule(std::string_view shaderFileName) const
+vk::UniqueShaderModule RenderEngine::createShaderModule(Asset const* shader, std::string_view shaderFileName) const
 {
 	vk::UniqueShaderModule result;
-	std::ifstream shaderFile(shaderFileName.data(), std::ios::ate | std::ios::binary | std::ios::in);
 
-	if(!shaderFile)
+	if(!shader)
 	{
 		hasError = true;
 		Logger::logError(std::format("Failed to open shader file {}", shaderFileName.data()));
 		return result;
 	}
 
-	size_t fileSize{static_cast<size_t>(std::streamoff(shaderFile.tellg()))};
-	std::vector<uint32_t> fileBuffer(fileSize / 4 + 1);
-	shaderFile.seekg(0);
-	shaderFile.read(reinterpret_cast<char*>(fileBuffer.data()), fileSize);
-
-	vk::ShaderModuleCreateInfo createInfo({}, fileSize, fileBuffer.data());
+	//Packed entries and mapped files are both aligned for SPIR-V words
+	vk::ShaderModuleCreateInfo createInfo({}, shader->data.size(), reinterpret_cast<uint32_t const*>(shader->data.data()));
 	if(checkVulkanErrorOccured(result, device->createShaderModuleUnique(createInfo), "Created shader module "s + shaderFileName.data(), "Failed to create shader module "s + shaderFileName.data()))
 		return result;
 
@@ -756,16 +1180,42 @@ RenderEngine::BufferResources<T>::BufferResources(RenderEngine const& engine, ui
 		return;
 }
 
-RenderEngine::TextureResources::TextureResources(RenderEngine const& engine, std::string_view filePath)
+RenderEngine::TextureResources::TextureResources(RenderEngine const& engine, ImageLoader const& tileImage, std::string_view name, vk::CommandBuffer uploadCommandBuffer)
 {
-	auto tileImage = ImageLoader(filePath);
-	vk::DeviceSize imageSize{(size_t)tileImage.width * tileImage.height * tileImage.channels};
-	BufferResources<uint8_t> stagingBufferResources(engine, imageSize, vk::BufferUsageFlagBits::eTransferSrc);
+	auto imageFormat = vk::Format::eR8Unorm;
+	if(tileImage.format == ImageFormat::bc4)
+		imageFormat = vk::Format::eBc4UnormBlock;
+	else if(tileImage.format == ImageFormat::rgba8)
+		imageFormat = vk::Format::eR8G8B8A8Unorm;
+	format = imageFormat;
+	auto requiredFeatures = vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eSampledImageFilterLinear | vk::FormatFeatureFlagBits::eTransferDst;
+	if((engine.physicalDevice.getFormatProperties(imageFormat).optimalTilingFeatures & requiredFeatures) != requiredFeatures)
+	{
+		engine.hasError = true;
+		Logger::logError(std::format("Texture format {} not supported", vk::to_string(imageFormat)));
+		return;
+	}
+	auto levelCount = (uint32_t)tileImage.levels.size();
+
+	//Pack mip levels into the staging buffer as they are, offsets aligned for block compressed copies
+	std::vector<vk::BufferImageCopy> imageCopies;
+	vk::DeviceSize imageSize{};
+	for(uint32_t i = 0; i < levelCount; i++)
+	{
+		auto const& level = tileImage.levels[i];
+		imageSize = (imageSize + 15) / 16 * 16;
+		vk::ImageSubresourceLayers imageSubresourceLayers(vk::ImageAspectFlagBits::eColor, i, 0, 1);
+		imageCopies.emplace_back(imageSize, 0, 0, imageSubresourceLayers, vk::Offset3D{}, vk::Extent3D{level.width, level.height, 1});
+		imageSize += level.size;
+	}
+	stagingBuffer = BufferResources<uint8_t>(engine, imageSize, vk::BufferUsageFlagBits::eTransferSrc);
 	if(engine.hasError)
 		return;
-	memcpy(stagingBufferResources.data, tileImage.data, (size_t)imageSize);
-	vk::ImageCreateInfo imageCreateInfo({}, vk::ImageType::e2D, vk::Format::eR8Unorm, vk::Extent3D{(uint32_t)tileImage.width, (uint32_t)tileImage.height, 1u},
-										1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+	for(uint32_t i = 0; i < levelCount; i++)
+		memcpy((uint8_t*)stagingBuffer.data + imageCopies[i].bufferOffset, tileImage.data + tileImage.levels[i].offset, tileImage.levels[i].size);
+
+	vk::ImageCreateInfo imageCreateInfo({}, vk::ImageType::e2D, imageFormat, vk::Extent3D{(uint32_t)tileImage.width, (uint32_t)tileImage.height, 1u},
+										levelCount, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
 										vk::SharingMode::eExclusive, engine.physicalDeviceInfo.graphicsIndex, vk::ImageLayout::eUndefined);
 	if(engine.checkVulkanErrorOccured(image, engine.device->createImageUnique(imageCreateInfo), "", "Failed to create texture image"))
 		return;
@@ -778,43 +1228,72 @@ RenderEngine::TextureResources::TextureResources(RenderEngine const& engine, std
 	if(engine.checkVulkanErrorOccured(engine.device->bindImageMemory(image.get(), imageMemory.get(), 0), "", "Failed to bind tile texture memory"))
 		return;
 
-	{
-		SingleUseCommandBuffer transitionCommandBuffer(engine, engine.graphicsQueue);
+	vk::ImageSubresourceRange subresourceRange(vk::ImageAspectFlagBits::eColor, 0, levelCount, 0, 1);
+	vk::ImageMemoryBarrier copyBarrier(vk::AccessFlagBits::eNone, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+									   VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image.get(), subresourceRange);
+	uploadCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, copyBarrier);
 
-		vk::ImageSubresourceRange range(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
-		vk::ImageMemoryBarrier memoryBarrier(vk::AccessFlagBits::eNone, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
-											 VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image.get(), range);
-		transitionCommandBuffer->pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, memoryBarrier);
-	}
+	uploadCommandBuffer.copyBufferToImage(stagingBuffer.buffer.get(), image.get(), vk::ImageLayout::eTransferDstOptimal, imageCopies);
 
-	{
-		SingleUseCommandBuffer copyCommandBuffer(engine, engine.graphicsQueue);
+	vk::ImageMemoryBarrier sampleBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+										 VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image.get(), subresourceRange);
+	uploadCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, sampleBarrier);
 
-		vk::ImageSubresourceLayers imageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1);
-		vk::BufferImageCopy imageCopy(0, 0, 0, imageSubresourceLayers, {}, {(uint32_t)tileImage.width, (uint32_t)tileImage.height, 1});
-		copyCommandBuffer->copyBufferToImage(stagingBufferResources.buffer.get(), image.get(), vk::ImageLayout::eTransferDstOptimal, imageCopy);
-	}
+	vk::ImageViewCreateInfo viewCreateInfo({}, image.get(), vk::ImageViewType::e2D, imageFormat, {}, subresourceRange);
+	if(engine.checkVulkanErrorOccured(imageView, engine.device->createImageViewUnique(viewCreateInfo), "", "Failed to create texture image view"))
+		return;
 
-	{
-		SingleUseCommandBuffer transitionCommandBuffer(engine, engine.graphicsQueue);
+	vk::SamplerCreateInfo samplerCreateInfo({}, vk::Filter::eLinear, vk::Filter::eLinear, vk::SamplerMipmapMode::eLinear,
+											vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat,
+											0.0f, VK_TRUE, engine.physicalDeviceInfo.properties.limits.maxSamplerAnisotropy, VK_FALSE, vk::CompareOp::eAlways,
+											0.0f, (float)levelCount, vk::BorderColor::eIntOpaqueBlack, VK_FALSE);
+	if(engine.checkVulkanErrorOccured(sampler, engine.device->createSamplerUnique(samplerCreateInfo), "", "Failed to create texture sampler"))
+		return;
 
-		vk::ImageSubresourceRange range(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
-		vk::ImageMemoryBarrier memoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
-											 VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image.get(), range);
-		transitionCommandBuffer->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, memoryBarrier);
-	}
+	//Decoding happens on cold starts only, warm starts map the raw cache
+	auto source = tileImage.isFromCache ? "raw cache" : name.ends_with(".ktx2") ? "mapped file" : "decoded";
+	Logger::logInfo(std::format("Created texture {} with format {} and {} mip levels from {}", name, vk::to_string(imageFormat), levelCount, source));
+}
+
+RenderEngine::TextureResources::TextureResources(RenderEngine const& engine, uint32_t width, uint32_t height, vk::CommandBuffer uploadCommandBuffer)
+{
+	format = vk::Format::eR8Unorm;
+	vk::ImageCreateInfo imageCreateInfo({}, vk::ImageType::e2D, vk::Format::eR8Unorm, vk::Extent3D{width, height, 1u},
+										1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+										vk::SharingMode::eExclusive, engine.physicalDeviceInfo.graphicsIndex, vk::ImageLayout::eUndefined);
+	if(engine.checkVulkanErrorOccured(image, engine.device->createImageUnique(imageCreateInfo), "", "Failed to create texture image"))
+		return;
+
+	auto memoryRequirements = engine.device->getImageMemoryRequirements(image.get());
+	vk::MemoryAllocateInfo imageMemoryAllocateInfo(memoryRequirements.size, engine.getMemoryType(memoryRequirements, vk::MemoryPropertyFlagBits::eDeviceLocal));
+	if(engine.checkVulkanErrorOccured(imageMemory, engine.device->allocateMemoryUnique(imageMemoryAllocateInfo), "", "Failed to allocate texture memory"))
+		return;
+
+	if(engine.checkVulkanErrorOccured(engine.device->bindImageMemory(image.get(), imageMemory.get(), 0), "", "Failed to bind texture memory"))
+		return;
 
 	vk::ImageSubresourceRange subresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+	vk::ImageMemoryBarrier clearBarrier(vk::AccessFlagBits::eNone, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+										VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image.get(), subresourceRange);
+	uploadCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, clearBarrier);
+
+	uploadCommandBuffer.clearColorImage(image.get(), vk::ImageLayout::eTransferDstOptimal, vk::ClearColorValue(0.0f, 0.0f, 0.0f, 0.0f), subresourceRange);
+
+	vk::ImageMemoryBarrier sampleBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+										 VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image.get(), subresourceRange);
+	uploadCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, sampleBarrier);
+
 	vk::ImageViewCreateInfo viewCreateInfo({}, image.get(), vk::ImageViewType::e2D, vk::Format::eR8Unorm, {}, subresourceRange);
 	if(engine.checkVulkanErrorOccured(imageView, engine.device->createImageViewUnique(viewCreateInfo), "", "Failed to create texture image view"))
 		return;
 
-	vk::SamplerCreateInfo samplerCreateInfo({}, vk::Filter::eLinear, vk::Filter::eLinear, vk::SamplerMipmapMode::eLinear,
-											vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat,
-											0.0f, VK_TRUE, engine.physicalDeviceInfo.properties.limits.maxSamplerAnisotropy, VK_FALSE, vk::CompareOp::eAlways,
-											0.0f, 0.0f, vk::BorderColor::eIntOpaqueBlack, VK_FALSE);
+	vk::SamplerCreateInfo samplerCreateInfo({}, vk::Filter::eLinear, vk::Filter::eLinear, vk::SamplerMipmapMode::eNearest,
+											vk::SamplerAddressMode::eClampToEdge, vk::SamplerAddressMode::eClampToEdge, vk::SamplerAddressMode::eClampToEdge,
+											0.0f, VK_FALSE, 1.0f, VK_FALSE, vk::CompareOp::eAlways, 0.0f, 0.0f, vk::BorderColor::eIntOpaqueBlack, VK_FALSE);
 	if(engine.checkVulkanErrorOccured(sampler, engine.device->createSamplerUnique(samplerCreateInfo), "", "Failed to create texture sampler"))
 		return;
+
+	Logger::logInfo(std::format("Created empty {}x{} texture", width, height));
 }
 
 RenderEngine::SingleUseCommandBuffer::SingleUseCommandBuffer(RenderEngine const& engine, vk::Queue submitQueue):engine(engine), submitQueue(submitQueue)
@@ -12,6 +12,10 @@ export import RenderWindow;
 export import ObjectPools;
 export import Configuration;
 export import Logger;
+export import GlyphAtlas;
+export import GlyphCache;
+export import FieldOfView;
+import AssetManager;
 
 export class RenderEngine
 {
@@ -26,6 +30,107 @@ export class RenderEngine
 		vk::PhysicalDeviceMemoryProperties memoryProperties;
 	};
 
+	//Orders frame passes, derives barriers between them and aliases memory of transient images
+	class RenderGraph
+	{
+	public:
+		enum class ResourceUsage
+		{
+			colorAttachment,
+			transferSource,
+			transferDestination,
+			sampled,
+			present
+		};
+
+		using ResourceHandle = uint32_t;
+		using RecordFunction = std::function<void(vk::CommandBuffer commandBuffer, uint32_t imageIndex)>;
+
+		struct ResourceAccess
+		{
+			ResourceHandle resource{};
+			ResourceUsage usage{};
+		};
+
+		//Images owned elsewhere, one per swapchain image index, contents undefined at the start of the frame
+		ResourceHandle importImage(std::string_view name, std::vector<vk::Image> images, ResourceUsage finalUsage);
+		//Images owned by the graph that live for part of a frame
+		ResourceHandle createTransientImage(std::string_view name, vk::Format format, vk::Extent2D extent);
+
+		void addPass(std::string_view name, std::vector<ResourceAccess> reads, std::vector<ResourceAccess> writes, RecordFunction record);
+
+		bool compile(RenderEngine const& engine);
+		void execute(vk::CommandBuffer commandBuffer, uint32_t imageIndex) const;
+
+		vk::Image getImage(ResourceHandle handle, uint32_t imageIndex) const;
+		vk::ImageView getImageView(ResourceHandle handle) const { return resources[handle].imageView.get(); }
+		//Stage that has to wait for an imported image to become available
+		vk::PipelineStageFlags getFirstUseStage(ResourceHandle handle) const { return resources[handle].firstUseStage; }
+
+	private:
+		struct UsageState
+		{
+			vk::ImageLayout layout{};
+			vk::PipelineStageFlags stages;
+			vk::AccessFlags accesses;
+			bool isWrite{};
+		};
+
+		struct Resource
+		{
+			std::string name;
+			bool isImported{};
+			std::vector<vk::Image> importedImages;
+			ResourceUsage finalUsage{};
+
+			vk::Format format{};
+			vk::Extent2D extent{};
+			vk::ImageUsageFlags usageFlags;
+			vk::UniqueImage image;
+			vk::UniqueImageView imageView;
+
+			std::optional<uint32_t> firstPass, lastPass;
+			vk::PipelineStageFlags firstUseStage;
+			//Last use of the image previously occupying the same memory
+			UsageState aliasedState;
+		};
+
+		struct Barrier
+		{
+			ResourceHandle resource{};
+			vk::AccessFlags sourceAccesses, destinationAccesses;
+			vk::ImageLayout oldLayout{}, newLayout{};
+		};
+
+		struct BarrierBatch
+		{
+			std::vector<Barrier> barriers;
+			vk::PipelineStageFlags sourceStages, destinationStages;
+		};
+
+		struct Pass
+		{
+			std::string name;
+			std::vector<ResourceAccess> reads, writes;
+			RecordFunction record;
+			bool isCulled{};
+			BarrierBatch barriers;
+		};
+
+		static UsageState getUsageState(ResourceUsage usage);
+		static vk::ImageUsageFlags getImageUsage(ResourceUsage usage);
+
+		void cullPasses();
+		bool createTransientImages(RenderEngine const& engine);
+		std::vector<UsageState> deriveBarriers();
+		void recordBarriers(vk::CommandBuffer commandBuffer, BarrierBatch const& batch, uint32_t imageIndex) const;
+
+		std::vector<Resource> resources;
+		std::vector<Pass> passes;
+		std::vector<vk::UniqueDeviceMemory> transientMemories;
+		BarrierBatch finalBarriers;
+	};
+
 	class SwapchainResources
 	{
 	public:
@@ -39,6 +144,13 @@ export class RenderEngine
 		std::vector<vk::UniqueImageView> imageViews;
 		vk::UniqueRenderPass renderPass;
 		std::vector<vk::UniqueFramebuffer> framebuffers;
+
+		//Full size offscreen target, only the scaled render area is drawn and blitted to the swapchain
+		bool useOffscreenTarget{};
+
+		RenderGraph renderGraph;
+		RenderGraph::ResourceHandle swapchainImageHandle{};
+		RenderGraph::ResourceHandle sceneColorHandle{};
 	};
 
 	template<class T>
@@ -57,9 +169,14 @@ export class RenderEngine
 	class TextureResources
 	{
 	public:
+		//Uploads are recorded into a shared command buffer, staging memory is kept until it's submitted
 		TextureResources() = default;
-		TextureResources(RenderEngine const& engine, std::string_view filePath);
+		TextureResources(RenderEngine const& engine, ImageLoader const& tileImage, std::string_view name, vk::CommandBuffer uploadCommandBuffer);
+		//Single channel texture cleared to zero, filled while rendering
+		TextureResources(RenderEngine const& engine, uint32_t width, uint32_t height, vk::CommandBuffer uploadCommandBuffer);
 
+		BufferResources<uint8_t> stagingBuffer;
+		vk::Format format{};
 		vk::UniqueImage image;
 		vk::UniqueDeviceMemory imageMemory;
 		vk::UniqueImageView imageView;
@@ -82,9 +199,31 @@ export class RenderEngine
 		vk::Queue submitQueue;
 	};
 
+	//Must match PushConstants in quad.vert, four buffer references then the ivec2 fog origin
 	struct PushConstantsBlock
 	{
 		vk::DeviceAddress quadReference;
+		vk::DeviceAddress glyphIndexReference;
+		vk::DeviceAddress glyphRectReference;
+		vk::DeviceAddress fogReference;
+		std::int32_t fogOriginX, fogOriginY;
+	};
+	static_assert(sizeof(PushConstantsBlock) == 4 * sizeof(vk::DeviceAddress) + 2 * sizeof(std::int32_t));
+
+	//Range of instances from one quad buffer, recorded into its own secondary command buffer
+	struct DrawBatch
+	{
+		vk::DeviceAddress quadReference;
+		vk::DeviceAddress glyphIndexReference;
+		uint32_t firstInstance{}, instanceCount{};
+	};
+
+	//Command pool used by one thread for one frame in flight, reset as a whole
+	struct RecordingContext
+	{
+		vk::UniqueCommandPool commandPool;
+		std::vector<vk::CommandBuffer> commandBuffers;
+		size_t usedCount{};
 	};
 
 public:
@@ -93,12 +232,36 @@ public:
 
 	bool drawFrame();
 
+	//Takes effect on the next frame by recreating the swapchain
+	void setPresentMode(PresentMode newPresentMode);
+
+	//Forces the next frame to be drawn even if no quads changed
+	void requestRedraw() { redrawRequested = true; }
+
 	auto getHasError() const { return hasError; }
+	auto getPresentMode() const { return presentMode; }
+	auto getRedrawRequested() const { return redrawRequested || GlyphCache::getHasFinishedGlyphs(); }
 
 private:
 	bool recreateSwapchain();
 
+	static vk::PresentModeKHR getVulkanPresentMode(PresentMode mode);
+
+	vk::Extent2D getRenderExtent() const;
+	void updateRenderScale(double gpuFrameTimeMs);
+
+	uint32_t getGlyphRectIndex(uint32_t glyph);
+	bool stageGlyphUploads();
+	void writeWorldQuads();
+	void writeProjectileQuads();
+	void writeFogRows();
+
 	bool recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t imageIndex) const;
+	void recordGlyphUploads(vk::CommandBuffer commandBuffer) const;
+	void recordScenePass(vk::CommandBuffer commandBuffer, uint32_t imageIndex) const;
+	bool recordDrawBatch(vk::CommandBuffer commandBuffer, DrawBatch const& batch, vk::Framebuffer framebuffer, vk::Extent2D renderExtent) const;
+	void addDrawBatches(vk::DeviceAddress quadReference, vk::DeviceAddress glyphIndexReference, uint32_t instanceCount) const;
+	void recordUpscalePass(vk::CommandBuffer commandBuffer, uint32_t imageIndex) const;
 
 	template<class Value, class Result>
 	bool checkVulkanErrorOccured(Value& value, Result result, std::string_view successMessage, std::string_view errorMessage) const;
@@ -108,7 +271,7 @@ private:
 
 	int32_t getMemoryType(vk::MemoryRequirements const& requirements, vk::MemoryPropertyFlags properties) const;
 
-	vk::UniqueShaderModule createShaderModule(std::string_view shaderFileName) const;
+	vk::UniqueShaderModule createShaderModule(Asset const* shader, std::string_view shaderFileName) const;
 
 	static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
 														VkDebugUtilsMessageTypeFlagsEXT messageType,
@@ -118,6 +281,8 @@ private:
 	mutable bool hasError{};
 
 	static constexpr uint32_t maxFramesInFlight{2};
+	static constexpr uint32_t quadsPerDrawBatch{256};
+	static constexpr uint32_t glyphUploadsPerFrame{32};
 
 	RenderWindow window;
 	vk::UniqueInstance instance;
@@ -131,13 +296,40 @@ private:
 	SwapchainResources swapchainResources;
 	vk::UniqueCommandPool commandPool;
 	TextureResources textureResources;
+	TextureResources glyphCacheTexture;
 	vk::UniqueDescriptorSetLayout descriptorSetLayout;
 	vk::UniqueDescriptorPool descriptorPool;
 	std::array<vk::DescriptorSet, maxFramesInFlight> descriptorSets;
 	vk::UniquePipelineLayout pipelineLayout;
 	vk::UniquePipeline graphicsPipeline;
 	std::array<BufferResources<QuadData>, maxFramesInFlight> quadDataBuffers;
+	std::array<BufferResources<uint32_t>, maxFramesInFlight> quadGlyphBuffers;
+	//Wall quads of resident chunks, one fixed range of Chunk::cellCount quads per chunk slot
+	std::array<BufferResources<QuadData>, maxFramesInFlight> worldQuadBuffers;
+	std::array<BufferResources<uint32_t>, maxFramesInFlight> worldGlyphBuffers;
+	//Chunk revision each slot of a frame's buffers was last written with, and its quad count
+	std::array<std::array<uint64_t, World::maxResidentChunks>, maxFramesInFlight> worldSlotRevisions{};
+	std::array<std::array<uint32_t, World::maxResidentChunks>, maxFramesInFlight> worldSlotQuadCounts{};
+	//Field of view mask read by the vertex shader, rows that changed since a frame's copy was written are pending for it
+	std::array<BufferResources<uint64_t>, maxFramesInFlight> fogBuffers;
+	std::array<std::array<uint64_t, FieldOfView::maskWords>, maxFramesInFlight> fogPendingRows;
+	//Live projectiles packed from the front, the glyph buffers are filled once
+	std::array<BufferResources<QuadData>, maxFramesInFlight> projectileQuadBuffers;
+	std::array<BufferResources<uint32_t>, maxFramesInFlight> projectileGlyphBuffers;
+	std::array<uint32_t, maxFramesInFlight> projectileQuadCounts{};
+	//Tile atlas rects followed by one rect per glyph cache slot
+	BufferResources<GlyphRect> glyphRectBuffer;
+	uint32_t glyphCacheRectOffset{};
+	std::array<BufferResources<uint8_t>, maxFramesInFlight> glyphUploadBuffers;
+	std::vector<vk::BufferImageCopy> glyphUploadCopies;
 	std::array<vk::CommandBuffer, maxFramesInFlight> commandBuffers;
+	vk::UniqueQueryPool timestampQueryPool;
+	std::array<bool, maxFramesInFlight> timestampsWritten{};
+
+	//Scratch state of scene recording, filled from worker threads
+	mutable std::array<std::vector<RecordingContext>, maxFramesInFlight> recordingContexts;
+	mutable std::vector<DrawBatch> drawBatches;
+	mutable std::vector<vk::CommandBuffer> drawBatchCommandBuffers;
 
 	std::array<vk::UniqueSemaphore, maxFramesInFlight> imageAvailableSemaphores;
 	std::array<vk::UniqueSemaphore, maxFramesInFlight> renderFinishedSemaphores;
@@ -146,6 +338,14 @@ private:
 
 	uint32_t oldRendersRemaining{};
 	SwapchainResources oldSwapchainResources;
+
+	PresentMode presentMode{};
+	bool swapchainRecreationRequested{};
+	bool redrawRequested{true};
+
+	double renderScale{1.0};
+	double averageGpuFrameTime{};
+	uint32_t framesSinceScaleChange{};
 };
 
 
@@ -0,0 +1,318 @@
+module;
+
+#define VULKAN_HPP_DISPATCH_LOADER_DYNAMIC 1
+#define VULKAN_HPP_NO_EXCEPTIONS
+#define VULKAN_HPP_ASSERT_ON_RESULT
+#include <vulkan/vulkan.hpp>
+
+module RenderEngine;
+
+using namespace std::literals;
+
+RenderEngine::RenderGraph::ResourceHandle RenderEngine::RenderGraph::importImage(std::string_view name, std::vector<vk::Image> images, ResourceUsage finalUsage)
+{
+	auto& resource = resources.emplace_back();
+	resource.name = name;
+	resource.isImported = true;
+	resource.importedImages = std::move(images);
+	resource.finalUsage = finalUsage;
+	return static_cast<ResourceHandle>(resources.size() - 1);
+}
+
+RenderEngine::RenderGraph::ResourceHandle RenderEngine::RenderGraph::createTransientImage(std::string_view name, vk::Format format, vk::Extent2D extent)
+{
+	auto& resource = resources.emplace_back();
+	resource.name = name;
+	resource.format = format;
+	resource.extent = extent;
+	return static_cast<ResourceHandle>(resources.size() - 1);
+}
+
+void RenderEngine::RenderGraph::addPass(std::string_view name, std::vector<ResourceAccess> reads, std::vector<ResourceAccess> writes, RecordFunction record)
+{
+	auto& pass = passes.emplace_back();
+	pass.name = name;
+	pass.reads = std::move(reads);
+	pass.writes = std::move(writes);
+	pass.record = std::move(record);
+}
+
+bool RenderEngine::RenderGraph::compile(RenderEngine const& engine)
+{
+	cullPasses();
+
+	//Find lifetimes of resources over the remaining passes
+	for(uint32_t passIndex = 0; passIndex < passes.size(); passIndex++)
+	{
+		auto const& pass = passes[passIndex];
+		if(pass.isCulled)
+			continue;
+
+		for(auto const& accesses : {std::cref(pass.reads), std::cref(pass.writes)})
+		{
+			for(auto const& access : accesses.get())
+			{
+				auto& resource = resources[access.resource];
+				if(!resource.firstPass)
+					resource.firstPass = passIndex;
+				resource.lastPass = passIndex;
+				resource.usageFlags |= getImageUsage(access.usage);
+			}
+		}
+	}
+
+	if(!createTransientImages(engine))
+		return false;
+
+	deriveBarriers();
+	return true;
+}
+
+void RenderEngine::RenderGraph::execute(vk::CommandBuffer commandBuffer, uint32_t imageIndex) const
+{
+	for(auto const& pass : passes)
+	{
+		if(pass.isCulled)
+			continue;
+
+		recordBarriers(commandBuffer, pass.barriers, imageIndex);
+		pass.record(commandBuffer, imageIndex);
+	}
+
+	recordBarriers(commandBuffer, finalBarriers, imageIndex);
+}
+
+vk::Image RenderEngine::RenderGraph::getImage(ResourceHandle handle, uint32_t imageIndex) const
+{
+	auto const& resource = resources[handle];
+	return resource.isImported ? resource.importedImages[imageIndex] : resource.image.get();
+}
+
+RenderEngine::RenderGraph::UsageState RenderEngine::RenderGraph::getUsageState(ResourceUsage usage)
+{
+	switch(usage)
+	{
+		case ResourceUsage::colorAttachment:
+			return {vk::ImageLayout::eColorAttachmentOptimal, vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::AccessFlagBits::eColorAttachmentWrite, true};
+		case ResourceUsage::transferSource:
+			return {vk::ImageLayout::eTransferSrcOptimal, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferRead, false};
+		case ResourceUsage::transferDestination:
+			return {vk::ImageLayout::eTransferDstOptimal, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferWrite, true};
+		case ResourceUsage::sampled:
+			return {vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eShaderRead, false};
+		default:
+			return {vk::ImageLayout::ePresentSrcKHR, vk::PipelineStageFlagBits::eBottomOfPipe, vk::AccessFlagBits::eNone, false};
+	}
+}
+
+vk::ImageUsageFlags RenderEngine::RenderGraph::getImageUsage(ResourceUsage usage)
+{
+	switch(usage)
+	{
+		case ResourceUsage::colorAttachment: return vk::ImageUsageFlagBits::eColorAttachment;
+		case ResourceUsage::transferSource: return vk::ImageUsageFlagBits::eTransferSrc;
+		case ResourceUsage::transferDestination: return vk::ImageUsageFlagBits::eTransferDst;
+		case ResourceUsage::sampled: return vk::ImageUsageFlagBits::eSampled;
+		default: return {};
+	}
+}
+
+void RenderEngine::RenderGraph::cullPasses()
+{
+	//Imported images leave the graph, everything else only matters if a kept pass reads it
+	std::vector<bool> isResourceNeeded(resources.size());
+	for(size_t i = 0; i < resources.size(); i++)
+		isResourceNeeded[i] = resources[i].isImported;
+
+	for(auto& pass : passes | std::views::reverse)
+	{
+		pass.isCulled = std::ranges::none_of(pass.writes, [&isResourceNeeded](ResourceAccess const& access) { return isResourceNeeded[access.resource]; });
+		if(pass.isCulled)
+		{
+			Logger::logInfo(std::format("Culled render pass {}", pass.name));
+			continue;
+		}
+
+		for(auto const& access : pass.reads)
+			isResourceNeeded[access.resource] = true;
+	}
+}
+
+bool RenderEngine::RenderGraph::createTransientImages(RenderEngine const& engine)
+{
+	struct MemoryBlock
+	{
+		vk::MemoryRequirements requirements;
+		std::vector<ResourceHandle> occupants;
+	};
+
+	//Create images first to learn their memory requirements
+	std::vector<std::pair<ResourceHandle, vk::MemoryRequirements>> transientImages;
+	for(ResourceHandle handle = 0; handle < resources.size(); handle++)
+	{
+		auto& resource = resources[handle];
+		if(resource.isImported || !resource.firstPass)
+			continue;
+
+		vk::ImageCreateInfo imageCreateInfo({}, vk::ImageType::e2D, resource.format, vk::Extent3D{resource.extent.width, resource.extent.height, 1u},
+											1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, resource.usageFlags,
+											vk::SharingMode::eExclusive, engine.physicalDeviceInfo.graphicsIndex, vk::ImageLayout::eUndefined);
+		if(engine.checkVulkanErrorOccured(resource.image, engine.device->createImageUnique(imageCreateInfo), "", "Failed to create transient image "s + resource.name))
+			return false;
+
+		transientImages.emplace_back(handle, engine.device->getImageMemoryRequirements(resource.image.get()));
+	}
+
+	//Place largest images first, sharing a block with images whose lifetimes don't overlap
+	std::ranges::sort(transientImages, std::greater{}, [](auto const& image) { return image.second.size; });
+	std::vector<MemoryBlock> blocks;
+	for(auto const& transientImage : transientImages)
+	{
+		auto handle = transientImage.first;
+		auto const& requirements = transientImage.second;
+		auto const& resource = resources[handle];
+		auto isOverlapping = [this, &resource](ResourceHandle other)
+		{
+			return *resource.firstPass <= *resources[other].lastPass && *resources[other].firstPass <= *resource.lastPass;
+		};
+
+		auto block = std::ranges::find_if(blocks, [&](MemoryBlock const& candidate)
+		{
+			return (candidate.requirements.memoryTypeBits & requirements.memoryTypeBits) && std::ranges::none_of(candidate.occupants, isOverlapping);
+		});
+		if(block == blocks.end())
+		{
+			blocks.push_back(MemoryBlock{requirements, {}});
+			block = std::prev(blocks.end());
+		}
+
+		block->requirements.size = std::max(block->requirements.size, requirements.size);
+		block->requirements.alignment = std::max(block->requirements.alignment, requirements.alignment);
+		block->requirements.memoryTypeBits &= requirements.memoryTypeBits;
+		block->occupants.emplace_back(handle);
+	}
+
+	//Allocate blocks and bind their occupants to the start of them
+	for(auto& block : blocks)
+	{
+		auto selectedMemoryType = engine.getMemoryType(block.requirements, vk::MemoryPropertyFlagBits::eDeviceLocal);
+		if(selectedMemoryType == -1)
+			return false;
+
+		vk::MemoryAllocateInfo memoryAllocateInfo(block.requirements.size, selectedMemoryType);
+		auto& memory = transientMemories.emplace_back();
+		if(engine.checkVulkanErrorOccured(memory, engine.device->allocateMemoryUnique(memoryAllocateInfo), "", "Failed to allocate transient image memory"))
+			return false;
+
+		std::ranges::sort(block.occupants, {}, [this](ResourceHandle handle) { return *resources[handle].firstPass; });
+		for(auto handle : block.occupants)
+		{
+			auto& resource = resources[handle];
+			if(engine.checkVulkanErrorOccured(engine.device->bindImageMemory(resource.image.get(), memory.get(), 0), "", "Failed to bind transient image memory"))
+				return false;
+
+			vk::ImageSubresourceRange subresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+			vk::ImageViewCreateInfo viewCreateInfo({}, resource.image.get(), vk::ImageViewType::e2D, resource.format, {}, subresourceRange);
+			if(engine.checkVulkanErrorOccured(resource.imageView, engine.device->createImageViewUnique(viewCreateInfo), "", "Failed to create transient image view"))
+				return false;
+		}
+
+		if(block.occupants.size() > 1)
+			Logger::logInfo(std::format("{} transient images alias {} bytes of memory", block.occupants.size(), block.requirements.size));
+	}
+
+	//First use of each image has to wait for the previous occupant, the last occupant of the previous frame for the first one
+	std::vector<UsageState> lastStates = deriveBarriers();
+	for(auto const& block : blocks)
+	{
+		for(size_t i = 0; i < block.occupants.size(); i++)
+		{
+			auto previousOccupant = block.occupants[(i + block.occupants.size() - 1) % block.occupants.size()];
+			resources[block.occupants[i]].aliasedState = lastStates[previousOccupant];
+		}
+	}
+
+	return true;
+}
+
+std::vector<RenderEngine::RenderGraph::UsageState> RenderEngine::RenderGraph::deriveBarriers()
+{
+	std::vector<std::optional<UsageState>> states(resources.size());
+
+	auto addBarrier = [this, &states](BarrierBatch& batch, ResourceHandle handle, UsageState const& nextState)
+	{
+		auto& resource = resources[handle];
+		auto& state = states[handle];
+
+		if(!state)
+		{
+			//Contents are discarded on first use, imported images wait on the stage that first touches them
+			UsageState previousState{vk::ImageLayout::eUndefined, nextState.stages, {}, false};
+			if(!resource.isImported)
+				previousState = {vk::ImageLayout::eUndefined, resource.aliasedState.stages, resource.aliasedState.accesses, resource.aliasedState.isWrite};
+			else
+				resource.firstUseStage = nextState.stages;
+			state = previousState;
+		}
+		else if(state->layout == nextState.layout && !state->isWrite && !nextState.isWrite)
+		{
+			//Reads in the same layout don't need a barrier, but a later write has to wait for all of them
+			state->stages |= nextState.stages;
+			state->accesses |= nextState.accesses;
+			return;
+		}
+
+		if(state->stages)
+			batch.sourceStages |= state->stages;
+		else
+			batch.sourceStages |= vk::PipelineStageFlagBits::eTopOfPipe;
+		batch.destinationStages |= nextState.stages;
+		batch.barriers.push_back(Barrier{handle, state->isWrite ? state->accesses : vk::AccessFlags{}, nextState.accesses, state->layout, nextState.layout});
+		state = nextState;
+	};
+
+	for(auto& pass : passes)
+	{
+		pass.barriers = {};
+		if(pass.isCulled)
+			continue;
+
+		for(auto const& accesses : {std::cref(pass.reads), std::cref(pass.writes)})
+		{
+			for(auto const& access : accesses.get())
+				addBarrier(pass.barriers, access.resource, getUsageState(access.usage));
+		}
+	}
+
+	finalBarriers = {};
+	for(ResourceHandle handle = 0; handle < resources.size(); handle++)
+	{
+		if(resources[handle].isImported && states[handle])
+			addBarrier(finalBarriers, handle, getUsageState(resources[handle].finalUsage));
+	}
+
+	std::vector<UsageState> lastStates(resources.size());
+	for(size_t i = 0; i < states.size(); i++)
+	{
+		if(states[i])
+			lastStates[i] = *states[i];
+	}
+	return lastStates;
+}
+
+void RenderEngine::RenderGraph::recordBarriers(vk::CommandBuffer commandBuffer, BarrierBatch const& batch, uint32_t imageIndex) const
+{
+	if(batch.barriers.empty())
+		return;
+
+	std::vector<vk::ImageMemoryBarrier> imageBarriers;
+	imageBarriers.reserve(batch.barriers.size());
+	vk::ImageSubresourceRange range(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+	for(auto const& barrier : batch.barriers)
+	{
+		imageBarriers.emplace_back(barrier.sourceAccesses, barrier.destinationAccesses, barrier.oldLayout, barrier.newLayout,
+								   VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, getImage(barrier.resource, imageIndex), range);
+	}
+
+	commandBuffer.pipelineBarrier(batch.sourceStages, batch.destinationStages, {}, {}, {}, imageBarriers);
+}
@@ -0,0 +1,103 @@
+module Scheduler;
+
+void Scheduler::release()
+{
+	tick = 0;
+	slots.fill(noNode);
+	nodes.clear();
+	freeNodes.clear();
+	dueEvents.clear();
+}
+
+Scheduler::Handle Scheduler::schedule(Event event, std::uint64_t delay)
+{
+	std::uint32_t index{};
+	if(freeNodes.empty())
+	{
+		index = static_cast<std::uint32_t>(nodes.size());
+		nodes.push_back(Node{.generation = 1});
+	}
+	else
+	{
+		index = freeNodes.back();
+		freeNodes.pop_back();
+	}
+
+	auto& node = nodes[index];
+	node.event = event;
+	node.dueTick = tick + std::clamp(delay, std::uint64_t(1), maxDelay);
+	link(index);
+	return {index, node.generation};
+}
+
+bool Scheduler::cancel(Handle handle)
+{
+	if(handle.index >= nodes.size() || nodes[handle.index].generation != handle.generation)
+		return false;
+
+	unlink(handle.index);
+	freeNode(handle.index);
+	return true;
+}
+
+std::vector<Scheduler::Event> const& Scheduler::advance()
+{
+	dueEvents.clear();
+	tick++;
+
+	//Coarse slots whose span starts now are spread over the finer levels, highest first so events can fall through several
+	for(auto level = levelCount - 1; level > 0; level--)
+	{
+		if(tick & ((std::uint64_t(1) << level * slotBits) - 1))
+			continue;
+
+		auto index = std::exchange(slots[level * slotCount + (tick >> level * slotBits & (slotCount - 1))], noNode);
+		while(index != noNode)
+		{
+			auto next = nodes[index].next;
+			link(index);
+			index = next;
+		}
+	}
+
+	auto index = std::exchange(slots[tick & (slotCount - 1)], noNode);
+	while(index != noNode)
+	{
+		dueEvents.push_back(nodes[index].event);
+		auto next = nodes[index].next;
+		freeNode(index);
+		index = next;
+	}
+	return dueEvents;
+}
+
+void Scheduler::link(std::uint32_t index)
+{
+	auto& node = nodes[index];
+	auto delta = node.dueTick - tick;
+	auto level = delta == 0 ? 0 : static_cast<std::uint32_t>(std::bit_width(delta) - 1) / slotBits;
+
+	node.slot = level * slotCount + static_cast<std::uint32_t>(node.dueTick >> level * slotBits & (slotCount - 1));
+	node.previous = noNode;
+	node.next = slots[node.slot];
+	if(node.next != noNode)
+		nodes[node.next].previous = index;
+	slots[node.slot] = index;
+}
+
+void Scheduler::unlink(std::uint32_t index)
+{
+	auto const& node = nodes[index];
+	if(node.previous != noNode)
+		nodes[node.previous].next = node.next;
+	else
+		slots[node.slot] = node.next;
+	if(node.next != noNode)
+		nodes[node.next].previous = node.previous;
+}
+
+void Scheduler::freeNode(std::uint32_t index)
+{
+	nodes[index].generation++;
+	freeNodes.push_back(index);
+}
@@ -0,0 +1,77 @@
+export module Scheduler;
+
+export import std;
+
+//Hierarchical timing wheel of game events, counted in ticks
+//Events are filed by the tick they're due, so advancing only visits what's due and the coarse slots whose span starts
+export class Scheduler
+{
+public:
+	enum class EventType : std::uint8_t
+	{
+		action,
+		statusExpiry,
+		spawn
+	};
+
+	struct Event
+	{
+		EventType type;
+		//Index of the actor the event is for
+		std::uint32_t target;
+	};
+
+	//Refers to a scheduled event, cancelling it once it ran or got cancelled does nothing
+	struct Handle
+	{
+		std::uint32_t index;
+		std::uint32_t generation;
+	};
+
+	//Every level has slotCount slots, level l holds events due within slotCount^(l+1) ticks with one slot per slotCount^l ticks
+	static constexpr std::uint32_t slotBits{6};
+	static constexpr std::uint32_t slotCount{1 << slotBits};
+	static constexpr std::uint32_t levelCount{4};
+	//Longest delay the wheel can hold, longer ones are cut to it
+	static constexpr std::uint64_t maxDelay{(std::uint64_t(1) << slotBits * levelCount) - 1};
+
+	static void release();
+
+	//Due delay ticks after the current one, at least one
+	static Handle schedule(Event event, std::uint64_t delay);
+	//Returns whether the event was still pending
+	static bool cancel(Handle handle);
+	//Moves to the next tick, returns the events due in it until the next call
+	static std::vector<Event> const& advance();
+	[[nodiscard]] static auto getTick() { return tick; }
+
+private:
+	static constexpr std::uint32_t noNode{std::numeric_limits<std::uint32_t>::max()};
+
+	struct Node
+	{
+		Event event;
+		std::uint64_t dueTick;
+		//Slot the node is linked into and its neighbours there
+		std::uint32_t slot, previous, next;
+		//Bumped whenever the node is freed so old handles stop matching
+		std::uint32_t generation;
+	};
+
+	//Files the node by how far away it's due
+	static void link(std::uint32_t index);
+	static void unlink(std::uint32_t index);
+	static void freeNode(std::uint32_t index);
+
+	inline static std::uint64_t tick{};
+	//First node of every slot, level after level
+	inline static auto slots = []()
+	{
+		std::array<std::uint32_t, slotCount * levelCount> heads;
+		heads.fill(noNode);
+		return heads;
+	}();
+	inline static std::vector<Node> nodes;
+	inline static std::vector<std::uint32_t> freeNodes;
+	inline static std::vector<Event> dueEvents;
+};
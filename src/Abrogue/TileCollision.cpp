@@ -0,0 +1,153 @@
+module TileCollision;
+
+import JobSystem;
+
+void TileCollision::release()
+{
+	positionsX.clear();
+	positionsY.clear();
+	halfWidths.clear();
+	halfHeights.clear();
+	movesX.clear();
+	movesY.clear();
+	results.clear();
+}
+
+std::uint32_t TileCollision::request(double x, double y, double halfWidth, double halfHeight, double moveX, double moveY)
+{
+	positionsX.push_back(x);
+	positionsY.push_back(y);
+	halfWidths.push_back(halfWidth);
+	halfHeights.push_back(halfHeight);
+	movesX.push_back(moveX);
+	movesY.push_back(moveY);
+	return static_cast<std::uint32_t>(positionsX.size() - 1);
+}
+
+void TileCollision::resolve()
+{
+	results.resize(positionsX.size());
+
+	//Sweeps only read the world, hand them out in blocks so a job is worth its overhead
+	constexpr std::size_t blockSize{64};
+	JobSystem::parallelFor((results.size() + blockSize - 1) / blockSize, [](std::size_t block)
+	{
+		for(auto i = block * blockSize; i < std::min(results.size(), (block + 1) * blockSize); i++)
+			results[i] = sweep(i);
+	});
+
+	positionsX.clear();
+	positionsY.clear();
+	halfWidths.clear();
+	halfHeights.clear();
+	movesX.clear();
+	movesY.clear();
+}
+
+TileCollision::Result TileCollision::sweep(std::size_t move)
+{
+	auto x = positionsX[move], y = positionsY[move];
+	auto halfWidth = halfWidths[move], halfHeight = halfHeights[move];
+	auto moveX = movesX[move], moveY = movesY[move];
+	Result result{x, y, false, false};
+
+	//A hit stops one axis, so the second pass slides along the wall with what's left of the other
+	for(std::uint32_t pass = 0; pass < 2 && (moveX != 0.0 || moveY != 0.0); pass++)
+	{
+		//Next column and row the leading edges enter, and the fraction of the move at which they do
+		constexpr auto never = std::numeric_limits<double>::infinity();
+		std::int32_t stepX = moveX > 0.0 ? 1 : -1, stepY = moveY > 0.0 ? 1 : -1;
+		std::int32_t column{}, row{};
+		double timeX{never}, timeY{never}, timeStepX{never}, timeStepY{never};
+		if(moveX != 0.0)
+		{
+			auto edge = moveX > 0.0 ? x + halfWidth : x - halfWidth;
+			column = moveX > 0.0 ? static_cast<std::int32_t>(std::ceil(edge / World::cellWidth)) : static_cast<std::int32_t>(std::floor(edge / World::cellWidth)) - 1;
+			timeX = ((moveX > 0.0 ? column : column + 1) * double(World::cellWidth) - edge) / moveX;
+			timeStepX = World::cellWidth / std::abs(moveX);
+		}
+		if(moveY != 0.0)
+		{
+			auto edge = moveY > 0.0 ? y + halfHeight : y - halfHeight;
+			row = moveY > 0.0 ? static_cast<std::int32_t>(std::ceil(edge / World::cellHeight)) : static_cast<std::int32_t>(std::floor(edge / World::cellHeight)) - 1;
+			timeY = ((moveY > 0.0 ? row : row + 1) * double(World::cellHeight) - edge) / moveY;
+			timeStepY = World::cellHeight / std::abs(moveY);
+		}
+
+		bool isHitX{}, isHitY{};
+		double hitTime{1.0};
+		while(std::min(timeX, timeY) <= 1.0)
+		{
+			//Spans include the last line entered on the other axis, so a box entering a column and row at once checks the corner cell too
+			if(timeX <= timeY)
+			{
+				auto [first, last] = getCellSpan(y + moveY * timeX - halfHeight, y + moveY * timeX + halfHeight, World::cellHeight);
+				if(moveY != 0.0)
+				{
+					first = std::min(first, row - stepY);
+					last = std::max(last, row - stepY);
+				}
+				if(getHasWall(true, column, first, last))
+				{
+					isHitX = true;
+					hitTime = timeX;
+					break;
+				}
+				column += stepX;
+				timeX += timeStepX;
+			}
+			else
+			{
+				auto [first, last] = getCellSpan(x + moveX * timeY - halfWidth, x + moveX * timeY + halfWidth, World::cellWidth);
+				if(moveX != 0.0)
+				{
+					first = std::min(first, column - stepX);
+					last = std::max(last, column - stepX);
+				}
+				if(getHasWall(false, row, first, last))
+				{
+					isHitY = true;
+					hitTime = timeY;
+					break;
+				}
+				row += stepY;
+				timeY += timeStepY;
+			}
+		}
+
+		//Stop just short of the wall that was hit
+		auto newX = x + moveX * hitTime, newY = y + moveY * hitTime;
+		if(isHitX)
+			newX = moveX > 0.0 ? column * double(World::cellWidth) - halfWidth - skinWidth : (column + 1) * double(World::cellWidth) + halfWidth + skinWidth;
+		if(isHitY)
+			newY = moveY > 0.0 ? row * double(World::cellHeight) - halfHeight - skinWidth : (row + 1) * double(World::cellHeight) + halfHeight + skinWidth;
+		x = newX;
+		y = newY;
+		result.isBlockedX |= isHitX;
+		result.isBlockedY |= isHitY;
+		if(!isHitX && !isHitY)
+			break;
+
+		moveX = isHitX ? 0.0 : moveX * (1.0 - hitTime);
+		moveY = isHitY ? 0.0 : moveY * (1.0 - hitTime);
+	}
+
+	result.x = x;
+	result.y = y;
+	return result;
+}
+
+bool TileCollision::getHasWall(bool isColumn, std::int32_t line, std::int32_t first, std::int32_t last)
+{
+	for(auto i = first; i <= last; i++)
+	{
+		if(isColumn ? World::getIsWall(line, i) : World::getIsWall(i, line))
+			return true;
+	}
+	return false;
+}
+
+std::pair<std::int32_t, std::int32_t> TileCollision::getCellSpan(double min, double max, double cellSize)
+{
+	return {static_cast<std::int32_t>(std::floor((min + skinWidth / 2.0) / cellSize)), static_cast<std::int32_t>(std::ceil((max - skinWidth / 2.0) / cellSize)) - 1};
+}
@@ -0,0 +1,41 @@
+export module TileCollision;
+
+export import std;
+export import World;
+
+//Moves axis aligned boxes through the tile grid without passing through walls, sliding along the walls they hit
+//Moves are collected over a tick and resolved together
+export class TileCollision
+{
+public:
+	struct Result
+	{
+		double x, y;
+		//Movement along the axis was cut short by a wall
+		bool isBlockedX, isBlockedY;
+	};
+
+	static void release();
+
+	//Index of the result once resolve ran, moves requested after it go into the next batch
+	static std::uint32_t request(double x, double y, double halfWidth, double halfHeight, double moveX, double moveY);
+	static void resolve();
+	[[nodiscard]] static Result getResult(std::uint32_t move) { return results[move]; }
+
+private:
+	//Gap kept between a box and the wall it stopped at, so it doesn't start the next move overlapping it
+	static constexpr double skinWidth{1e-6};
+
+	//Walks the grid lines the leading edges cross in order of time, stops at the first wall and slides along it with the rest of the move
+	static Result sweep(std::size_t move);
+	//Whether any cell of a column or row from first to last is a wall
+	static bool getHasWall(bool isColumn, std::int32_t line, std::int32_t first, std::int32_t last);
+	//Cells a box spanning min to max overlaps, touching a grid line doesn't count
+	static std::pair<std::int32_t, std::int32_t> getCellSpan(double min, double max, double cellSize);
+
+	//Requested moves, one array per field so a batch reads them sequentially
+	inline static std::vector<double> positionsX, positionsY;
+	inline static std::vector<double> halfWidths, halfHeights;
+	inline static std::vector<double> movesX, movesY;
+	inline static std::vector<Result> results;
+};
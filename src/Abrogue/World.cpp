@@ -0,0 +1,145 @@
+module World;
+
+import Logger;
+import JobSystem;
+
+bool World::init(std::uint64_t newSeed)
+{
+	level = std::make_shared<DungeonLevel>(newSeed, levelSize, levelSize);
+	std::tie(levelOffsetX, levelOffsetY) = DungeonGenerator::getSpawnCell(level->getWidth(), level->getHeight());
+
+	freeSlots.resize(maxResidentChunks);
+	//Lowest slots are handed out first
+	std::iota(freeSlots.rbegin(), freeSlots.rend(), 0u);
+	isEnabled = true;
+
+	Logger::logInfo(std::format("Started {}x{} level with seed {}, keeping regions of {}x{} cells near the player", level->getWidth(), level->getHeight(), newSeed,
+								DungeonGenerator::regionSize, DungeonGenerator::regionSize));
+	Logger::logInfo(std::format("Keeping at most {} chunks of {}x{} cells", maxResidentChunks, Chunk::size, Chunk::size));
+	return true;
+}
+
+void World::release()
+{
+	isEnabled = false;
+	level.reset();
+	residentChunks.clear();
+	pendingChunks.clear();
+	queuedChunks.clear();
+	freeSlots.clear();
+
+	std::scoped_lock lock(finishedMutex);
+	finishedChunks.clear();
+}
+
+void World::update(double x, double y)
+{
+	if(!isEnabled)
+		return;
+
+	auto [cellX, cellY] = getCell(x, y);
+	auto centerX = cellX >> Chunk::sizeShift, centerY = cellY >> Chunk::sizeShift;
+	auto getDistance = [centerX, centerY](std::int32_t chunkX, std::int32_t chunkY) { return std::max(std::abs(chunkX - centerX), std::abs(chunkY - centerY)); };
+
+	//Outside the unload radius the chunk square holds maxResidentChunks, so freed slots always cover the chunks taken in below
+	std::erase_if(residentChunks, [&](auto const& entry)
+	{
+		if(getDistance(entry.second->x, entry.second->y) <= unloadRadius)
+			return false;
+		freeSlots.push_back(entry.second->slot);
+		isDirty = true;
+		return true;
+	});
+	level->dropRegions(cellX + levelOffsetX, cellY + levelOffsetY, keptRegionRadius);
+
+	//Without workers chunks are generated a few per update on the main thread instead
+	constexpr std::uint32_t mainThreadBudget{2};
+	for(std::uint32_t i = 0; i < mainThreadBudget && !queuedChunks.empty(); i++)
+	{
+		auto [chunkX, chunkY] = queuedChunks.front();
+		queuedChunks.pop_front();
+		auto chunk = generateChunk(*level, chunkX, chunkY);
+		std::scoped_lock lock(finishedMutex);
+		finishedChunks.push_back(std::move(chunk));
+	}
+
+	std::vector<std::unique_ptr<Chunk>> finished;
+	{
+		std::scoped_lock lock(finishedMutex);
+		finished.swap(finishedChunks);
+	}
+	for(auto& chunk : finished)
+	{
+		auto key = getChunkKey(chunk->x, chunk->y);
+		pendingChunks.erase(key);
+		//The player moved on while it was generated
+		if(getDistance(chunk->x, chunk->y) > unloadRadius)
+			continue;
+
+		chunk->slot = freeSlots.back();
+		freeSlots.pop_back();
+		chunk->revision = nextRevision++;
+		residentChunks.emplace(key, std::move(chunk));
+		isDirty = true;
+	}
+
+	std::vector<std::pair<std::int32_t, std::int32_t>> missingChunks;
+	for(auto chunkY = centerY - viewRadius; chunkY <= centerY + viewRadius; chunkY++)
+	{
+		for(auto chunkX = centerX - viewRadius; chunkX <= centerX + viewRadius; chunkX++)
+		{
+			auto key = getChunkKey(chunkX, chunkY);
+			if(!residentChunks.contains(key) && !pendingChunks.contains(key))
+				missingChunks.emplace_back(chunkX, chunkY);
+		}
+	}
+	std::ranges::sort(missingChunks, {}, [&](auto const& chunk) { return std::abs(chunk.first - centerX) + std::abs(chunk.second - centerY); });
+
+	for(auto [chunkX, chunkY] : missingChunks)
+	{
+		pendingChunks.insert(getChunkKey(chunkX, chunkY));
+		if(JobSystem::getThreadCount() == 1)
+		{
+			queuedChunks.emplace_back(chunkX, chunkY);
+			continue;
+		}
+
+		JobSystem::submit([chunkLevel = level, chunkX, chunkY]()
+		{
+			auto chunk = generateChunk(*chunkLevel, chunkX, chunkY);
+			std::scoped_lock lock(finishedMutex);
+			finishedChunks.push_back(std::move(chunk));
+		});
+	}
+}
+
+bool World::getIsWall(std::int32_t cellX, std::int32_t cellY)
+{
+	auto chunk = findChunk(cellX >> Chunk::sizeShift, cellY >> Chunk::sizeShift);
+	return !chunk || chunk->getIsWall(cellX & (Chunk::size - 1), cellY & (Chunk::size - 1));
+}
+
+Chunk const* World::findChunk(std::int32_t chunkX, std::int32_t chunkY)
+{
+	auto chunk = residentChunks.find(getChunkKey(chunkX, chunkY));
+	return chunk == residentChunks.end() ? nullptr : chunk->second.get();
+}
+
+std::pair<std::int32_t, std::int32_t> World::getCell(double x, double y)
+{
+	return {static_cast<std::int32_t>(std::floor(x / cellWidth)), static_cast<std::int32_t>(std::floor(y / cellHeight))};
+}
+
+std::unique_ptr<Chunk> World::generateChunk(DungeonLevel const& level, std::int32_t chunkX, std::int32_t chunkY)
+{
+	auto chunk = std::make_unique<Chunk>();
+	chunk->x = chunkX;
+	chunk->y = chunkY;
+
+	//Whole rows at once, generating the level region the first time one of them is read
+	static_assert(Chunk::size == 32);
+	auto levelX = chunkX * Chunk::size + levelOffsetX;
+	for(std::int32_t localY = 0; localY < Chunk::size; localY++)
+		chunk->wallRows[localY] = level.getRowBits(levelX, chunkY * Chunk::size + localY + levelOffsetY);
+	return chunk;
+}
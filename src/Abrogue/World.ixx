@@ -0,0 +1,82 @@
+export module World;
+
+export import std;
+export import DungeonGenerator;
+
+//Square of cells with walls bit-packed per row
+export struct Chunk
+{
+	static constexpr std::int32_t sizeShift{5};
+	static constexpr std::int32_t size{1 << sizeShift};
+	static constexpr std::uint32_t cellCount{size * size};
+
+	//Bit x of row y is set for walls
+	std::array<std::uint32_t, size> wallRows;
+	std::int32_t x, y;
+	//Place of the chunk in the renderer's world buffers, stable while resident
+	std::uint32_t slot;
+	//Changes whenever the slot gets different contents
+	std::uint64_t revision;
+
+	[[nodiscard]] bool getIsWall(std::int32_t cellX, std::int32_t cellY) const { return wallRows[cellY] >> cellX & 1; }
+};
+
+//Tile world streamed in chunks around the player, only chunks near it are kept in memory
+export class World
+{
+public:
+	//In chunks, chunks are generated within viewRadius and dropped outside unloadRadius
+	static constexpr std::int32_t viewRadius{2}, unloadRadius{3};
+	static constexpr std::uint32_t maxResidentChunks{(2 * unloadRadius + 1) * (2 * unloadRadius + 1)};
+	//Size of one cell in world units, matching the glyph quads of entities
+	static constexpr float cellWidth{0.04f}, cellHeight{0.08f};
+	//In cells, everything outside the level is wall
+	static constexpr std::int32_t levelSize{4096};
+	//Level regions kept around the player's, in regions, enough to hold every resident chunk
+	static constexpr std::int32_t keptRegionRadius{1};
+	static_assert((unloadRadius + 1) * Chunk::size <= keptRegionRadius * DungeonGenerator::regionSize);
+
+	//Starts the level, its regions are generated as chunks and searches first read them, the spawn cell of the dungeon becomes cell 0, 0
+	static bool init(std::uint64_t newSeed);
+	static void release();
+
+	//Unloads chunks and level regions that got too far, takes in generated chunks and requests missing ones, nearest first
+	static void update(double x, double y);
+
+	//Cells of chunks that aren't resident count as walls
+	[[nodiscard]] static bool getIsWall(std::int32_t cellX, std::int32_t cellY);
+	//Reads the level rather than resident chunks, for things away from the player, generating the region if it was dropped
+	[[nodiscard]] static bool getIsLevelWall(std::int32_t cellX, std::int32_t cellY) { return !level || level->getIsWall(cellX + levelOffsetX, cellY + levelOffsetY); }
+	[[nodiscard]] static std::pair<std::int32_t, std::int32_t> getCell(double x, double y);
+	//Shared so work on other threads can keep reading it, level cells are cells plus the offset
+	[[nodiscard]] static std::shared_ptr<DungeonLevel const> getLevel() { return level; }
+	[[nodiscard]] static std::pair<std::int32_t, std::int32_t> getLevelOffset() { return {levelOffsetX, levelOffsetY}; }
+	[[nodiscard]] static auto const& getResidentChunks() { return residentChunks; }
+	//Nothing if the chunk isn't resident
+	[[nodiscard]] static Chunk const* findChunk(std::int32_t chunkX, std::int32_t chunkY);
+
+	//Set whenever chunks were loaded or unloaded since the last clear
+	[[nodiscard]] static auto getIsDirty() { return isDirty; }
+	static void clearDirty() { isDirty = false; }
+
+private:
+	static std::uint64_t getChunkKey(std::int32_t chunkX, std::int32_t chunkY) { return std::uint64_t(std::uint32_t(chunkX)) << 32 | std::uint32_t(chunkY); }
+	static std::unique_ptr<Chunk> generateChunk(DungeonLevel const& level, std::int32_t chunkX, std::int32_t chunkY);
+
+	//Shared with chunk jobs still reading it
+	inline static std::shared_ptr<DungeonLevel> level;
+	inline static std::int32_t levelOffsetX{}, levelOffsetY{};
+	inline static bool isEnabled{};
+	inline static bool isDirty{};
+
+	//Only touched by the main thread
+	inline static std::unordered_map<std::uint64_t, std::unique_ptr<Chunk>> residentChunks;
+	inline static std::unordered_set<std::uint64_t> pendingChunks;
+	inline static std::deque<std::pair<std::int32_t, std::int32_t>> queuedChunks;
+	inline static std::vector<std::uint32_t> freeSlots;
+	inline static std::uint64_t nextRevision{1};
+
+	//Filled by workers
+	inline static std::mutex finishedMutex;
+	inline static std::vector<std::unique_ptr<Chunk>> finishedChunks;
+};
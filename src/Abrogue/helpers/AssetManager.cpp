@@ -0,0 +1,51 @@
+module AssetManager;
+
+import Logger;
+
+void AssetManager::release()
+{
+	queuedLoads.clear();
+	store<ImageLoader> = {};
+	store<GlyphAtlas> = {};
+	store<Asset> = {};
+}
+
+void AssetManager::update()
+{
+	if(!queuedLoads.empty())
+	{
+		queuedLoads.front()();
+		queuedLoads.pop_front();
+	}
+
+	freeUnloaded<ImageLoader>();
+	freeUnloaded<GlyphAtlas>();
+	freeUnloaded<Asset>();
+}
+
+bool AssetManager::loadAsset(std::string_view path, std::optional<ImageLoader>& value)
+{
+	value.emplace(path);
+	return !value->levels.empty();
+}
+
+bool AssetManager::loadAsset(std::string_view path, std::optional<GlyphAtlas>& value)
+{
+	//Falls back to the grid layout without a sidecar, so it always loads
+	value.emplace(path);
+	return true;
+}
+
+bool AssetManager::loadAsset(std::string_view path, std::optional<Asset>& value)
+{
+	value.emplace(AssetPack::load(path));
+	return !value->data.empty();
+}
+
+void AssetManager::logLoad(std::string_view path, bool isLoaded, double durationMs)
+{
+	if(isLoaded)
+		Logger::logInfo(std::format("Loaded asset {} in {:.2f} ms on thread {}", path, durationMs, JobSystem::getThreadIndex()));
+	else
+		Logger::logInfo(std::format("Failed to load asset {}", path));
+}
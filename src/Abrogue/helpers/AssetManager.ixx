@@ -0,0 +1,232 @@
+export module AssetManager;
+
+export import std;
+export import AssetPack;
+export import ImageLoader;
+export import GlyphAtlas;
+import JobSystem;
+
+export enum class AssetState
+{
+	loading,
+	ready,
+	failed
+};
+
+//Typed reference to an asset, the generation keeps handles of unloaded assets from reaching a reused slot
+export template<class T>
+struct AssetHandle
+{
+	std::uint32_t index{}, generation{};
+
+	[[nodiscard]] bool getIsValid() const { return generation != 0; }
+};
+
+//Loads images, glyph atlases and raw assets on workers, shared by path and kept alive by reference counts
+//Handles are only acquired, released and read on the main thread
+export class AssetManager
+{
+public:
+	static void release();
+
+	//Starts loading the asset, or adds a reference to it if the same path is already loaded or loading
+	template<class T>
+	static AssetHandle<T> load(std::string_view path);
+	template<class T>
+	static AssetHandle<T> acquire(AssetHandle<T> handle);
+	//The asset is freed with its last reference, or once its load finishes if it's still loading
+	template<class T>
+	static void unload(AssetHandle<T> handle);
+
+	template<class T>
+	[[nodiscard]] static AssetState getState(AssetHandle<T> handle);
+	//Nothing until the asset is ready
+	template<class T>
+	[[nodiscard]] static T const* get(AssetHandle<T> handle);
+	//Blocks until the asset is loaded, loading it here if no worker started yet, nothing if it failed
+	template<class T>
+	static T const* wait(AssetHandle<T> handle);
+
+	//Runs one queued load on the main thread when there are no workers and frees assets unloaded while loading
+	static void update();
+
+private:
+	template<class T>
+	struct Entry
+	{
+		std::string path;
+		std::uint32_t generation{1};
+		std::uint32_t referenceCount{};
+		//Whoever sets this first runs the load, a worker or a waiting main thread
+		std::atomic_flag isStarted;
+		std::atomic<AssetState> state{AssetState::loading};
+		std::optional<T> value;
+	};
+
+	template<class T>
+	struct Store
+	{
+		//Entries never move, workers write into them
+		std::vector<std::unique_ptr<Entry<T>>> entries;
+		std::unordered_map<std::string, std::uint32_t> paths;
+		std::vector<std::uint32_t> freeIndices;
+	};
+
+	static bool loadAsset(std::string_view path, std::optional<ImageLoader>& value);
+	static bool loadAsset(std::string_view path, std::optional<GlyphAtlas>& value);
+	static bool loadAsset(std::string_view path, std::optional<Asset>& value);
+	static void logLoad(std::string_view path, bool isLoaded, double durationMs);
+
+	template<class T>
+	static void runLoad(Entry<T>& entry);
+	template<class T>
+	static Entry<T>* findEntry(AssetHandle<T> handle);
+	template<class T>
+	static void freeEntry(std::uint32_t index);
+	template<class T>
+	static void freeUnloaded();
+
+	template<class T>
+	inline static Store<T> store;
+
+	//Loads waiting for the main thread when there are no workers
+	inline static std::deque<std::function<void()>> queuedLoads;
+};
+
+template<class T>
+AssetHandle<T> AssetManager::load(std::string_view path)
+{
+	//Different spellings of the same path share one asset
+	auto normalizedPath = std::filesystem::path(path).lexically_normal().generic_string();
+	auto& assets = store<T>;
+	if(auto existing = assets.paths.find(normalizedPath); existing != assets.paths.end())
+	{
+		auto& entry = *assets.entries[existing->second];
+		entry.referenceCount++;
+		return {existing->second, entry.generation};
+	}
+
+	std::uint32_t index{};
+	if(assets.freeIndices.empty())
+	{
+		index = static_cast<std::uint32_t>(assets.entries.size());
+		assets.entries.push_back(std::make_unique<Entry<T>>());
+	}
+	else
+	{
+		index = assets.freeIndices.back();
+		assets.freeIndices.pop_back();
+	}
+
+	auto* entry = assets.entries[index].get();
+	entry->path = normalizedPath;
+	entry->referenceCount = 1;
+	entry->state = AssetState::loading;
+	entry->isStarted.clear();
+	assets.paths.emplace(std::move(normalizedPath), index);
+
+	auto job = [entry]() { runLoad(*entry); };
+	if(JobSystem::getThreadCount() == 1)
+		queuedLoads.push_back(job);
+	else
+		JobSystem::submit(job);
+	return {index, entry->generation};
+}
+
+template<class T>
+AssetHandle<T> AssetManager::acquire(AssetHandle<T> handle)
+{
+	if(auto entry = findEntry(handle))
+		entry->referenceCount++;
+	return handle;
+}
+
+template<class T>
+void AssetManager::unload(AssetHandle<T> handle)
+{
+	auto entry = findEntry(handle);
+	if(!entry || --entry->referenceCount > 0)
+		return;
+
+	//Workers still writing into the entry keep it alive until update
+	if(entry->state.load(std::memory_order_acquire) != AssetState::loading)
+		freeEntry<T>(handle.index);
+}
+
+template<class T>
+AssetState AssetManager::getState(AssetHandle<T> handle)
+{
+	auto entry = findEntry(handle);
+	return entry ? entry->state.load(std::memory_order_acquire) : AssetState::failed;
+}
+
+template<class T>
+T const* AssetManager::get(AssetHandle<T> handle)
+{
+	auto entry = findEntry(handle);
+	if(!entry || entry->state.load(std::memory_order_acquire) != AssetState::ready)
+		return nullptr;
+	return &*entry->value;
+}
+
+template<class T>
+T const* AssetManager::wait(AssetHandle<T> handle)
+{
+	auto entry = findEntry(handle);
+	if(!entry)
+		return nullptr;
+
+	runLoad(*entry);
+	entry->state.wait(AssetState::loading, std::memory_order_acquire);
+	return get(handle);
+}
+
+template<class T>
+void AssetManager::runLoad(Entry<T>& entry)
+{
+	if(entry.isStarted.test_and_set(std::memory_order_acquire))
+		return;
+
+	auto startTime = std::chrono::steady_clock::now();
+	auto isLoaded = loadAsset(entry.path, entry.value);
+	std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+	logLoad(entry.path, isLoaded, duration.count());
+
+	entry.state.store(isLoaded ? AssetState::ready : AssetState::failed, std::memory_order_release);
+	entry.state.notify_all();
+}
+
+template<class T>
+AssetManager::Entry<T>* AssetManager::findEntry(AssetHandle<T> handle)
+{
+	auto& assets = store<T>;
+	if(handle.index >= assets.entries.size())
+		return nullptr;
+	auto* entry = assets.entries[handle.index].get();
+	return entry->generation == handle.generation && entry->referenceCount > 0 ? entry : nullptr;
+}
+
+template<class T>
+void AssetManager::freeEntry(std::uint32_t index)
+{
+	auto& assets = store<T>;
+	auto& entry = *assets.entries[index];
+	assets.paths.erase(entry.path);
+	entry.path.clear();
+	entry.value.reset();
+	entry.referenceCount = 0;
+	entry.generation++;
+	assets.freeIndices.push_back(index);
+}
+
+template<class T>
+void AssetManager::freeUnloaded()
+{
+	auto& assets = store<T>;
+	for(std::uint32_t i = 0; i < assets.entries.size(); i++)
+	{
+		auto& entry = *assets.entries[i];
+		if(entry.referenceCount == 0 && !entry.path.empty() && entry.state.load(std::memory_order_acquire) != AssetState::loading)
+			freeEntry<T>(i);
+	}
+}
@@ -0,0 +1,72 @@
+module AssetPack;
+
+import Logger;
+
+bool AssetPack::init(std::string_view packPath)
+{
+	if(!std::filesystem::exists(packPath))
+	{
+		Logger::logInfo(std::format("Asset pack {} not found, loading loose files", packPath));
+		return true;
+	}
+
+	MappedFile file(packPath);
+	auto fileData = file.getData();
+	if(fileData.size() < headerSize || !std::equal(magic.begin(), magic.end(), fileData.begin()) || readValue<std::uint32_t>(fileData, 4) != version)
+	{
+		Logger::logError(std::format("Asset pack {} is invalid", packPath));
+		return false;
+	}
+
+	auto entryCount = readValue<std::uint32_t>(fileData, 8);
+	auto stringTableSize = readValue<std::uint32_t>(fileData, 12);
+	auto stringTableOffset = headerSize + entrySize * entryCount;
+	if(fileData.size() < stringTableOffset + stringTableSize)
+	{
+		Logger::logError(std::format("Asset pack {} is truncated", packPath));
+		return false;
+	}
+
+	std::string_view stringTable(reinterpret_cast<char const*>(fileData.data()) + stringTableOffset, stringTableSize);
+	entries.reserve(entryCount);
+	for(std::uint32_t i = 0; i < entryCount; i++)
+	{
+		auto entryOffset = headerSize + entrySize * i;
+		auto offset = readValue<std::uint64_t>(fileData, entryOffset);
+		auto size = readValue<std::uint64_t>(fileData, entryOffset + 8);
+		auto nameOffset = readValue<std::uint32_t>(fileData, entryOffset + 16);
+		auto nameLength = readValue<std::uint32_t>(fileData, entryOffset + 20);
+		if(offset % alignment != 0 || offset > fileData.size() || size > fileData.size() - offset || nameOffset > stringTableSize || nameLength > stringTableSize - nameOffset)
+		{
+			Logger::logError(std::format("Asset pack {} has an invalid entry {}", packPath, i));
+			entries.clear();
+			return false;
+		}
+		entries.emplace(stringTable.substr(nameOffset, nameLength), fileData.subspan(offset, size));
+	}
+
+	packFile = std::move(file);
+	Logger::logInfo(std::format("Mapped asset pack {} with {} entries", packPath, entries.size()));
+	return true;
+}
+
+void AssetPack::release()
+{
+	entries.clear();
+	packFile = {};
+}
+
+Asset AssetPack::load(std::string_view name)
+{
+	if(auto entry = entries.find(name); entry != entries.end())
+		return Asset{entry->second, {}};
+
+	Asset asset{{}, MappedFile(name)};
+	asset.data = asset.looseFile.getData();
+	return asset;
+}
+
+bool AssetPack::contains(std::string_view name)
+{
+	return entries.contains(name) || std::filesystem::exists(name);
+}
@@ -0,0 +1,34 @@
+export module AssetPack;
+
+export import std;
+export import MappedFile;
+
+//Bytes of one asset, mapped loose files are kept open here while the asset lives
+export struct Asset
+{
+	std::span<std::uint8_t const> data;
+	MappedFile looseFile;
+};
+
+//Textures, shaders and data packed into one mapped file, assets missing from the pack are mapped from loose files instead
+//Layout: header, index entries sorted by name, name strings, then entry data aligned for SPIR-V words and staging copies
+export class AssetPack
+{
+public:
+	static constexpr std::array<char, 4> magic{'A', 'P', 'A', 'K'};
+	static constexpr std::uint32_t version{1};
+	static constexpr std::size_t headerSize{16}, entrySize{24}, alignment{16};
+
+	//Without a pack every asset is loaded loose
+	static bool init(std::string_view packPath);
+	static void release();
+
+	//Empty if the asset doesn't exist, packed data stays valid until release
+	static Asset load(std::string_view name);
+	[[nodiscard]] static bool contains(std::string_view name);
+
+private:
+	inline static MappedFile packFile;
+	//Names point into the pack's string table
+	inline static std::unordered_map<std::string_view, std::span<std::uint8_t const>> entries;
+};
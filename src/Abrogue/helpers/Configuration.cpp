@@ -26,26 +26,109 @@ bool Configuration::init()
 
 		using ValueType = std::decay_t<decltype(value)>;
 
-		if constexpr(std::is_integral_v<ValueType>)
+		if constexpr(std::is_same_v<ValueType, bool>)
+		{
+			if(!configJSON[key].is_boolean())
+				return;
+
+			value = configJSON[key].get<bool>();
+		}
+		else if constexpr(std::is_integral_v<ValueType>)
 		{
 			if(!configJSON[key].is_number_integer())
 				return;
 
 			value = configJSON[key].get<ValueType>();
 		}
+		else if constexpr(std::is_floating_point_v<ValueType>)
+		{
+			if(!configJSON[key].is_number())
+				return;
+
+			value = configJSON[key].get<ValueType>();
+		}
+		else if constexpr(std::is_same_v<ValueType, PresentMode>)
+		{
+			if(!configJSON[key].is_string())
+				return;
+
+			if(auto mode = getPresentModeFromName(configJSON[key].get<std::string>()))
+				value = *mode;
+		}
 	};
 
 	readJSONValue("windowWidth", windowWidth);
 	readJSONValue("windowHeight", windowHeight);
+	readJSONValue("presentMode", presentMode);
+	readJSONValue("swapchainImageCount", swapchainImageCount);
+	readJSONValue("dynamicResolution", dynamicResolution);
+	readJSONValue("dynamicResolutionMinScale", dynamicResolutionMinScale);
+	readJSONValue("dynamicResolutionTargetMs", dynamicResolutionTargetMs);
+	readJSONValue("dynamicResolutionHysteresis", dynamicResolutionHysteresis);
+
+	dynamicResolutionMinScale = std::clamp(dynamicResolutionMinScale, 0.1, 1.0);
+	dynamicResolutionTargetMs = std::max(dynamicResolutionTargetMs, 0.1);
+	dynamicResolutionHysteresis = std::clamp(dynamicResolutionHysteresis, 0.0, 0.5);
 
 	return true;
 }
 
+bool Configuration::parseCommandLine(int argc, char** argv)
+{
+	for(int i = 1; i < argc; i++)
+	{
+		if(argv[i] == "--benchmark"sv)
+		{
+			//Duration in seconds is optional
+			std::uint64_t durationSeconds{10};
+			if(i + 1 < argc && argv[i + 1][0] != '-')
+			{
+				auto argument = std::string_view(argv[i + 1]);
+				auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), durationSeconds);
+				if(error != std::errc{} || end != argument.data() + argument.size() || durationSeconds == 0)
+				{
+					Logger::logError(std::format("Invalid benchmark duration {}", argument));
+					return false;
+				}
+				i++;
+			}
+
+			benchmarkDurationNS = durationSeconds * 1000000000;
+		}
+	}
+
+	return true;
+}
+
+bool Configuration::setPresentMode(PresentMode newPresentMode)
+{
+	presentMode = newPresentMode;
+	return saveToFile();
+}
+
+std::optional<PresentMode> Configuration::getPresentModeFromName(std::string_view name)
+{
+	for(std::size_t i = 0; i < presentModeNames.size(); i++)
+	{
+		if(presentModeNames[i] == name)
+			return static_cast<PresentMode>(i);
+	}
+
+	Logger::logInfo(std::format("Unknown present mode {} in config, ignoring", name));
+	return std::nullopt;
+}
+
 bool Configuration::saveToFile()
 {
 	nlohmann::json configJSON;
 	configJSON["windowWidth"] = windowWidth;
 	configJSON["windowHeight"] = windowHeight;
+	configJSON["presentMode"] = std::string(getPresentModeName(presentMode));
+	configJSON["swapchainImageCount"] = swapchainImageCount;
+	configJSON["dynamicResolution"] = dynamicResolution;
+	configJSON["dynamicResolutionMinScale"] = dynamicResolutionMinScale;
+	configJSON["dynamicResolutionTargetMs"] = dynamicResolutionTargetMs;
+	configJSON["dynamicResolutionHysteresis"] = dynamicResolutionHysteresis;
 
 	std::ofstream configFile(configFileName.data() + ".json"s, std::ios::out | std::ios::binary);
 	if(!configFile)
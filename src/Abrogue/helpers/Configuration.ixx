@@ -8,17 +8,44 @@ export inline constexpr bool isDebugBuild{false};
 export inline constexpr bool isDebugBuild{true};
 #endif
 
+export enum class PresentMode : std::uint32_t
+{
+	fifo,
+	fifoRelaxed,
+	mailbox,
+	immediate
+};
+
 export class Configuration
 {
 public:
 	static bool init();
+	static bool parseCommandLine(int argc, char** argv);
 
 	static auto getWindowWidth() { return windowWidth; }
 	static auto getWindowHeight() { return windowHeight; }
+	static auto getPresentMode() { return presentMode; }
+	static auto getSwapchainImageCount() { return swapchainImageCount; }
+	static auto getDynamicResolution() { return dynamicResolution; }
+	static auto getDynamicResolutionMinScale() { return dynamicResolutionMinScale; }
+	static auto getDynamicResolutionTargetMs() { return dynamicResolutionTargetMs; }
+	static auto getDynamicResolutionHysteresis() { return dynamicResolutionHysteresis; }
+
+	static bool setPresentMode(PresentMode newPresentMode);
+
+	static auto getIsBenchmark() { return benchmarkDurationNS > 0; }
+	static auto getBenchmarkDurationNS() { return benchmarkDurationNS; }
+
+	//Every PresentMode has a name, cycling through modes wraps around after this many
+	static constexpr std::uint32_t presentModeCount{4};
+	static std::string_view getPresentModeName(PresentMode mode) { return presentModeNames[std::to_underlying(mode)]; }
+	static std::optional<PresentMode> getPresentModeFromName(std::string_view name);
 
 	static constexpr std::string_view configFileName{"config"};
 	static constexpr std::string_view infoLogFileName{"infoLog"};
 	static constexpr std::string_view errorLogFileName{"errorLog"};
+	static constexpr std::string_view textureCacheDirectory{"cache/textures"};
+	static constexpr std::string_view assetPackFileName{"assets.pak"};
 
 	static constexpr std::string_view appName{"Abrogue"};
 	static constexpr std::string_view appVersion{"0.1"};
@@ -35,6 +62,20 @@ public:
 private:
 	static bool saveToFile();
 
+	static constexpr std::array<std::string_view, presentModeCount> presentModeNames{"fifo", "fifoRelaxed", "mailbox", "immediate"};
+
 	inline static std::uint32_t windowWidth{800};
 	inline static std::uint32_t windowHeight{450};
+	inline static PresentMode presentMode{PresentMode::mailbox};
+	//0 lets the render engine pick one more than the surface minimum
+	inline static std::uint32_t swapchainImageCount{0};
+
+	//Render scale follows GPU frame time, staying within target * (1 +- hysteresis)
+	inline static bool dynamicResolution{false};
+	inline static double dynamicResolutionMinScale{0.5};
+	inline static double dynamicResolutionTargetMs{16.0};
+	inline static double dynamicResolutionHysteresis{0.1};
+
+	//Set from the command line only, never saved
+	inline static std::uint64_t benchmarkDurationNS{0};
 };
@@ -0,0 +1,54 @@
+module;
+
+#include <glm/glm.hpp>
+
+module GlyphAtlas;
+
+import AssetPack;
+import MappedFile;
+
+GlyphAtlas::GlyphAtlas(std::string_view filePath)
+{
+	isPacked = loadPacked(filePath);
+	if(isPacked)
+		return;
+
+	rects.clear();
+	metrics.clear();
+	for(std::uint32_t i = 0; i < gridSize * gridSize; i++)
+	{
+		glm::vec2 uvMin{float(i % gridSize) / gridSize, float(i / gridSize) / gridSize};
+		rects.push_back(GlyphRect{uvMin, uvMin + 1.0f / gridSize, {0.0f, 0.0f}, {1.0f, 1.0f}});
+	}
+}
+
+bool GlyphAtlas::loadPacked(std::string_view filePath)
+{
+	constexpr std::uint32_t version{1};
+	constexpr std::size_t headerSize{28}, glyphSize{40};
+
+	auto asset = AssetPack::load(filePath);
+	auto fileData = asset.data;
+	if(fileData.size() < headerSize || std::string_view(reinterpret_cast<char const*>(fileData.data()), 4) != "AGLY")
+		return false;
+
+	auto glyphCount = readValue<std::uint32_t>(fileData, 8);
+	if(readValue<std::uint32_t>(fileData, 4) != version || fileData.size() != headerSize + glyphSize * glyphCount)
+		return false;
+	glm::vec2 atlasSize{readValue<std::uint32_t>(fileData, 12), readValue<std::uint32_t>(fileData, 16)};
+	glm::vec2 tileSize{readValue<std::uint32_t>(fileData, 20), readValue<std::uint32_t>(fileData, 24)};
+
+	for(std::uint32_t i = 0; i < glyphCount; i++)
+	{
+		auto offset = headerSize + glyphSize * i;
+		glm::vec2 position{readValue<std::uint32_t>(fileData, offset + 4), readValue<std::uint32_t>(fileData, offset + 8)};
+		glm::vec2 size{readValue<std::uint32_t>(fileData, offset + 12), readValue<std::uint32_t>(fileData, offset + 16)};
+		glm::vec2 tilePosition{readValue<std::int32_t>(fileData, offset + 20), readValue<std::int32_t>(fileData, offset + 24)};
+		rects.push_back(GlyphRect{position / atlasSize, (position + size) / atlasSize, tilePosition / tileSize, (tilePosition + size) / tileSize});
+
+		metrics.push_back(GlyphMetrics{readValue<std::uint32_t>(fileData, offset), readValue<std::int32_t>(fileData, offset + 28),
+									   readValue<std::int32_t>(fileData, offset + 32), readValue<float>(fileData, offset + 36)});
+	}
+
+	return true;
+}
@@ -0,0 +1,41 @@
+module;
+
+#include <glm/glm.hpp>
+
+export module GlyphAtlas;
+
+export import std;
+
+//Glyph placement read by the quad shader, all coordinates normalized
+export struct GlyphRect
+{
+	glm::vec2 uvMin, uvMax;
+	//Part of the tile covered by the glyph
+	glm::vec2 tileMin, tileMax;
+	//0 for the tile atlas, 1 for the glyph cache
+	std::uint32_t textureIndex{};
+};
+
+export struct GlyphMetrics
+{
+	std::uint32_t codepoint{};
+	std::int32_t xOffset{}, yOffset{};
+	float advance{};
+};
+
+//Glyph rects of the tile atlas, read from the sidecar of a packed atlas or covering the cells of a 16x16 grid atlas
+export class GlyphAtlas
+{
+public:
+	static constexpr std::uint32_t gridSize{16};
+
+	GlyphAtlas() = default;
+	GlyphAtlas(std::string_view filePath);
+
+	bool isPacked{};
+	std::vector<GlyphRect> rects;
+	std::vector<GlyphMetrics> metrics;
+
+private:
+	bool loadPacked(std::string_view filePath);
+};
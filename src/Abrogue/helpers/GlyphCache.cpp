@@ -0,0 +1,190 @@
+module;
+
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <stb/stb_truetype.h>
+#include <glm/glm.hpp>
+
+module GlyphCache;
+
+import Logger;
+import JobSystem;
+
+bool GlyphCache::init(std::string_view fontPath)
+{
+	fontName = fontPath;
+	fontHandle = AssetManager::load<Asset>(fontPath);
+	return true;
+}
+
+void GlyphCache::release()
+{
+	isEnabled = false;
+	residentGlyphs.clear();
+	pendingGlyphs.clear();
+	queuedGlyphs.clear();
+	slots = {};
+	finishedGlyphs.clear();
+	AssetManager::unload(fontHandle);
+	fontHandle = {};
+}
+
+std::optional<std::uint32_t> GlyphCache::findGlyph(std::uint32_t codepoint)
+{
+	if(auto resident = residentGlyphs.find(codepoint); resident != residentGlyphs.end())
+	{
+		slots[resident->second].lastUsedFrame = currentFrame;
+		return resident->second;
+	}
+
+	if(!isEnabled || !pendingGlyphs.insert(codepoint).second)
+		return std::nullopt;
+
+	//Without workers glyphs are rasterized a few per frame on the main thread instead
+	if(JobSystem::getThreadCount() == 1)
+	{
+		queuedGlyphs.push_back(codepoint);
+		return std::nullopt;
+	}
+
+	JobSystem::submit([codepoint]()
+	{
+		auto pixels = rasterizeGlyph(codepoint);
+		std::scoped_lock lock(finishedMutex);
+		finishedGlyphs.emplace_back(codepoint, std::move(pixels));
+	});
+	return std::nullopt;
+}
+
+std::vector<GlyphCache::Upload> GlyphCache::takeUploads(std::uint32_t budget)
+{
+	enableWhenLoaded();
+
+	constexpr std::uint32_t mainThreadBudget{2};
+	for(std::uint32_t i = 0; i < mainThreadBudget && !queuedGlyphs.empty(); i++)
+	{
+		auto pixels = rasterizeGlyph(queuedGlyphs.front());
+		std::scoped_lock lock(finishedMutex);
+		finishedGlyphs.emplace_back(queuedGlyphs.front(), std::move(pixels));
+		queuedGlyphs.pop_front();
+	}
+
+	std::vector<std::pair<std::uint32_t, std::vector<std::uint8_t>>> finished;
+	{
+		std::scoped_lock lock(finishedMutex);
+		auto count = std::min<std::size_t>(budget, finishedGlyphs.size());
+		finished.assign(std::make_move_iterator(finishedGlyphs.begin()), std::make_move_iterator(finishedGlyphs.begin() + count));
+		finishedGlyphs.erase(finishedGlyphs.begin(), finishedGlyphs.begin() + count);
+	}
+
+	std::vector<Upload> uploads;
+	uploads.reserve(finished.size());
+	for(auto& [codepoint, pixels] : finished)
+	{
+		//Empty slots were never used, so they go first, slots drawn this frame are never overwritten
+		auto slot = std::ranges::min_element(slots, {}, &Slot::lastUsedFrame);
+		if(slot->lastUsedFrame == currentFrame)
+		{
+			std::scoped_lock lock(finishedMutex);
+			finishedGlyphs.emplace_back(codepoint, std::move(pixels));
+			continue;
+		}
+
+		if(slot->codepoint)
+			residentGlyphs.erase(*slot->codepoint);
+		slot->codepoint = codepoint;
+		slot->lastUsedFrame = currentFrame;
+
+		auto slotIndex = static_cast<std::uint32_t>(slot - slots.begin());
+		residentGlyphs[codepoint] = slotIndex;
+		pendingGlyphs.erase(codepoint);
+		uploads.push_back(Upload{slotIndex, std::move(pixels)});
+	}
+
+	currentFrame++;
+	return uploads;
+}
+
+std::vector<GlyphRect> GlyphCache::getSlotRects()
+{
+	std::vector<GlyphRect> rects;
+	rects.reserve(slotCount);
+	glm::vec2 textureSize{textureWidth, textureHeight};
+	for(std::uint32_t slot = 0; slot < slotCount; slot++)
+	{
+		glm::vec2 position{getSlotX(slot), getSlotY(slot)};
+		rects.push_back(GlyphRect{position / textureSize, (position + glm::vec2{cellWidth, cellHeight}) / textureSize, {0.0f, 0.0f}, {1.0f, 1.0f}, 1});
+	}
+	return rects;
+}
+
+bool GlyphCache::getHasFinishedGlyphs()
+{
+	//Frames keep coming until the font arrived, so glyphs waiting for it get requested
+	if(!isEnabled && fontHandle.getIsValid())
+		return true;
+
+	std::scoped_lock lock(finishedMutex);
+	return !finishedGlyphs.empty() || !queuedGlyphs.empty();
+}
+
+void GlyphCache::enableWhenLoaded()
+{
+	if(isEnabled || !fontHandle.getIsValid() || AssetManager::getState(fontHandle) == AssetState::loading)
+		return;
+
+	auto font = AssetManager::get(fontHandle);
+	if(!font)
+	{
+		Logger::logInfo(std::format("Glyph cache font {} not found, showing placeholders for glyphs outside the tile atlas", fontName));
+		AssetManager::unload(fontHandle);
+		fontHandle = {};
+		return;
+	}
+
+	auto const* fontData = font->data.data();
+	if(!stbtt_InitFont(&fontInfo, fontData, stbtt_GetFontOffsetForIndex(fontData, 0)))
+	{
+		Logger::logInfo(std::format("Failed to read glyph cache font {}, showing placeholders for glyphs outside the tile atlas", fontName));
+		AssetManager::unload(fontHandle);
+		fontHandle = {};
+		return;
+	}
+
+	//Fit the font between ascent and descent into the cell like the tile atlas does
+	int ascent{}, descent{}, lineGap{};
+	stbtt_GetFontVMetrics(&fontInfo, &ascent, &descent, &lineGap);
+	scale = stbtt_ScaleForPixelHeight(&fontInfo, float(cellHeight - 2 * padding));
+	baseline = int(padding) + int(std::round(ascent * scale));
+
+	isEnabled = true;
+	Logger::logInfo(std::format("Glyph cache using {} with {} pages of {} cells", fontName, pageCount, slotsPerPage));
+}
+
+std::vector<std::uint8_t> GlyphCache::rasterizeGlyph(std::uint32_t codepoint)
+{
+	std::vector<std::uint8_t> pixels(cellSize);
+
+	//Shrink glyphs that would overflow the cell
+	int x0{}, y0{}, x1{}, y1{};
+	stbtt_GetCodepointBitmapBox(&fontInfo, codepoint, scale, scale, &x0, &y0, &x1, &y1);
+	auto glyphScale = scale;
+	int innerWidth = cellWidth - 2 * padding, innerHeight = cellHeight - 2 * padding;
+	if(x1 - x0 > innerWidth || y1 - y0 > innerHeight)
+		glyphScale *= std::min(float(innerWidth) / (x1 - x0), float(innerHeight) / (y1 - y0));
+
+	int width{}, height{}, xOffset{}, yOffset{};
+	auto sdfData = stbtt_GetCodepointSDF(&fontInfo, glyphScale, codepoint, padding, 128, 128.0f / padding, &width, &height, &xOffset, &yOffset);
+	if(!sdfData)
+		return pixels;
+
+	//Center horizontally and sit on the baseline, unless that pushes the glyph out of the cell
+	auto copyWidth = std::min(width, int(cellWidth));
+	auto copyHeight = std::min(height, int(cellHeight));
+	int left = (int(cellWidth) - copyWidth) / 2;
+	int top = std::clamp(baseline + yOffset, 0, int(cellHeight) - copyHeight);
+	for(int y = 0; y < copyHeight; y++)
+		std::memcpy(pixels.data() + (top + y) * cellWidth + left, sdfData + y * width, copyWidth);
+
+	stbtt_FreeSDF(sdfData, nullptr);
+	return pixels;
+}
@@ -0,0 +1,78 @@
+module;
+
+#include <stb/stb_truetype.h>
+
+export module GlyphCache;
+
+export import std;
+export import GlyphAtlas;
+import AssetManager;
+
+//Glyphs outside the tile atlas, rasterized as sdf on worker threads on first use and kept in fixed size cells of atlas pages
+export class GlyphCache
+{
+public:
+	static constexpr std::uint32_t cellWidth{32}, cellHeight{64}, padding{4};
+	static constexpr std::uint32_t pageWidth{512}, pageHeight{512}, pageCount{4};
+	static constexpr std::uint32_t cellsPerRow{pageWidth / cellWidth};
+	static constexpr std::uint32_t slotsPerPage{cellsPerRow * (pageHeight / cellHeight)};
+	static constexpr std::uint32_t slotCount{slotsPerPage * pageCount};
+	//Pages are stacked vertically in one texture
+	static constexpr std::uint32_t textureWidth{pageWidth}, textureHeight{pageHeight * pageCount};
+	static constexpr std::uint32_t cellSize{cellWidth * cellHeight};
+
+	//Set on quad glyphs holding a codepoint instead of a tile atlas index
+	static constexpr std::uint32_t codepointFlag{0x80000000};
+	//Tile atlas glyph drawn until the glyph is resident
+	static constexpr std::uint32_t placeholderGlyph{254};
+
+	struct Upload
+	{
+		std::uint32_t slot{};
+		std::vector<std::uint8_t> pixels;
+	};
+
+	//The font streams in while the first frames draw placeholders, without it every glyph stays a placeholder
+	static bool init(std::string_view fontPath);
+	static void release();
+
+	//Slot of a resident glyph marked as used this frame, otherwise queues rasterization once and returns nothing
+	static std::optional<std::uint32_t> findGlyph(std::uint32_t codepoint);
+	//Places finished glyphs into free slots or ones not used this frame, least recently used first, and starts a new frame
+	static std::vector<Upload> takeUploads(std::uint32_t budget);
+
+	//Rects of all slots, constant since cells never move
+	static std::vector<GlyphRect> getSlotRects();
+	static std::uint32_t getSlotX(std::uint32_t slot) { return slot % cellsPerRow * cellWidth; }
+	static std::uint32_t getSlotY(std::uint32_t slot) { return slot / cellsPerRow * cellHeight; }
+
+	[[nodiscard]] static bool getHasFinishedGlyphs();
+
+private:
+	struct Slot
+	{
+		std::optional<std::uint32_t> codepoint;
+		std::uint64_t lastUsedFrame;
+	};
+
+	static void enableWhenLoaded();
+	static std::vector<std::uint8_t> rasterizeGlyph(std::uint32_t codepoint);
+
+	inline static bool isEnabled{};
+	inline static std::string fontName;
+	inline static AssetHandle<Asset> fontHandle;
+	inline static stbtt_fontinfo fontInfo;
+	inline static float scale{};
+	inline static int baseline{};
+
+	//Only touched by the main thread
+	inline static std::array<Slot, slotCount> slots{};
+	inline static std::unordered_map<std::uint32_t, std::uint32_t> residentGlyphs;
+	inline static std::unordered_set<std::uint32_t> pendingGlyphs;
+	inline static std::deque<std::uint32_t> queuedGlyphs;
+	inline static std::uint64_t currentFrame{1};
+
+	//Filled by workers
+	inline static std::mutex finishedMutex;
+	inline static std::vector<std::pair<std::uint32_t, std::vector<std::uint8_t>>> finishedGlyphs;
+};
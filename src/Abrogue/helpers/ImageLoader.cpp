@@ -5,15 +5,70 @@ module;
 
 module ImageLoader;
 
+import Configuration;
+import Logger;
+import AssetPack;
+
+//Bumped whenever decoding changes, cache files of other versions are decoded again and overwritten
+constexpr std::uint32_t cacheVersion{1};
+constexpr std::array<char, 4> cacheMagic{'A', 'R', 'A', 'W'};
+constexpr std::size_t cacheHeaderSize{24};
+
+//FNV-1a
+std::uint64_t hashBytes(std::span<std::uint8_t const> bytes)
+{
+	std::uint64_t hash{0xcbf29ce484222325};
+	for(auto byte : bytes)
+	{
+		hash ^= byte;
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
 ImageLoader::ImageLoader(std::string_view filePath)
 {
-	data = stbi_load(filePath.data(), &width, &height, &channels, STBI_grey);
+	auto asset = AssetPack::load(filePath);
+	if(asset.data.empty())
+		return;
+
+	if(filePath.ends_with(".ktx2"))
+	{
+		if(!loadKTX2(asset.data))
+		{
+			levels.clear();
+			return;
+		}
+		mappedFile = std::move(asset.looseFile);
+		return;
+	}
+
+	auto cachePath = std::format("{}/{:016x}.raw", Configuration::textureCacheDirectory, hashBytes(asset.data));
+	if(loadCached(cachePath))
+	{
+		isFromCache = true;
+		return;
+	}
+
+	//Color images are multi-channel sdf, alpha is expanded for them since three channel formats are rarely sampleable
+	int fileChannels{};
+	if(!stbi_info_from_memory(asset.data.data(), (int)asset.data.size(), &width, &height, &fileChannels))
+		return;
+	format = fileChannels >= 3 ? ImageFormat::rgba8 : ImageFormat::r8;
+	channels = format == ImageFormat::rgba8 ? 4 : 1;
+
+	data = stbi_load_from_memory(asset.data.data(), (int)asset.data.size(), &width, &height, &fileChannels, channels);
+	if(!data)
+		return;
+	isDecoded = true;
+	levels.emplace_back(0, (std::size_t)width * height * channels, (std::uint32_t)width, (std::uint32_t)height);
+	writeCache(cachePath);
 }
 
 ImageLoader::~ImageLoader()
 {
-	if(data)
-		stbi_image_free(data);
+	if(isDecoded)
+		stbi_image_free(const_cast<std::uint8_t*>(data));
 }
 
 ImageLoader::ImageLoader(ImageLoader&& rhs)
@@ -26,6 +81,113 @@ ImageLoader& ImageLoader::operator=(ImageLoader&& rhs)
 	std::swap(width, rhs.width);
 	std::swap(height, rhs.height);
 	std::swap(channels, rhs.channels);
+	std::swap(format, rhs.format);
+	std::swap(levels, rhs.levels);
 	std::swap(data, rhs.data);
+	std::swap(isFromCache, rhs.isFromCache);
+	std::swap(mappedFile, rhs.mappedFile);
+	std::swap(isDecoded, rhs.isDecoded);
 	return *this;
 }
+
+bool ImageLoader::loadKTX2(std::span<std::uint8_t const> fileData)
+{
+	constexpr std::array<std::uint8_t, 12> identifier{0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+	constexpr std::size_t headerSize{80}, levelIndexEntrySize{24};
+	//VK_FORMAT_R8_UNORM, VK_FORMAT_BC4_UNORM_BLOCK and VK_FORMAT_R8G8B8A8_UNORM
+	constexpr std::uint32_t r8Format{9}, bc4Format{139}, rgba8Format{37};
+
+	if(fileData.size() < headerSize || !std::equal(identifier.begin(), identifier.end(), fileData.begin()))
+		return false;
+
+	auto vkFormat = readValue<std::uint32_t>(fileData, 12);
+	auto pixelDepth = readValue<std::uint32_t>(fileData, 28);
+	auto layerCount = readValue<std::uint32_t>(fileData, 32);
+	auto faceCount = readValue<std::uint32_t>(fileData, 36);
+	auto levelCount = readValue<std::uint32_t>(fileData, 40);
+	auto supercompressionScheme = readValue<std::uint32_t>(fileData, 44);
+	if((vkFormat != r8Format && vkFormat != bc4Format && vkFormat != rgba8Format) || pixelDepth > 1 || layerCount > 1 || faceCount != 1 || levelCount == 0 || supercompressionScheme != 0)
+		return false;
+	if(fileData.size() < headerSize + levelIndexEntrySize * levelCount)
+		return false;
+
+	auto fileWidth = readValue<std::uint32_t>(fileData, 20);
+	auto fileHeight = readValue<std::uint32_t>(fileData, 24);
+	//Uploads copy whole levels of the stated size, so every level has to hold exactly that many texels or blocks
+	if(fileWidth == 0 || fileHeight == 0 || fileWidth > (std::uint32_t)std::numeric_limits<int>::max() || fileHeight > (std::uint32_t)std::numeric_limits<int>::max() ||
+	   levelCount > (std::uint32_t)std::bit_width(std::max(fileWidth, fileHeight)))
+		return false;
+
+	format = vkFormat == bc4Format ? ImageFormat::bc4 : vkFormat == rgba8Format ? ImageFormat::rgba8 : ImageFormat::r8;
+	width = (int)fileWidth;
+	height = (int)fileHeight;
+	channels = format == ImageFormat::rgba8 ? 4 : 1;
+
+	for(std::uint32_t i = 0; i < levelCount; i++)
+	{
+		auto entryOffset = headerSize + levelIndexEntrySize * i;
+		ImageLevel level{readValue<std::uint64_t>(fileData, entryOffset), readValue<std::uint64_t>(fileData, entryOffset + 8),
+						 std::max(fileWidth >> i, 1u), std::max(fileHeight >> i, 1u)};
+		//BC4 stores 8 bytes per block of 4x4 texels, partial blocks at the edges included
+		auto expectedSize = format == ImageFormat::bc4 ? (std::size_t)((level.width + 3) / 4) * ((level.height + 3) / 4) * 8
+													   : (std::size_t)level.width * level.height * channels;
+		if(level.size != expectedSize || level.offset > fileData.size() || level.size > fileData.size() - level.offset)
+			return false;
+		levels.push_back(level);
+	}
+
+	data = fileData.data();
+	return true;
+}
+
+bool ImageLoader::loadCached(std::string_view cachePath)
+{
+	MappedFile file(cachePath);
+	auto fileData = file.getData();
+	if(fileData.size() < cacheHeaderSize || !std::equal(cacheMagic.begin(), cacheMagic.end(), fileData.begin()))
+		return false;
+
+	auto version = readValue<std::uint32_t>(fileData, 4);
+	auto cachedFormat = readValue<std::uint32_t>(fileData, 8);
+	auto cachedWidth = readValue<std::uint32_t>(fileData, 12);
+	auto cachedHeight = readValue<std::uint32_t>(fileData, 16);
+	auto cachedChannels = readValue<std::uint32_t>(fileData, 20);
+	if(version != cacheVersion || (cachedFormat != (std::uint32_t)ImageFormat::r8 && cachedFormat != (std::uint32_t)ImageFormat::rgba8))
+		return false;
+	//Files cut short by an interrupted write are decoded again
+	std::size_t pixelSize = (std::size_t)cachedWidth * cachedHeight * cachedChannels;
+	if(fileData.size() != cacheHeaderSize + pixelSize)
+		return false;
+
+	format = ImageFormat(cachedFormat);
+	width = cachedWidth;
+	height = cachedHeight;
+	channels = cachedChannels;
+	levels.emplace_back(cacheHeaderSize, pixelSize, cachedWidth, cachedHeight);
+	data = fileData.data();
+	mappedFile = std::move(file);
+	return true;
+}
+
+void ImageLoader::writeCache(std::string_view cachePath) const
+{
+	//Written to a temporary file first so a cache file is either complete or missing
+	std::error_code error;
+	std::filesystem::create_directories(Configuration::textureCacheDirectory, error);
+	auto temporaryPath = std::string(cachePath) + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::out | std::ios::trunc);
+		std::array<std::uint32_t, 5> header{cacheVersion, (std::uint32_t)format, (std::uint32_t)width, (std::uint32_t)height, (std::uint32_t)channels};
+		file.write(cacheMagic.data(), cacheMagic.size());
+		file.write(reinterpret_cast<char const*>(header.data()), sizeof(header));
+		file.write(reinterpret_cast<char const*>(data), levels.front().size);
+		if(!file)
+		{
+			Logger::logError(std::format("Failed to write texture cache {}", cachePath));
+			return;
+		}
+	}
+	std::filesystem::rename(temporaryPath, cachePath, error);
+	if(error)
+		Logger::logError(std::format("Failed to write texture cache {}: {}", cachePath, error.message()));
+}
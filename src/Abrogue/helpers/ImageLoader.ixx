@@ -1,7 +1,24 @@
 export module ImageLoader;
 
 export import std;
+import MappedFile;
 
+export enum class ImageFormat
+{
+	r8,
+	bc4,
+	//Multi-channel sdf
+	rgba8
+};
+
+export struct ImageLevel
+{
+	std::size_t offset{}, size{};
+	std::uint32_t width{}, height{};
+};
+
+//Loads single channel or multi-channel sdf images, either decoding them or mapping precomputed mip levels from KTX2 files in the asset pack or loose
+//Decoded pixels are kept in a raw cache keyed by the hash of the source file, later loads map them instead of decoding
 export class ImageLoader
 {
 public:
@@ -12,6 +29,17 @@ public:
 	ImageLoader& operator=(ImageLoader&& rhs);
 
 	int width{}, height{}, channels{};
-	std::uint8_t* data{};
-};
+	ImageFormat format{};
+	std::vector<ImageLevel> levels;
+	std::uint8_t const* data{};
+	bool isFromCache{};
 
+private:
+	bool loadKTX2(std::span<std::uint8_t const> fileData);
+	bool loadCached(std::string_view cachePath);
+	void writeCache(std::string_view cachePath) const;
+
+	//Backs data for loose KTX2 files and cache hits, packed data is owned by the pack
+	MappedFile mappedFile;
+	bool isDecoded{};
+};
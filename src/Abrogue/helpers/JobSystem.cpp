@@ -0,0 +1,89 @@
+module JobSystem;
+
+import Logger;
+
+bool JobSystem::init()
+{
+	//Main thread takes part in parallel work, so leave one core for it
+	auto workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+	workers.reserve(workerCount);
+	for(std::uint32_t i = 0; i < workerCount; i++)
+		workers.emplace_back(workerLoop, i + 1);
+
+	Logger::logInfo(std::format("Started {} worker threads", workerCount));
+	return true;
+}
+
+void JobSystem::release()
+{
+	for(auto& worker : workers)
+		worker.request_stop();
+	queueCondition.notify_all();
+	workers.clear();
+}
+
+void JobSystem::submit(std::function<void()> job)
+{
+	{
+		std::scoped_lock lock(queueMutex);
+		jobs.emplace_back(std::move(job));
+	}
+	queueCondition.notify_one();
+}
+
+void JobSystem::parallelFor(std::size_t count, std::function<void(std::size_t index)> const& function)
+{
+	if(count == 0)
+		return;
+
+	//Helpers may start after all indices are taken, shared state keeps them from touching anything that's gone by then
+	struct State
+	{
+		std::atomic<std::size_t> nextIndex{};
+		std::atomic<std::size_t> completedCount{};
+		std::size_t count{};
+		std::function<void(std::size_t index)> const* function{};
+	};
+	auto state = std::make_shared<State>();
+	state->count = count;
+	state->function = &function;
+
+	auto runIndices = [](State& state)
+	{
+		for(auto i = state.nextIndex++; i < state.count; i = state.nextIndex++)
+		{
+			(*state.function)(i);
+			state.completedCount.fetch_add(1, std::memory_order_release);
+		}
+	};
+
+	auto helperCount = std::min(workers.size(), count - 1);
+	for(std::size_t i = 0; i < helperCount; i++)
+		submit([state, runIndices]() { runIndices(*state); });
+
+	runIndices(*state);
+
+	//Remaining indices are already running on workers
+	while(state->completedCount.load(std::memory_order_acquire) < count)
+		std::this_thread::yield();
+}
+
+void JobSystem::workerLoop(std::stop_token stopToken, std::uint32_t index)
+{
+	threadIndex = index;
+
+	while(true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock lock(queueMutex);
+			if(!queueCondition.wait(lock, stopToken, []() { return !jobs.empty(); }))
+				return;
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		job();
+	}
+}
@@ -0,0 +1,29 @@
+export module JobSystem;
+
+export import std;
+
+export class JobSystem
+{
+public:
+	static bool init();
+	static void release();
+
+	//Runs job on a worker thread
+	static void submit(std::function<void()> job);
+	//Runs function for every index in [0, count) on workers and the calling thread, returns when all are done
+	static void parallelFor(std::size_t count, std::function<void(std::size_t index)> const& function);
+
+	//0 for the main thread, workers are numbered from 1
+	[[nodiscard]] static std::uint32_t getThreadIndex() { return threadIndex; }
+	[[nodiscard]] static std::uint32_t getThreadCount() { return static_cast<std::uint32_t>(workers.size()) + 1; }
+
+private:
+	static void workerLoop(std::stop_token stopToken, std::uint32_t index);
+
+	inline static std::vector<std::jthread> workers;
+	inline static std::mutex queueMutex;
+	inline static std::condition_variable_any queueCondition;
+	inline static std::deque<std::function<void()>> jobs;
+
+	inline static thread_local std::uint32_t threadIndex{};
+};
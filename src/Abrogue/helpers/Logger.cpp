@@ -22,17 +22,21 @@ bool Logger::init()
 void Logger::logError(std::string_view message)
 {
 	auto stackTrace = std::stacktrace::current();
-	std::println(errorLog, "Error: {}\nStacktrace:\n{}", message, stackTrace);
-	errorLog.flush();
+	{
+		std::scoped_lock lock(logMutex);
+		std::println(errorLog, "Error: {}\nStacktrace:\n{}", message, stackTrace);
+		errorLog.flush();
 
-	if constexpr(isDebugBuild)
-		std::println(std::cerr, "Error: {}\nStacktrace:\n{}", message, stackTrace);
+		if constexpr(isDebugBuild)
+			std::println(std::cerr, "Error: {}\nStacktrace:\n{}", message, stackTrace);
+	}
 
 	displayErrorMessage(message.data() + "\nCheck the error log for details. Esc to exit"s);
 }
 
 void Logger::logInfo(std::string_view message)
 {
+	std::scoped_lock lock(logMutex);
 	std::println(infoLog, "{}", message);
 	infoLog.flush();
 
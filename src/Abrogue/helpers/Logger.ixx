@@ -13,6 +13,8 @@ public:
 private:
 	static void displayErrorMessage(std::string_view message);
 
+	//Workers log too
+	inline static std::mutex logMutex;
 	inline static std::ofstream infoLog;
 	inline static std::ofstream errorLog;
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+module;
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+module MappedFile;
+
+MappedFile::MappedFile(std::string_view filePath)
+{
+	//Empty files can't be mapped and stay closed
+#ifdef _WIN32
+	auto file = CreateFileA(std::string(filePath).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER fileSize{};
+	if(GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		//The view keeps the mapping alive after its handle is closed
+		if(auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr))
+		{
+			if(auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0))
+			{
+				data = static_cast<std::uint8_t const*>(view);
+				size = static_cast<std::size_t>(fileSize.QuadPart);
+			}
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#else
+	auto file = open(std::string(filePath).c_str(), O_RDONLY);
+	if(file < 0)
+		return;
+
+	struct stat fileStatus{};
+	if(fstat(file, &fileStatus) == 0 && fileStatus.st_size > 0)
+	{
+		auto view = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if(view != MAP_FAILED)
+		{
+			data = static_cast<std::uint8_t const*>(view);
+			size = static_cast<std::size_t>(fileStatus.st_size);
+		}
+	}
+	close(file);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	release();
+}
+
+MappedFile::MappedFile(MappedFile&& rhs)
+{
+	*this = std::move(rhs);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs)
+{
+	std::swap(data, rhs.data);
+	std::swap(size, rhs.size);
+	return *this;
+}
+
+void MappedFile::release()
+{
+	if(!data)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap(const_cast<std::uint8_t*>(data), size);
+#endif
+	data = nullptr;
+	size = 0;
+}
@@ -0,0 +1,32 @@
+export module MappedFile;
+
+export import std;
+
+//Read only view of a whole file mapped into memory, pages are loaded on first access
+export class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(std::string_view filePath);
+	~MappedFile();
+	MappedFile(MappedFile&& rhs);
+	MappedFile& operator=(MappedFile&& rhs);
+
+	[[nodiscard]] std::span<std::uint8_t const> getData() const { return {data, size}; }
+	[[nodiscard]] bool getIsOpen() const { return data != nullptr; }
+
+private:
+	void release();
+
+	std::uint8_t const* data{};
+	std::size_t size{};
+};
+
+//Reads a value stored at any alignment, callers check the bytes are long enough
+export template<class T>
+T readValue(std::span<std::uint8_t const> bytes, std::size_t offset)
+{
+	T value{};
+	std::memcpy(&value, bytes.data() + offset, sizeof(T));
+	return value;
+}
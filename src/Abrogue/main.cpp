@@ -5,6 +5,10 @@
 
 import Logger;
 import Configuration;
+import JobSystem;
+import AssetPack;
+import AssetManager;
+import GlyphCache;
 import Game;
 
 SDL_AppResult SDL_AppInit(void** appstate, int argc, char** argv)
@@ -15,6 +19,18 @@ SDL_AppResult SDL_AppInit(void** appstate, int argc, char** argv)
 	if(!Configuration::init())
 		return SDL_APP_FAILURE;
 
+	if(!Configuration::parseCommandLine(argc, argv))
+		return SDL_APP_FAILURE;
+
+	if(!JobSystem::init())
+		return SDL_APP_FAILURE;
+
+	if(!AssetPack::init(Configuration::assetPackFileName))
+		return SDL_APP_FAILURE;
+
+	if(!GlyphCache::init("fonts/glyphs.ttf"))
+		return SDL_APP_FAILURE;
+
 	if(!Game::init())
 		return SDL_APP_FAILURE;
 
@@ -26,6 +42,9 @@ SDL_AppResult SDL_AppIterate(void* appstate)
 	if(!Game::update())
 		return SDL_APP_FAILURE;
 
+	if(Game::getIsFinished())
+		return SDL_APP_SUCCESS;
+
 	return SDL_APP_CONTINUE;
 }
 
@@ -36,11 +55,16 @@ SDL_AppResult SDL_AppEvent(void* appstate, SDL_Event* event)
 		case SDL_EVENT_QUIT:
 			return SDL_APP_SUCCESS;
 		case SDL_EVENT_KEY_DOWN:
-			Game::onKeyPressed(event->key.scancode);
+			if(!event->key.repeat)
+				Game::onKeyPressed(event->key.scancode);
 			break;
 		case SDL_EVENT_KEY_UP:
 			Game::onKeyReleased(event->key.scancode);
 			break;
+		case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+		case SDL_EVENT_WINDOW_EXPOSED:
+			Game::onWindowChanged();
+			break;
 		default: break;
 	}
 
@@ -50,4 +74,8 @@ SDL_AppResult SDL_AppEvent(void* appstate, SDL_Event* event)
 void SDL_AppQuit(void* appstate, SDL_AppResult result)
 {
 	Game::release();
+	JobSystem::release();
+	GlyphCache::release();
+	AssetManager::release();
+	AssetPack::release();
 }
\ No newline at end of file
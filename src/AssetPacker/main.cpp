@@ -0,0 +1,154 @@
+import std;
+
+using namespace std::literals;
+
+//Must match AssetPack in Abrogue
+constexpr std::array<char, 4> packMagic{'A', 'P', 'A', 'K'};
+constexpr std::uint32_t packVersion{1};
+constexpr std::size_t headerSize{16}, entrySize{24}, alignment{16};
+
+struct PackEntry
+{
+	std::string name;
+	std::vector<char> data;
+	std::uint64_t offset{};
+	std::uint32_t nameOffset{};
+};
+
+template<class T>
+void writeValue(std::ofstream& file, T value)
+{
+	file.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+std::optional<std::vector<char>> readFile(std::filesystem::path const& filePath)
+{
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+	if(!file.is_open())
+		return std::nullopt;
+	std::vector<char> data(file.tellg());
+	file.seekg(0);
+	file.read(data.data(), data.size());
+	if(!file)
+		return std::nullopt;
+	return data;
+}
+
+bool writePack(std::string_view outputFile, std::vector<PackEntry>& entries)
+{
+	//Sorted so packs of the same assets are byte identical
+	std::ranges::sort(entries, {}, &PackEntry::name);
+	if(auto duplicate = std::ranges::adjacent_find(entries, {}, &PackEntry::name); duplicate != entries.end())
+	{
+		std::println("Asset {} is listed twice", duplicate->name);
+		return false;
+	}
+
+	std::string stringTable;
+	for(auto& entry : entries)
+	{
+		entry.nameOffset = static_cast<std::uint32_t>(stringTable.size());
+		stringTable += entry.name;
+	}
+
+	std::uint64_t offset = headerSize + entrySize * entries.size() + stringTable.size();
+	for(auto& entry : entries)
+	{
+		offset = (offset + alignment - 1) / alignment * alignment;
+		entry.offset = offset;
+		offset += entry.data.size();
+	}
+
+	auto temporaryFile = std::string(outputFile) + ".tmp";
+	{
+		std::ofstream file(temporaryFile, std::ios::binary | std::ios::out | std::ios::trunc);
+		file.write(packMagic.data(), packMagic.size());
+		writeValue(file, packVersion);
+		writeValue(file, static_cast<std::uint32_t>(entries.size()));
+		writeValue(file, static_cast<std::uint32_t>(stringTable.size()));
+		for(auto const& entry : entries)
+		{
+			writeValue(file, entry.offset);
+			writeValue(file, static_cast<std::uint64_t>(entry.data.size()));
+			writeValue(file, entry.nameOffset);
+			writeValue(file, static_cast<std::uint32_t>(entry.name.size()));
+		}
+		file.write(stringTable.data(), stringTable.size());
+		for(auto const& entry : entries)
+		{
+			std::vector<char> alignmentPadding(entry.offset - file.tellp());
+			file.write(alignmentPadding.data(), alignmentPadding.size());
+			file.write(entry.data.data(), entry.data.size());
+		}
+		if(!file)
+		{
+			std::println("Failed to write {}", temporaryFile);
+			return false;
+		}
+	}
+
+	//Runs on every build, an identical pack keeps its timestamp so nothing downstream rebuilds
+	std::error_code error;
+	if(readFile(temporaryFile) == readFile(outputFile))
+	{
+		std::filesystem::remove(temporaryFile, error);
+		std::println("{} is up to date", outputFile);
+		return true;
+	}
+	std::filesystem::rename(temporaryFile, outputFile, error);
+	if(error)
+	{
+		std::println("Failed to write {}: {}", outputFile, error.message());
+		return false;
+	}
+
+	std::println("Packed {} assets into {}, {} bytes", entries.size(), outputFile, offset);
+	return true;
+}
+
+auto main(int argc, char** argv) -> int
+{
+	if(argc < 4)
+	{
+		std::println("Usage: AssetPacker <output_file> <root_directory> <asset>... [--optional <asset>...]\n"
+					 "\tAssets are given relative to the root directory and looked up at runtime by that path.\n"
+					 "\tname=file packs a file from anywhere, built shaders for example, looked up by name.\n"
+					 "\tAssets after --optional are skipped when missing.");
+		return 1;
+	}
+
+	std::filesystem::path rootDirectory{argv[2]};
+	std::vector<PackEntry> entries;
+	bool isOptional{};
+	for(int i = 3; i < argc; i++)
+	{
+		std::string_view argument{argv[i]};
+		if(argument == "--optional")
+		{
+			isOptional = true;
+			continue;
+		}
+
+		//Runtime lookups always use forward slashes
+		auto separator = argument.find('=');
+		std::string name{argument.substr(0, separator)};
+		std::ranges::replace(name, '\\', '/');
+		auto filePath = separator != std::string_view::npos ? std::filesystem::path{argument.substr(separator + 1)} : rootDirectory / name;
+
+		if(isOptional && !std::filesystem::exists(filePath))
+		{
+			std::println("Skipping missing optional asset {}", filePath.string());
+			continue;
+		}
+
+		auto data = readFile(filePath);
+		if(!data)
+		{
+			std::println("Failed to read asset {}", filePath.string());
+			return 1;
+		}
+		entries.emplace_back(std::move(name), std::move(*data));
+	}
+
+	return writePack(argv[1], entries) ? 0 : 1;
+}
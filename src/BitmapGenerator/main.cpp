@@ -4,6 +4,9 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb/stb_image_write.h"
 
+#include <json.hpp>
+#include <glm/glm.hpp>
+
 import std;
 
 using namespace std::literals;
@@ -26,35 +29,482 @@ std::array<std::uint64_t, 256> codepoints{
 	0x03b1, 0x00df, 0x0393, 0x03c0, 0x03a3, 0x03c3, 0x00b5, 0x03c4, 0x03a6, 0x0398, 0x03a9, 0x03b4, 0x221e, 0x03c6, 0x03b5, 0x2229,
 	0x2261, 0x00b1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00f7, 0x2248, 0x00b0, 0x2219, 0x00b7, 0x221a, 0x207f, 0x00b2, 0x25a0, 0x00a0};
 
-struct CodepointData
+//Outline segment of a glyph in font units, a line or a quadratic curve through a control point
+struct EdgeSegment
 {
-	CodepointData() = default;
-	CodepointData(stbtt_fontinfo const& fontInfo, float scale, int codepoint, int padding)
+	glm::dvec2 start, control, end;
+	bool isCurve{};
+	//Bit per channel the edge contributes to, red 1, green 2, blue 4
+	std::uint8_t color{7};
+
+	glm::dvec2 getPoint(double t) const
 	{
-		auto pixelStep = padding == 0 ? 128.0f : 128.0f / padding;
-		sdfData = stbtt_GetCodepointSDF(&fontInfo, scale, codepoint, padding, 128, pixelStep, &width, &height, &xOffset, &yOffset);
+		if(!isCurve)
+			return glm::mix(start, end, t);
+		return glm::mix(glm::mix(start, control, t), glm::mix(control, end, t), t);
+	}
+
+	glm::dvec2 getDirection(double t) const
+	{
+		if(!isCurve)
+			return end - start;
+
+		auto direction = glm::mix(control - start, end - control, t);
+		//Control point on top of an endpoint
+		if(direction == glm::dvec2{})
+			return end - start;
+		return direction;
+	}
+
+	std::array<EdgeSegment, 3> splitInThirds() const
+	{
+		std::array<EdgeSegment, 3> parts{};
+		for(int i = 0; i < 3; i++)
+		{
+			double t0 = i / 3.0, t1 = (i + 1) / 3.0;
+			//Control of a sub curve lies along the tangent at its start
+			auto partControl = isCurve ? getPoint(t0) + glm::mix(control - start, end - control, t0) * (t1 - t0) : glm::dvec2{};
+			parts[i] = EdgeSegment{getPoint(t0), partControl, getPoint(t1), isCurve, color};
+		}
+
+		return parts;
+	}
+};
+
+//Signed distance to an edge, ties between edges go to the one the point is least orthogonal to
+struct EdgeDistance
+{
+	double distance{std::numeric_limits<double>::max()};
+	double orthogonality{1.0};
+	//Closest point on the edge, outside [0, 1] past its ends
+	double param{};
+
+	bool operator<(EdgeDistance const& rhs) const
+	{
+		auto distanceLhs = std::abs(distance), distanceRhs = std::abs(rhs.distance);
+		return distanceLhs < distanceRhs || (distanceLhs == distanceRhs && orthogonality < rhs.orthogonality);
+	}
+};
+
+double crossProduct(glm::dvec2 a, glm::dvec2 b)
+{
+	return a.x * b.y - a.y * b.x;
+}
+
+double nonZeroSign(double value)
+{
+	return value > 0.0 ? 1.0 : -1.0;
+}
+
+//Real roots of ax^2 + bx + c
+int solveQuadratic(std::array<double, 3>& roots, double a, double b, double c)
+{
+	if(a == 0.0 || std::abs(b) > 1e12 * std::abs(a))
+	{
+		if(b == 0.0)
+			return 0;
+		roots[0] = -c / b;
+		return 1;
+	}
+
+	auto discriminant = b * b - 4.0 * a * c;
+	if(discriminant > 0.0)
+	{
+		discriminant = std::sqrt(discriminant);
+		roots[0] = (-b + discriminant) / (2.0 * a);
+		roots[1] = (-b - discriminant) / (2.0 * a);
+		return 2;
+	}
+	if(discriminant == 0.0)
+	{
+		roots[0] = -b / (2.0 * a);
+		return 1;
+	}
+	return 0;
+}
+
+//Real roots of ax^3 + bx^2 + cx + d, degrading to a quadratic when a is negligible
+int solveCubic(std::array<double, 3>& roots, double a, double b, double c, double d)
+{
+	if(a == 0.0 || std::abs(b / a) >= 1e6)
+		return solveQuadratic(roots, b, c, d);
+
+	//Cardano on the normed cubic
+	b /= a;
+	c /= a;
+	d /= a;
+	auto q = (b * b - 3.0 * c) / 9.0;
+	auto r = (b * (2.0 * b * b - 9.0 * c) + 27.0 * d) / 54.0;
+	auto q3 = q * q * q;
+	b /= 3.0;
+	if(r * r < q3)
+	{
+		auto angle = std::acos(std::clamp(r / std::sqrt(q3), -1.0, 1.0));
+		auto scale = -2.0 * std::sqrt(q);
+		roots[0] = scale * std::cos(angle / 3.0) - b;
+		roots[1] = scale * std::cos((angle + 2.0 * std::numbers::pi) / 3.0) - b;
+		roots[2] = scale * std::cos((angle - 2.0 * std::numbers::pi) / 3.0) - b;
+		return 3;
+	}
+
+	auto u = (r < 0.0 ? 1.0 : -1.0) * std::cbrt(std::abs(r) + std::sqrt(r * r - q3));
+	auto v = u == 0.0 ? 0.0 : q / u;
+	roots[0] = (u + v) - b;
+	if(u == v || std::abs(u - v) < 1e-12 * std::abs(u + v))
+	{
+		roots[1] = -0.5 * (u + v) - b;
+		return 2;
+	}
+	return 1;
+}
+
+//Distance is positive on the right side of the edge direction
+EdgeDistance getEdgeDistance(EdgeSegment const& edge, glm::dvec2 origin)
+{
+	if(!edge.isCurve)
+	{
+		auto toOrigin = origin - edge.start;
+		auto direction = edge.end - edge.start;
+		auto param = glm::dot(toOrigin, direction) / glm::dot(direction, direction);
+		auto toEndpoint = (param > 0.5 ? edge.end : edge.start) - origin;
+		auto endpointDistance = glm::length(toEndpoint);
+		if(param > 0.0 && param < 1.0)
+		{
+			auto orthogonalDistance = crossProduct(toOrigin, direction) / glm::length(direction);
+			if(std::abs(orthogonalDistance) < endpointDistance)
+				return EdgeDistance{orthogonalDistance, 0.0, param};
+		}
+
+		return EdgeDistance{nonZeroSign(crossProduct(toOrigin, direction)) * endpointDistance,
+							std::abs(glm::dot(glm::normalize(direction), glm::normalize(toEndpoint))), param};
+	}
+
+	//Closest point is where the derivative of squared distance along the curve is zero
+	auto fromOrigin = edge.start - origin;
+	auto firstDifference = edge.control - edge.start;
+	auto secondDifference = edge.end - edge.control - firstDifference;
+	std::array<double, 3> roots{};
+	auto rootCount = solveCubic(roots, glm::dot(secondDifference, secondDifference), 3.0 * glm::dot(firstDifference, secondDifference),
+								2.0 * glm::dot(firstDifference, firstDifference) + glm::dot(fromOrigin, secondDifference), glm::dot(fromOrigin, firstDifference));
+
+	auto startDirection = edge.getDirection(0.0);
+	auto minDistance = nonZeroSign(crossProduct(startDirection, fromOrigin)) * glm::length(fromOrigin);
+	auto param = -glm::dot(fromOrigin, startDirection) / glm::dot(startDirection, startDirection);
+
+	auto endDirection = edge.getDirection(1.0);
+	auto endDistance = glm::length(edge.end - origin);
+	if(endDistance < std::abs(minDistance))
+	{
+		minDistance = nonZeroSign(crossProduct(endDirection, edge.end - origin)) * endDistance;
+		param = glm::dot(origin - edge.control, endDirection) / glm::dot(endDirection, endDirection);
+	}
+
+	for(int i = 0; i < rootCount; i++)
+	{
+		if(roots[i] <= 0.0 || roots[i] >= 1.0)
+			continue;
+
+		auto toCurve = fromOrigin + 2.0 * roots[i] * firstDifference + roots[i] * roots[i] * secondDifference;
+		auto distance = glm::length(toCurve);
+		if(distance <= std::abs(minDistance))
+		{
+			minDistance = nonZeroSign(crossProduct(firstDifference + roots[i] * secondDifference, toCurve)) * distance;
+			param = roots[i];
+		}
+	}
+
+	if(param >= 0.0 && param <= 1.0)
+		return EdgeDistance{minDistance, 0.0, param};
+	if(param < 0.5)
+		return EdgeDistance{minDistance, std::abs(glm::dot(glm::normalize(startDirection), glm::normalize(fromOrigin))), param};
+	return EdgeDistance{minDistance, std::abs(glm::dot(glm::normalize(endDirection), glm::normalize(edge.end - origin))), param};
+}
+
+//Distance to the edge extended along its end tangents, which keeps the channels of neighbouring edges from rounding corners
+double getPseudoDistance(EdgeSegment const& edge, glm::dvec2 origin, EdgeDistance const& edgeDistance)
+{
+	auto distance = edgeDistance.distance;
+	if(edgeDistance.param < 0.0)
+	{
+		auto direction = glm::normalize(edge.getDirection(0.0));
+		auto toOrigin = origin - edge.start;
+		if(glm::dot(toOrigin, direction) < 0.0)
+		{
+			auto pseudoDistance = crossProduct(toOrigin, direction);
+			if(std::abs(pseudoDistance) <= std::abs(distance))
+				distance = pseudoDistance;
+		}
+	}
+	else if(edgeDistance.param > 1.0)
+	{
+		auto direction = glm::normalize(edge.getDirection(1.0));
+		auto toOrigin = origin - edge.end;
+		if(glm::dot(toOrigin, direction) > 0.0)
+		{
+			auto pseudoDistance = crossProduct(toOrigin, direction);
+			if(std::abs(pseudoDistance) <= std::abs(distance))
+				distance = pseudoDistance;
+		}
+	}
+
+	return distance;
+}
+
+//Closed contours of a glyph outline, cubic curves of CFF fonts are approximated with quadratic ones
+std::vector<std::vector<EdgeSegment>> getGlyphContours(stbtt_fontinfo const& fontInfo, int codepoint)
+{
+	stbtt_vertex* vertices{};
+	auto vertexCount = stbtt_GetCodepointShape(&fontInfo, codepoint, &vertices);
+
+	std::vector<std::vector<EdgeSegment>> contours;
+	glm::dvec2 position{}, contourStart{};
+	auto closeContour = [&]()
+	{
+		if(!contours.empty() && position != contourStart)
+			contours.back().push_back(EdgeSegment{position, {}, contourStart});
+	};
+	for(int i = 0; i < vertexCount; i++)
+	{
+		auto const& vertex = vertices[i];
+		glm::dvec2 point{vertex.x, vertex.y};
+		if(vertex.type == STBTT_vmove)
+		{
+			closeContour();
+			contours.emplace_back();
+			contourStart = point;
+		}
+		else if(contours.empty() || (point == position && (vertex.type == STBTT_vline || glm::dvec2{vertex.cx, vertex.cy} == position)))
+		{
+			//Zero length edges have no direction
+		}
+		else if(vertex.type == STBTT_vline)
+			contours.back().push_back(EdgeSegment{position, {}, point});
+		else if(vertex.type == STBTT_vcurve)
+			contours.back().push_back(EdgeSegment{position, {vertex.cx, vertex.cy}, point, true});
+		else if(vertex.type == STBTT_vcubic)
+		{
+			std::array<glm::dvec2, 4> cubic{position, {vertex.cx, vertex.cy}, {vertex.cx1, vertex.cy1}, point};
+			auto getCubicPoint = [&cubic](double t)
+			{
+				auto s = 1.0 - t;
+				return s * s * s * cubic[0] + 3.0 * s * s * t * cubic[1] + 3.0 * s * t * t * cubic[2] + t * t * t * cubic[3];
+			};
+			auto getCubicDirection = [&cubic](double t)
+			{
+				auto s = 1.0 - t;
+				return 3.0 * (s * s * (cubic[1] - cubic[0]) + 2.0 * s * t * (cubic[2] - cubic[1]) + t * t * (cubic[3] - cubic[2]));
+			};
+
+			//Each quarter becomes a quadratic curve whose control averages the two cubic controls
+			constexpr int pieceCount{4};
+			for(int piece = 0; piece < pieceCount; piece++)
+			{
+				double t0 = double(piece) / pieceCount, t1 = double(piece + 1) / pieceCount;
+				auto pieceStart = getCubicPoint(t0), pieceEnd = getCubicPoint(t1);
+				auto control0 = pieceStart + getCubicDirection(t0) * (t1 - t0) / 3.0;
+				auto control1 = pieceEnd - getCubicDirection(t1) * (t1 - t0) / 3.0;
+				contours.back().push_back(EdgeSegment{pieceStart, (3.0 * (control0 + control1) - pieceStart - pieceEnd) / 4.0, pieceEnd, true});
+			}
+		}
+		position = point;
+	}
+	closeContour();
+	stbtt_FreeShape(&fontInfo, vertices);
+
+	std::erase_if(contours, [](auto const& contour) { return contour.empty(); });
+	return contours;
+}
+
+//Give edges meeting at a corner different channel pairs, so that the corner survives in the median of the channels
+void colorEdges(std::vector<std::vector<EdgeSegment>>& contours)
+{
+	constexpr std::uint8_t white{7}, cyan{6}, magenta{5}, yellow{3};
+	//Sine of the angle below which a joint counts as a corner
+	const double cornerThreshold = std::sin(3.0);
+
+	//Cycles cyan, magenta, yellow, avoiding a banned color for the last edge run of a contour
+	auto switchColor = [](std::uint8_t color, std::uint8_t banned = 0) -> std::uint8_t
+	{
+		auto combined = std::uint8_t(color & banned);
+		if(combined == 1 || combined == 2 || combined == 4)
+			return combined ^ white;
+		if(color == white)
+			return cyan;
+		auto shifted = color << 1;
+		return (shifted | shifted >> 3) & white;
+	};
+
+	for(auto& contour : contours)
+	{
+		std::vector<std::size_t> corners;
+		for(std::size_t i = 0; i < contour.size(); i++)
+		{
+			auto previous = glm::normalize(contour[(i + contour.size() - 1) % contour.size()].getDirection(1.0));
+			auto next = glm::normalize(contour[i].getDirection(0.0));
+			if(glm::dot(previous, next) <= 0.0 || std::abs(crossProduct(previous, next)) > cornerThreshold)
+				corners.push_back(i);
+		}
+
+		if(corners.empty())
+		{
+			for(auto& edge : contour)
+				edge.color = white;
+		}
+		else if(corners.size() == 1)
+		{
+			//Teardrop, spread three colors over the edges starting at the corner, splitting edges if there are too few
+			if(contour.size() < 3)
+			{
+				std::vector<EdgeSegment> parts;
+				for(std::size_t i = 0; i < contour.size(); i++)
+				{
+					auto split = contour[(corners[0] + i) % contour.size()].splitInThirds();
+					parts.insert(parts.end(), split.begin(), split.end());
+				}
+				contour = std::move(parts);
+				corners[0] = 0;
+			}
+
+			std::array<std::uint8_t, 3> colors{cyan, white, magenta};
+			auto edgeCount = contour.size();
+			for(std::size_t i = 0; i < edgeCount; i++)
+				contour[(corners[0] + i) % edgeCount].color = colors[int(3.0 + 2.875 * i / (edgeCount - 1) - 1.4375 + 0.5) - 2];
+		}
+		else
+		{
+			//Switch color at each corner, the last run must differ from the first one it meets
+			std::uint8_t color = switchColor(white);
+			auto initialColor = color;
+			std::size_t spline{};
+			for(std::size_t i = 0; i < contour.size(); i++)
+			{
+				auto index = (corners[0] + i) % contour.size();
+				if(spline + 1 < corners.size() && corners[spline + 1] == index)
+				{
+					spline++;
+					color = switchColor(color, spline == corners.size() - 1 ? initialColor : 0);
+				}
+				contour[index].color = color;
+			}
+		}
+	}
+}
+
+//Multi-channel sdf with the true distance in alpha, laid out and encoded like stbtt_GetCodepointSDF output
+std::vector<unsigned char> generateMSDF(stbtt_fontinfo const& fontInfo, float scale, int codepoint, int padding, float pixelStep,
+										int& width, int& height, int& xOffset, int& yOffset)
+{
+	constexpr int channelCount{4};
+
+	int x0{}, y0{}, x1{}, y1{};
+	stbtt_GetCodepointBitmapBox(&fontInfo, codepoint, scale, scale, &x0, &y0, &x1, &y1);
+	auto contours = getGlyphContours(fontInfo, codepoint);
+	if(x0 == x1 || y0 == y1 || contours.empty())
+	{
+		width = height = xOffset = yOffset = 0;
+		return {};
 	}
-	~CodepointData()
+	xOffset = x0 - padding;
+	yOffset = y0 - padding;
+	width = x1 - x0 + 2 * padding;
+	height = y1 - y0 + 2 * padding;
+
+	colorEdges(contours);
+
+	//Distances are positive to the right of edges, flip them when outer contours run counterclockwise so insides stay positive
+	double area{};
+	for(auto const& contour : contours)
 	{
-		if(sdfData)
-			stbtt_FreeSDF(sdfData, nullptr);
+		for(auto const& edge : contour)
+		{
+			area += crossProduct(edge.start, edge.isCurve ? edge.control : edge.end);
+			if(edge.isCurve)
+				area += crossProduct(edge.control, edge.end);
+		}
 	}
-	CodepointData(CodepointData&& rhs)
+	auto orientation = area > 0.0 ? -1.0 : 1.0;
+
+	auto encode = [&](double distance)
+	{
+		return (unsigned char)std::clamp(128.0 + orientation * distance * scale * pixelStep, 0.0, 255.0);
+	};
+
+	std::vector<unsigned char> pixels((std::size_t)width * height * channelCount);
+	for(int y = 0; y < height; y++)
 	{
-		*this = std::move(rhs);
+		for(int x = 0; x < width; x++)
+		{
+			//Pixel centers in font units, y pointing up
+			glm::dvec2 origin{(xOffset + x + 0.5) / scale, -(yOffset + y + 0.5) / scale};
+
+			EdgeDistance closest{};
+			std::array<EdgeDistance, 3> channelClosest{};
+			std::array<EdgeSegment const*, 3> channelEdges{};
+			for(auto const& contour : contours)
+			{
+				for(auto const& edge : contour)
+				{
+					auto edgeDistance = getEdgeDistance(edge, origin);
+					if(edgeDistance < closest)
+						closest = edgeDistance;
+
+					for(int channel = 0; channel < 3; channel++)
+					{
+						if((edge.color & 1 << channel) && edgeDistance < channelClosest[channel])
+						{
+							channelClosest[channel] = edgeDistance;
+							channelEdges[channel] = &edge;
+						}
+					}
+				}
+			}
+
+			std::array<double, 3> channelDistances{};
+			for(int channel = 0; channel < 3; channel++)
+			{
+				channelDistances[channel] = channelEdges[channel] ? getPseudoDistance(*channelEdges[channel], origin, channelClosest[channel]) : closest.distance;
+			}
+
+			//Channels disagreeing with the true distance about the inside would show as artifacts, use the true distance there instead
+			auto median = std::max(std::min(channelDistances[0], channelDistances[1]), std::min(std::max(channelDistances[0], channelDistances[1]), channelDistances[2]));
+			if((median > 0.0) != (closest.distance > 0.0))
+				channelDistances.fill(closest.distance);
+
+			auto pixel = pixels.data() + ((std::size_t)x + (std::size_t)y * width) * channelCount;
+			for(int channel = 0; channel < 3; channel++)
+				pixel[channel] = encode(channelDistances[channel]);
+			pixel[3] = encode(closest.distance);
+		}
 	}
-	CodepointData& operator=(CodepointData&& rhs)
+
+	return pixels;
+}
+
+struct CodepointData
+{
+	CodepointData() = default;
+	CodepointData(stbtt_fontinfo const& fontInfo, float scale, int codepoint, int padding, bool multiChannel)
 	{
-		std::swap(width, rhs.width);
-		std::swap(height, rhs.height);
-		std::swap(xOffset, rhs.xOffset);
-		std::swap(yOffset, rhs.yOffset);
-		std::swap(sdfData, rhs.sdfData);
-		return *this;
+		auto pixelStep = padding == 0 ? 128.0f : 128.0f / padding;
+		if(multiChannel)
+		{
+			sdfData = generateMSDF(fontInfo, scale, codepoint, padding, pixelStep, width, height, xOffset, yOffset);
+			channelCount = 4;
+			return;
+		}
+
+		auto stbData = stbtt_GetCodepointSDF(&fontInfo, scale, codepoint, padding, 128, pixelStep, &width, &height, &xOffset, &yOffset);
+		if(stbData)
+		{
+			sdfData.assign(stbData, stbData + width * height);
+			stbtt_FreeSDF(stbData, nullptr);
+		}
 	}
 
 	int width{}, height{}, xOffset{}, yOffset{};
-	unsigned char* sdfData{};
+	int channelCount{1};
+	//Interleaved channels, rgb hold the multi-channel distance and alpha the true one
+	std::vector<unsigned char> sdfData;
 };
 
 struct FontData
@@ -67,207 +517,978 @@ struct FontData
 	std::array<CodepointData, codepoints.size()> codepointData{};
 };
 
+//Extents of the glyphs processed by a single worker
+struct GlyphExtents
+{
+	int maxWidth{}, maxHeight{};
+	std::uint32_t leftOffset{}, upOffset{};
+};
+
+//Generate sdf data of all codepoints in parallel, stops early and returns false once a glyph exceeds tile size
+bool generateCodepointData(FontData& fontData, stbtt_fontinfo const& fontInfo, float scale, std::int32_t tileWidth, std::int32_t tileHeight, int padding,
+						   bool multiChannel, std::uint32_t workerCount)
+{
+	std::vector<GlyphExtents> workerExtents(workerCount);
+	std::atomic<std::size_t> nextIndex{};
+	std::atomic<bool> glyphExceeded{};
+
+	{
+		std::vector<std::jthread> workers;
+		for(std::uint32_t worker = 0; worker < workerCount; worker++)
+		{
+			workers.emplace_back([&, worker]()
+			{
+				auto& extents = workerExtents[worker];
+				for(auto i = nextIndex++; i < codepoints.size() && !glyphExceeded; i = nextIndex++)
+				{
+					auto& data = fontData.codepointData[i];
+					data = CodepointData(fontInfo, scale, codepoints[i], padding, multiChannel);
+
+					int horizontalExtent = data.xOffset + padding;
+					auto totalWidth = data.width + std::abs(horizontalExtent);
+					if(horizontalExtent < 0 && std::abs(horizontalExtent) > extents.leftOffset)
+						extents.leftOffset = std::abs(horizontalExtent);
+
+					int verticalExtent = fontData.ascent + data.yOffset + padding;
+					auto totalHeight = data.height + std::abs(verticalExtent);
+					if(verticalExtent < 0 && std::abs(verticalExtent) > extents.upOffset)
+						extents.upOffset = std::abs(verticalExtent);
+
+					if(totalWidth > tileWidth - 2 || totalHeight > tileHeight - 2)
+					{
+						glyphExceeded = true;
+						break;
+					}
+
+					if(totalWidth > extents.maxWidth)
+						extents.maxWidth = totalWidth;
+					if(totalHeight > extents.maxHeight)
+						extents.maxHeight = totalHeight;
+				}
+			});
+		}
+	}
+
+	if(glyphExceeded)
+		return false;
+
+	for(auto& extents : workerExtents)
+	{
+		fontData.maxWidth = std::max(fontData.maxWidth, extents.maxWidth);
+		fontData.maxHeight = std::max(fontData.maxHeight, extents.maxHeight);
+		fontData.leftOffset = std::max(fontData.leftOffset, extents.leftOffset);
+		fontData.upOffset = std::max(fontData.upOffset, extents.upOffset);
+	}
+
+	return true;
+}
+
+//Font data of given size with vertical metrics filled in
+FontData createFontData(stbtt_fontinfo const& fontInfo, std::uint32_t size)
+{
+	FontData fontData{};
+	fontData.size = size;
+
+	auto scale = stbtt_ScaleForPixelHeight(&fontInfo, (float)size);
+
+	stbtt_GetFontVMetrics(&fontInfo, &fontData.ascent, &fontData.descent, &fontData.lineGap);
+	fontData.ascent = std::ceil(fontData.ascent * scale);
+	fontData.descent = std::ceil(fontData.descent * scale);
+	fontData.lineGap = std::ceil(fontData.lineGap * scale);
+
+	return fontData;
+}
+
+//Check whether all glyphs fit within tile using only bounding boxes, which match extents of the generated sdf data
+bool getGlyphsFit(stbtt_fontinfo const& fontInfo, std::uint32_t size, std::int32_t tileWidth, std::int32_t tileHeight, int padding)
+{
+	auto fontData = createFontData(fontInfo, size);
+	auto scale = stbtt_ScaleForPixelHeight(&fontInfo, (float)size);
+
+	for(auto codepoint : codepoints)
+	{
+		int x0{}, y0{}, x1{}, y1{};
+		stbtt_GetCodepointBitmapBox(&fontInfo, codepoint, scale, scale, &x0, &y0, &x1, &y1);
+
+		//Empty glyphs have no sdf data and zero offsets
+		int width{}, height{}, xOffset{}, yOffset{};
+		if(x0 != x1 && y0 != y1)
+		{
+			width = x1 - x0 + 2 * padding;
+			height = y1 - y0 + 2 * padding;
+			xOffset = x0 - padding;
+			yOffset = y0 - padding;
+		}
+
+		auto totalWidth = width + std::abs(xOffset + padding);
+		auto totalHeight = height + std::abs(fontData.ascent + yOffset + padding);
+		if(totalWidth > tileWidth - 2 || totalHeight > tileHeight - 2)
+			return false;
+	}
+
+	return true;
+}
+
 //Choose largest font size that fits within boundaries
-auto getLargestFontData(stbtt_fontinfo const& fontInfo, std::int32_t tileWidth, std::int32_t tileHeight, int padding)
+auto getLargestFontData(stbtt_fontinfo const& fontInfo, std::int32_t tileWidth, std::int32_t tileHeight, int padding, bool multiChannel, std::uint32_t workerCount)
+{
+	//Bracket the largest fitting size by doubling, sizes stay even
+	std::uint32_t fittingSize{}, exceedingSize{2};
+	while(getGlyphsFit(fontInfo, exceedingSize, tileWidth, tileHeight, padding))
+	{
+		fittingSize = exceedingSize;
+		exceedingSize *= 2;
+	}
+
+	//Binary search within the bracket
+	while(exceedingSize - fittingSize > 2)
+	{
+		auto size = (fittingSize + exceedingSize) / 4 * 2;
+		if(getGlyphsFit(fontInfo, size, tileWidth, tileHeight, padding))
+			fittingSize = size;
+		else
+			exceedingSize = size;
+	}
+
+	//Rasterize only the selected size, stepping down if sdf data disagrees with the metrics
+	FontData result{};
+	for(auto size = fittingSize; size > 0; size -= 2)
+	{
+		auto fontData = createFontData(fontInfo, size);
+		auto scale = stbtt_ScaleForPixelHeight(&fontInfo, (float)size);
+		if(generateCodepointData(fontData, fontInfo, scale, tileWidth, tileHeight, padding, multiChannel, workerCount))
+		{
+			result = std::move(fontData);
+			break;
+		}
+
+		std::println("Font size {} exceeds tile size despite fitting metrics", size);
+	}
+
+	std::println("Selected font size: {} maxWidth: {} maxHeight: {}", result.size, result.maxWidth, result.maxHeight);
+	return result;
+}
+
+//Choose largest font size by generating all sizes in order, used to verify the search
+auto getLargestFontDataLinear(stbtt_fontinfo const& fontInfo, std::int32_t tileWidth, std::int32_t tileHeight, int padding, bool multiChannel, std::uint32_t workerCount)
 {
 	FontData result{};
 
 	//Iterate over sizes until glyphs exceed tile size
 	for(std::uint32_t size = 2; ; size += 2)
 	{
-		FontData currentFontData{};
-		currentFontData.size = size;
-
+		auto currentFontData = createFontData(fontInfo, size);
 		auto currentScale = stbtt_ScaleForPixelHeight(&fontInfo, (float)size);
+		if(!generateCodepointData(currentFontData, fontInfo, currentScale, tileWidth, tileHeight, padding, multiChannel, workerCount))
+			break;
 
-		stbtt_GetFontVMetrics(&fontInfo, &currentFontData.ascent, &currentFontData.descent, &currentFontData.lineGap);
-		currentFontData.ascent = std::ceil(currentFontData.ascent * currentScale);
-		currentFontData.descent = std::ceil(currentFontData.descent * currentScale);
-		currentFontData.lineGap = std::ceil(currentFontData.lineGap * currentScale);
+		result = std::move(currentFontData);
+	}
 
-		bool stopSearch{};
-		for(std::size_t i = 0; i < codepoints.size(); i++)
+	return result;
+}
+
+//Single level of the output mip chain
+struct MipLevel
+{
+	std::size_t width{}, height{};
+	std::vector<unsigned char> data;
+};
+
+//Box filter each level down to 1x1, channels are interleaved and filtered separately
+std::vector<MipLevel> generateMipChain(std::vector<unsigned char> const& bitmap, std::size_t width, std::size_t height, std::size_t channelCount)
+{
+	std::vector<MipLevel> levels;
+	levels.emplace_back(width, height, bitmap);
+	while(levels.back().width > 1 || levels.back().height > 1)
+	{
+		auto const& source = levels.back();
+		MipLevel level{std::max(source.width / 2, 1uz), std::max(source.height / 2, 1uz)};
+		level.data.resize(level.width * level.height * channelCount);
+		for(std::size_t y = 0; y < level.height; y++)
 		{
-			auto& data = currentFontData.codepointData[i];
-			data = CodepointData(fontInfo, currentScale, codepoints[i], padding);
+			for(std::size_t x = 0; x < level.width; x++)
+			{
+				auto x0 = std::min(x * 2, source.width - 1), x1 = std::min(x * 2 + 1, source.width - 1);
+				auto y0 = std::min(y * 2, source.height - 1), y1 = std::min(y * 2 + 1, source.height - 1);
+				for(std::size_t channel = 0; channel < channelCount; channel++)
+				{
+					unsigned sum = source.data[(x0 + y0 * source.width) * channelCount + channel] + source.data[(x1 + y0 * source.width) * channelCount + channel] +
+						source.data[(x0 + y1 * source.width) * channelCount + channel] + source.data[(x1 + y1 * source.width) * channelCount + channel];
+					level.data[(x + y * level.width) * channelCount + channel] = (sum + 2) / 4;
+				}
+			}
+		}
+		levels.push_back(std::move(level));
+	}
 
-			int horizontalExtent = data.xOffset + padding;
-			auto totalWidth = data.width + std::abs(horizontalExtent);
-			if(horizontalExtent < 0 && std::abs(horizontalExtent) > currentFontData.leftOffset)
-				currentFontData.leftOffset = std::abs(horizontalExtent);
+	return levels;
+}
+
+//Encode level into 4x4 BC4 blocks of 8 bytes, endpoints are the block min and max with 6 interpolated values between them
+std::vector<unsigned char> compressBC4(MipLevel const& level)
+{
+	auto blocksWide = (level.width + 3) / 4, blocksHigh = (level.height + 3) / 4;
+	std::vector<unsigned char> result(blocksWide * blocksHigh * 8);
+	for(std::size_t blockY = 0; blockY < blocksHigh; blockY++)
+	{
+		for(std::size_t blockX = 0; blockX < blocksWide; blockX++)
+		{
+			//Gather texels, clamping blocks that hang over the edge of small levels
+			std::array<unsigned char, 16> texels{};
+			for(std::size_t i = 0; i < texels.size(); i++)
+			{
+				auto x = std::min(blockX * 4 + i % 4, level.width - 1);
+				auto y = std::min(blockY * 4 + i / 4, level.height - 1);
+				texels[i] = level.data[x + y * level.width];
+			}
+			auto [minTexel, maxTexel] = std::ranges::minmax(texels);
 
-			int verticalExtent = currentFontData.ascent + data.yOffset + padding;
-			auto totalHeight = data.height + std::abs(verticalExtent);
-			if(verticalExtent < 0 && std::abs(verticalExtent) > currentFontData.upOffset)
-				currentFontData.upOffset = std::abs(verticalExtent);
+			std::array<int, 8> palette{maxTexel, minTexel};
+			for(int i = 1; i < 7; i++)
+				palette[i + 1] = ((7 - i) * maxTexel + i * minTexel) / 7;
 
-			if(totalWidth > tileWidth - 2 || totalHeight > tileHeight - 2)
+			std::uint64_t block = maxTexel | minTexel << 8;
+			for(std::size_t i = 0; i < texels.size(); i++)
 			{
-				stopSearch = true;
+				std::uint64_t bestIndex{};
+				for(std::uint64_t index = 1; index < palette.size(); index++)
+				{
+					if(std::abs(palette[index] - texels[i]) < std::abs(palette[bestIndex] - texels[i]))
+						bestIndex = index;
+				}
+				block |= bestIndex << (16 + 3 * i);
+			}
+
+			auto blockBytes = std::bit_cast<std::array<unsigned char, 8>>(block);
+			std::ranges::copy(blockBytes, result.begin() + (blockX + blockY * blocksWide) * 8);
+		}
+	}
+
+	return result;
+}
+
+template<class T>
+void appendValue(std::vector<unsigned char>& buffer, T value)
+{
+	auto bytes = std::bit_cast<std::array<unsigned char, sizeof(T)>>(value);
+	buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+}
+
+//Write mip chain as a KTX2 texture, VK_FORMAT_R8_UNORM or VK_FORMAT_BC4_UNORM_BLOCK for one channel and VK_FORMAT_R8G8B8A8_UNORM for four
+bool writeKTX2(std::string const& fileName, std::vector<MipLevel> const& levels, std::size_t channelCount, bool compress)
+{
+	constexpr std::array<unsigned char, 12> identifier{0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+	constexpr std::uint32_t headerSize{80}, levelIndexEntrySize{24};
+	auto sampleCount = compress ? 1u : (std::uint32_t)channelCount;
+	auto dfdSize = 28 + 16 * sampleCount;
+
+	std::vector<std::vector<unsigned char>> levelData;
+	for(auto const& level : levels)
+		levelData.push_back(compress ? compressBC4(level) : level.data);
+
+	//Levels are stored from smallest to largest, aligned to the texel block size and 4 bytes
+	std::size_t alignment = compress ? 8 : 4;
+	auto dfdOffset = headerSize + levelIndexEntrySize * (std::uint32_t)levels.size();
+	std::vector<std::uint64_t> levelOffsets(levels.size());
+	std::uint64_t dataEnd{dfdOffset + dfdSize};
+	for(auto i = levels.size(); i-- > 0;)
+	{
+		levelOffsets[i] = (dataEnd + alignment - 1) / alignment * alignment;
+		dataEnd = levelOffsets[i] + levelData[i].size();
+	}
+
+	std::vector<unsigned char> file(identifier.begin(), identifier.end());
+	appendValue<std::uint32_t>(file, compress ? 139 : channelCount == 4 ? 37 : 9);
+	appendValue<std::uint32_t>(file, 1);
+	appendValue<std::uint32_t>(file, (std::uint32_t)levels[0].width);
+	appendValue<std::uint32_t>(file, (std::uint32_t)levels[0].height);
+	appendValue<std::uint32_t>(file, 0);
+	appendValue<std::uint32_t>(file, 0);
+	appendValue<std::uint32_t>(file, 1);
+	appendValue<std::uint32_t>(file, (std::uint32_t)levels.size());
+	appendValue<std::uint32_t>(file, 0);
+
+	//Index, no key/value or supercompression data
+	appendValue<std::uint32_t>(file, dfdOffset);
+	appendValue<std::uint32_t>(file, dfdSize);
+	appendValue<std::uint32_t>(file, 0);
+	appendValue<std::uint32_t>(file, 0);
+	appendValue<std::uint64_t>(file, 0);
+	appendValue<std::uint64_t>(file, 0);
+
+	for(std::size_t i = 0; i < levels.size(); i++)
+	{
+		appendValue<std::uint64_t>(file, levelOffsets[i]);
+		appendValue<std::uint64_t>(file, levelData[i].size());
+		appendValue<std::uint64_t>(file, levelData[i].size());
+	}
+
+	//Basic data format descriptor with a sample per channel
+	appendValue<std::uint32_t>(file, dfdSize);
+	appendValue<std::uint32_t>(file, 0);
+	appendValue<std::uint32_t>(file, 2 | (dfdSize - 4) << 16);
+	//Color model RGBSDA or BC4, BT.709 primaries, linear transfer
+	appendValue<std::uint32_t>(file, (compress ? 131 : 1) | 1 << 8 | 1 << 16);
+	appendValue<std::uint32_t>(file, compress ? 3 | 3 << 8 : 0);
+	appendValue<std::uint32_t>(file, compress ? 8 : (std::uint32_t)channelCount);
+	appendValue<std::uint32_t>(file, 0);
+	for(std::uint32_t sample = 0; sample < sampleCount; sample++)
+	{
+		//Alpha has channel id 15 in RGBSDA
+		std::uint32_t channelId = sample == 3 ? 15 : sample;
+		appendValue<std::uint32_t>(file, sample * 8 | (compress ? 63 : 7) << 16 | channelId << 24);
+		appendValue<std::uint32_t>(file, 0);
+		appendValue<std::uint32_t>(file, 0);
+		appendValue<std::uint32_t>(file, compress ? 0xFFFFFFFF : 255);
+	}
+
+	for(auto i = levels.size(); i-- > 0;)
+	{
+		file.resize(levelOffsets[i], 0);
+		file.insert(file.end(), levelData[i].begin(), levelData[i].end());
+	}
+
+	auto outFile = std::fopen(fileName.c_str(), "wb");
+	if(!outFile)
+		return false;
+	auto written = std::fwrite(file.data(), sizeof(unsigned char), file.size(), outFile);
+	std::fclose(outFile);
+
+	return written == file.size();
+}
+
+//Packs rectangles bottom-left along a skyline of placed rectangles, atlas height grows as needed
+class SkylinePacker
+{
+public:
+	SkylinePacker(std::uint32_t width): width(width), skyline{{0, 0, width}} {}
+
+	std::optional<std::pair<std::uint32_t, std::uint32_t>> insert(std::uint32_t rectWidth, std::uint32_t rectHeight)
+	{
+		if(rectWidth > width)
+			return std::nullopt;
+
+		//Find position where rectangle top ends lowest, leftmost on ties
+		std::size_t bestSegment{};
+		std::uint32_t bestX{}, bestY{std::numeric_limits<std::uint32_t>::max()};
+		for(std::size_t i = 0; i < skyline.size(); i++)
+		{
+			auto x = skyline[i].x;
+			if(x + rectWidth > width)
 				break;
+
+			std::uint32_t y{};
+			for(auto j = i; j < skyline.size() && skyline[j].x < x + rectWidth; j++)
+				y = std::max(y, skyline[j].y);
+
+			if(y < bestY)
+			{
+				bestSegment = i;
+				bestX = x;
+				bestY = y;
 			}
+		}
 
-			if(totalWidth > currentFontData.maxWidth)
-				currentFontData.maxWidth = totalWidth;
-			if(totalHeight > currentFontData.maxHeight)
-				currentFontData.maxHeight = totalHeight;
+		//Replace covered segments with the top of the new rectangle
+		Segment placed{bestX, bestY + rectHeight, rectWidth};
+		auto segmentEnd = bestSegment;
+		while(segmentEnd < skyline.size() && skyline[segmentEnd].x + skyline[segmentEnd].width <= bestX + rectWidth)
+			segmentEnd++;
+		if(segmentEnd < skyline.size() && skyline[segmentEnd].x < bestX + rectWidth)
+		{
+			auto& partial = skyline[segmentEnd];
+			partial.width -= bestX + rectWidth - partial.x;
+			partial.x = bestX + rectWidth;
 		}
+		skyline.erase(skyline.begin() + bestSegment, skyline.begin() + segmentEnd);
+		skyline.insert(skyline.begin() + bestSegment, placed);
 
-		if(stopSearch)
+		//Merge neighbouring segments of equal height
+		for(std::size_t i = 1; i < skyline.size();)
 		{
-			std::println("Selected font size: {} maxWidth: {} maxHeight: {}", currentFontData.size, currentFontData.maxWidth, currentFontData.maxHeight);
-			break;
+			if(skyline[i - 1].y == skyline[i].y)
+			{
+				skyline[i - 1].width += skyline[i].width;
+				skyline.erase(skyline.begin() + i);
+			}
+			else
+				i++;
 		}
 
-		result = std::move(currentFontData);
+		height = std::max(height, placed.y);
+		return std::pair{bestX, bestY};
+	}
+
+	auto getHeight() const { return height; }
+
+private:
+	struct Segment
+	{
+		std::uint32_t x{}, y{}, width{};
+	};
+
+	std::uint32_t width{}, height{};
+	std::vector<Segment> skyline;
+};
+
+//Glyph placement in a tightly packed atlas
+struct PackedAtlas
+{
+	std::uint32_t width{}, height{};
+	std::array<std::pair<std::uint32_t, std::uint32_t>, codepoints.size()> positions{};
+};
+
+//Pack trimmed glyphs into the power of two wide atlas with the smallest area, glyphs are separated by a gutter to avoid filtering bleed
+PackedAtlas packGlyphs(FontData const& fontData)
+{
+	constexpr std::uint32_t gutter{1};
+
+	//Placing taller glyphs first keeps the skyline flat
+	std::array<std::size_t, codepoints.size()> order{};
+	std::iota(order.begin(), order.end(), 0uz);
+	std::ranges::stable_sort(order, [&](std::size_t lhs, std::size_t rhs)
+	{
+		auto const& left = fontData.codepointData[lhs];
+		auto const& right = fontData.codepointData[rhs];
+		return std::pair{left.height, left.width} > std::pair{right.height, right.width};
+	});
+
+	PackedAtlas result{};
+	std::uint64_t bestArea{std::numeric_limits<std::uint64_t>::max()};
+	for(std::uint32_t width = 16; width <= 4096; width *= 2)
+	{
+		PackedAtlas atlas{width};
+		SkylinePacker packer(width);
+		bool fits{true};
+		for(auto i : order)
+		{
+			auto const& data = fontData.codepointData[i];
+			if(data.width == 0 || data.height == 0)
+				continue;
+
+			auto position = packer.insert(data.width + gutter, data.height + gutter);
+			if(!position)
+			{
+				fits = false;
+				break;
+			}
+			atlas.positions[i] = *position;
+		}
+
+		//Keep height a multiple of the BC4 block size
+		atlas.height = (packer.getHeight() + 3) / 4 * 4;
+		if(fits && (std::uint64_t)width * atlas.height < bestArea)
+		{
+			bestArea = (std::uint64_t)width * atlas.height;
+			result = atlas;
+		}
 	}
 
 	return result;
 }
 
-auto main(int argc, char** argv) -> int
+//Write glyph rects, tile placement and metrics for the packed atlas
+bool writeGlyphMetrics(std::string const& fileName, FontData const& fontData, PackedAtlas const& atlas, stbtt_fontinfo const& fontInfo,
+					   std::uint32_t tileWidth, std::uint32_t tileHeight, int padding)
 {
-	if(argc < 2)
+	constexpr std::uint32_t version{1};
+
+	auto scale = stbtt_ScaleForPixelHeight(&fontInfo, (float)fontData.size);
+	int leftMargin = (tileWidth - fontData.maxWidth) / 2;
+	int upMargin = (tileHeight - fontData.maxHeight) / 2;
+
+	std::vector<unsigned char> file{'A', 'G', 'L', 'Y'};
+	appendValue<std::uint32_t>(file, version);
+	appendValue<std::uint32_t>(file, (std::uint32_t)codepoints.size());
+	appendValue<std::uint32_t>(file, atlas.width);
+	appendValue<std::uint32_t>(file, atlas.height);
+	appendValue<std::uint32_t>(file, tileWidth);
+	appendValue<std::uint32_t>(file, tileHeight);
+
+	for(std::size_t i = 0; i < codepoints.size(); i++)
 	{
-		std::println("Usage: BitmapGenerator <file_path> [options]\n"
-					 "\toptions:\n"
-					 "\t\t--width <value>\tSpecify width of a single tile [2..1024]. Default: 32"
-					 "\t\t--height <value>\tSpecify height of a single tile [2..1024]. Default: 64"
-					 "\t\t--output <value>\tSpecify output file. Default: tiles.png"
-					 "\t\t--padding <value>\tSpecify glyph padding [0..256]. Default: 4"
-					 "\t\t--debug\tRender debug boundaries on bitmap.");
-		return 1;
+		auto const& data = fontData.codepointData[i];
+		int advance{}, leftBearing{};
+		stbtt_GetCodepointHMetrics(&fontInfo, codepoints[i], &advance, &leftBearing);
+
+		appendValue<std::uint32_t>(file, (std::uint32_t)codepoints[i]);
+		appendValue<std::uint32_t>(file, atlas.positions[i].first);
+		appendValue<std::uint32_t>(file, atlas.positions[i].second);
+		appendValue<std::uint32_t>(file, data.width);
+		appendValue<std::uint32_t>(file, data.height);
+		//Top left corner of the glyph within its tile, same as in the grid layout
+		appendValue<std::int32_t>(file, leftMargin + data.xOffset + padding + fontData.leftOffset);
+		appendValue<std::int32_t>(file, upMargin + fontData.ascent + data.yOffset + padding + fontData.upOffset);
+		appendValue<std::int32_t>(file, data.xOffset);
+		appendValue<std::int32_t>(file, data.yOffset);
+		appendValue<float>(file, advance * scale);
 	}
 
-	//Parse command line args
-	std::uint32_t tileWidth{32u}, tileHeight{64u}, padding{4u};
+	auto outFile = std::fopen(fileName.c_str(), "wb");
+	if(!outFile)
+		return false;
+	auto written = std::fwrite(file.data(), sizeof(unsigned char), file.size(), outFile);
+	std::fclose(outFile);
+
+	return written == file.size();
+}
+
+//Parameters of a single atlas, from the command line or a manifest entry
+struct AtlasJob
+{
+	std::string fontFile;
 	std::string outputFile{"tiles.png"};
-	bool debug{};
-	for(std::uint32_t i = 2; i < argc; i++)
+	std::uint32_t tileWidth{32u}, tileHeight{64u}, padding{4u};
+	bool debug{}, compress{}, pack{}, compareSearch{}, multiChannel{};
+	bool logGlyphs{true};
+};
+
+bool validateJob(AtlasJob const& job)
+{
+	if(job.tileWidth <= 2 || job.tileWidth > 1024)
 	{
-		if(argv[i] == "--width"sv)
+		std::println("Invalid width for {}", job.outputFile);
+		return false;
+	}
+	if(job.tileHeight <= 2 || job.tileHeight > 1024)
+	{
+		std::println("Invalid height for {}", job.outputFile);
+		return false;
+	}
+	if(job.padding > 256)
+	{
+		std::println("Invalid padding for {}", job.outputFile);
+		return false;
+	}
+	if(job.multiChannel && job.compress)
+	{
+		std::println("BC4 only holds a single channel, can't compress multi-channel {}", job.outputFile);
+		return false;
+	}
+
+	return true;
+}
+
+//Generate a single atlas from an initialized font
+bool generateAtlas(AtlasJob const& job, stbtt_fontinfo const& fontInfo, std::uint32_t workerCount)
+{
+	std::int32_t tileWidth = job.tileWidth, tileHeight = job.tileHeight, padding = job.padding;
+	auto const& outputFile = job.outputFile;
+
+	//Get sdf and size data
+	auto searchStart = std::chrono::steady_clock::now();
+	auto fontData = getLargestFontData(fontInfo, tileWidth, tileHeight, padding, job.multiChannel, workerCount);
+	std::chrono::duration<double, std::milli> searchDuration = std::chrono::steady_clock::now() - searchStart;
+	std::println("Size search took {:.1f}ms", searchDuration.count());
+
+	if(job.compareSearch)
+	{
+		auto linearStart = std::chrono::steady_clock::now();
+		auto linearFontData = getLargestFontDataLinear(fontInfo, tileWidth, tileHeight, padding, job.multiChannel, workerCount);
+		std::chrono::duration<double, std::milli> linearDuration = std::chrono::steady_clock::now() - linearStart;
+		std::println("Linear size search took {:.1f}ms, selected font size: {}", linearDuration.count(), linearFontData.size);
+
+		if(linearFontData.size != fontData.size || linearFontData.maxWidth != fontData.maxWidth || linearFontData.maxHeight != fontData.maxHeight)
 		{
-			tileWidth = std::atoi(argv[i + 1]);
-			if(tileWidth <= 2 || tileWidth > 1024)
-			{
-				std::println("Invalid width argument");
-				return 1;
-			}
-			i++;
+			std::println("Size search result differs from linear search");
+			return false;
 		}
-		else if(argv[i] == "--height"sv)
+	}
+	if(fontData.size == 0)
+	{
+		std::println("Couldn't find suitable font size");
+		return false;
+	}
+	std::println("Font ascent: {} descent: {} lineGap: {}", fontData.ascent, fontData.descent, fontData.lineGap);
+
+	std::size_t textureWidth{}, textureHeight{};
+	std::size_t channelCount = job.multiChannel ? 4 : 1;
+	std::vector<unsigned char> finalBitmap;
+	if(job.pack)
+	{
+		auto atlas = packGlyphs(fontData);
+		if(atlas.width == 0)
 		{
-			tileHeight = std::atoi(argv[i + 1]);
-			if(tileHeight <= 2 || tileHeight > 1024)
+			std::println("Couldn't pack glyphs into atlas");
+			return false;
+		}
+		std::println("Packed atlas size: {}x{}", atlas.width, atlas.height);
+
+		textureWidth = atlas.width;
+		textureHeight = atlas.height;
+		finalBitmap.resize(textureWidth * textureHeight * channelCount, 0);
+		for(std::size_t i = 0; i < codepoints.size(); i++)
+		{
+			auto& data = fontData.codepointData[i];
+			auto [glyphX, glyphY] = atlas.positions[i];
+			for(std::size_t j = 0; j < data.height; j++)
 			{
-				std::println("Invalid height argument");
-				return 1;
+				std::copy_n(data.sdfData.begin() + j * data.width * channelCount, data.width * channelCount,
+							finalBitmap.begin() + (glyphX + (glyphY + j) * textureWidth) * channelCount);
 			}
-			i++;
 		}
-		else if(argv[i] == "--output"sv)
+
+		auto metricsFile = std::filesystem::path(outputFile).replace_extension(".glyphs").string();
+		if(!writeGlyphMetrics(metricsFile, fontData, atlas, fontInfo, tileWidth, tileHeight, padding))
 		{
-			outputFile = argv[i + 1];
-			i++;
+			std::println("Failed to write {}", metricsFile);
+			return false;
 		}
-		else if(argv[i] == "--padding"sv)
+	}
+	else
+	{
+		//Final tile texture is 16x16
+		textureWidth = (size_t)tileWidth * 16;
+		textureHeight = (size_t)tileHeight * 16;
+		finalBitmap.resize(textureWidth * textureHeight * channelCount, job.debug ? 255 : 0);
+		auto setPixel = [&](std::size_t index, unsigned char value)
+		{
+			std::fill_n(finalBitmap.begin() + index * channelCount, channelCount, value);
+		};
+
+		//Draw tile edges in debug mode
+		if(job.debug)
 		{
-			padding = std::atoi(argv[i + 1]);
-			if(padding > 256)
+			for(std::size_t i = 0; i < 16; i++)
 			{
-				std::println("Invalid padding argument");
-				return 1;
+				for(std::size_t j = 0; j < textureHeight; j++)
+				{
+					auto tileStride = i * tileWidth;
+					auto textureStride = j * textureWidth;
+					setPixel((std::size_t)tileWidth - 1 + tileStride + textureStride, 96);
+					setPixel(tileStride + textureStride, 160);
+				}
+			}
+			for(std::size_t i = 0; i < 16; i++)
+			{
+				for(std::size_t j = 0; j < textureWidth; j++)
+				{
+					auto tileStride = i * tileHeight;
+					setPixel(j + ((std::size_t)tileHeight - 1 + tileStride) * textureWidth, 96);
+					setPixel(j + tileStride * textureWidth, 160);
+				}
 			}
-			i++;
 		}
-		else if(argv[i] == "--debug"sv)
+
+		//Fill final texture
+		int leftMargin = (tileWidth - fontData.maxWidth) / 2;
+		int upMargin = (tileHeight - fontData.maxHeight) / 2;
+		std::uint64_t glyphRow{}, glyphColumn{};
+		for(std::uint64_t i = 0; i < codepoints.size(); i++)
 		{
-			debug = true;
+			auto& data = fontData.codepointData[i];
+			if(job.logGlyphs)
+			{
+				std::println("{:X} padding: {} width: {} height: {} xOffset: {} yOffset: {}",
+							 codepoints[i], padding, data.width, data.height, data.xOffset, data.yOffset);
+			}
+
+			for(std::uint64_t i = 0; i < data.width; i++)
+			{
+				for(std::uint64_t j = 0; j < data.height; j++)
+				{
+					auto horizontalTileStride = glyphColumn * tileWidth;
+					auto verticalTileStride = glyphRow * tileHeight;
+					auto leftOffset = leftMargin + data.xOffset + padding + fontData.leftOffset;
+					auto upOffset = upMargin + fontData.ascent + data.yOffset + padding + fontData.upOffset;
+					auto pixelIndex = horizontalTileStride + leftOffset + i + (verticalTileStride + upOffset + j) * textureWidth;
+					std::copy_n(data.sdfData.begin() + (i + j * data.width) * channelCount, channelCount, finalBitmap.begin() + pixelIndex * channelCount);
+				}
+			}
+
+			glyphColumn++;
+			if(glyphColumn == 16)
+			{
+				glyphColumn = 0;
+				glyphRow++;
+			}
+		}
+	}
+
+	if(outputFile.ends_with(".ktx2"))
+	{
+		auto levels = generateMipChain(finalBitmap, textureWidth, textureHeight, channelCount);
+		if(!writeKTX2(outputFile, levels, channelCount, job.compress))
+		{
+			std::println("Failed to write {}", outputFile);
+			return false;
 		}
+		std::println("Wrote {} mip levels{}", levels.size(), job.compress ? " with BC4 compression" : "");
+	}
+	else if(!stbi_write_png(outputFile.c_str(), textureWidth, textureHeight, channelCount, finalBitmap.data(), 0))
+	{
+		std::println("Failed to write {}", outputFile);
+		return false;
+	}
+
+	return true;
+}
+
+//Font file contents and the stb font referencing them
+struct LoadedFont
+{
+	std::vector<unsigned char> data;
+	stbtt_fontinfo fontInfo{};
+	std::uint64_t hash{};
+};
+
+//FNV-1a, used to detect outputs that are up to date
+std::uint64_t hashBytes(std::span<unsigned char const> bytes, std::uint64_t hash = 0xcbf29ce484222325)
+{
+	for(auto byte : bytes)
+	{
+		hash ^= byte;
+		hash *= 0x100000001b3;
 	}
-	std::string fileName = argv[1];
 
+	return hash;
+}
+
+std::optional<LoadedFont> loadFont(std::string const& fileName)
+{
 	//Open and read font file
 	auto file = std::fopen(fileName.data(), "rb");
+	if(!file)
+		return std::nullopt;
 	std::fseek(file, 0, SEEK_END);
 	auto fileSize = std::ftell(file);
 	std::rewind(file);
-	std::vector<unsigned char> data(fileSize, 0);
-	auto result = std::fread(data.data(), sizeof(unsigned char), fileSize, file);
+	LoadedFont font{std::vector<unsigned char>(fileSize, 0)};
+	auto result = std::fread(font.data.data(), sizeof(unsigned char), fileSize, file);
+	std::fclose(file);
+	if(result != (std::size_t)fileSize)
+		return std::nullopt;
 
 	//Init stb font
-	stbtt_fontinfo fontInfo;
-	stbtt_InitFont(&fontInfo, data.data(), stbtt_GetFontOffsetForIndex(data.data(), 0));
+	auto fontOffset = stbtt_GetFontOffsetForIndex(font.data.data(), 0);
+	if(fontOffset < 0 || !stbtt_InitFont(&font.fontInfo, font.data.data(), fontOffset))
+		return std::nullopt;
+	font.hash = hashBytes(font.data);
 
-	//Get sdf and size data
-	auto fontData = getLargestFontData(fontInfo, tileWidth, tileHeight, padding);
-	if(fontData.size == 0)
+	return font;
+}
+
+//Hash of everything that affects the output of a job
+std::string getJobHash(AtlasJob const& job, LoadedFont const& font)
+{
+	//Bump when generator output changes
+	constexpr std::uint32_t generatorVersion{1};
+
+	auto parameters = std::format("{} {} {} {} {} {} {} {} {} {}", generatorVersion, font.hash, job.outputFile, job.tileWidth, job.tileHeight,
+								  job.padding, job.debug, job.compress, job.pack, job.multiChannel);
+	return std::format("{:016x}", hashBytes({reinterpret_cast<unsigned char const*>(parameters.data()), parameters.size()}));
+}
+
+//Outputs are up to date when they exist and their hash file matches
+bool getIsUpToDate(AtlasJob const& job, std::string const& hash)
+{
+	if(!std::filesystem::exists(job.outputFile))
+		return false;
+	if(job.pack && !std::filesystem::exists(std::filesystem::path(job.outputFile).replace_extension(".glyphs")))
+		return false;
+
+	std::ifstream hashFile(job.outputFile + ".hash");
+	std::string storedHash;
+	return hashFile >> storedHash && storedHash == hash;
+}
+
+//Generate all atlases listed in a manifest, fonts are loaded once and jobs run in parallel
+bool runManifest(std::string const& manifestFile, bool force)
+{
+	std::ifstream file(manifestFile, std::ios::in | std::ios::binary);
+	auto manifestJSON = nlohmann::json::parse(file, nullptr, false);
+	if(manifestJSON.is_discarded() || !manifestJSON.contains("atlases") || !manifestJSON["atlases"].is_array())
 	{
-		std::println("Couldn't find suitable font size");
-		return 1;
+		std::println("Failed to parse manifest {}", manifestFile);
+		return false;
 	}
-	std::println("Font ascent: {} descent: {} lineGap: {}", fontData.ascent, fontData.descent, fontData.lineGap);
 
-	//Final tile texture is 16x16
-	std::size_t textureWidth{(size_t)tileWidth * 16}, textureHeight{(size_t)tileHeight * 16};
-	std::vector<unsigned char> finalBitmap;
-	finalBitmap.resize(textureWidth * textureHeight, debug ? 255 : 0);
+	std::vector<AtlasJob> jobs;
+	//Jobs run concurrently, two writing the same file would race
+	std::set<std::filesystem::path> writtenFiles;
+	for(auto const& entry : manifestJSON["atlases"])
+	{
+		AtlasJob job{};
+		job.fontFile = entry.value("font", ""s);
+		job.outputFile = entry.value("output", job.outputFile);
+		job.tileWidth = entry.value("width", job.tileWidth);
+		job.tileHeight = entry.value("height", job.tileHeight);
+		job.padding = entry.value("padding", job.padding);
+		job.debug = entry.value("debug", false);
+		job.compress = entry.value("bc4", false);
+		job.pack = entry.value("pack", false);
+		job.multiChannel = entry.value("msdf", false);
+		job.logGlyphs = false;
+		if(!validateJob(job))
+			return false;
 
-	//Draw tile edges in debug mode
-	if(debug)
+		auto outputPath = std::filesystem::path(job.outputFile).lexically_normal();
+		if(!writtenFiles.insert(outputPath).second || (job.pack && !writtenFiles.insert(std::filesystem::path(outputPath).replace_extension(".glyphs")).second))
+		{
+			std::println("Manifest writes {} more than once", job.outputFile);
+			return false;
+		}
+		jobs.push_back(std::move(job));
+	}
+
+	//Load each font once
+	std::map<std::string, LoadedFont> fonts;
+	for(auto const& job : jobs)
 	{
-		for(std::size_t i = 0; i < 16; i++)
+		if(fonts.contains(job.fontFile))
+			continue;
+
+		auto font = loadFont(job.fontFile);
+		if(!font)
 		{
-			for(std::size_t j = 0; j < textureHeight; j++)
-			{
-				auto tileStride = i * tileWidth;
-				auto textureStride = j * textureWidth;
-				finalBitmap[(std::size_t)tileWidth - 1 + tileStride + textureStride] = 96;
-				finalBitmap[tileStride + textureStride] = 160;
-			}
+			std::println("Failed to load font {}", job.fontFile);
+			return false;
 		}
-		for(std::size_t i = 0; i < 16; i++)
+		fonts.emplace(job.fontFile, std::move(*font));
+	}
+
+	std::vector<std::size_t> pendingJobs;
+	std::vector<std::string> jobHashes(jobs.size());
+	for(std::size_t i = 0; i < jobs.size(); i++)
+	{
+		jobHashes[i] = getJobHash(jobs[i], fonts.at(jobs[i].fontFile));
+		if(!force && getIsUpToDate(jobs[i], jobHashes[i]))
+			std::println("{} is up to date", jobs[i].outputFile);
+		else
+			pendingJobs.push_back(i);
+	}
+
+	//Split cores between concurrent jobs and the glyph workers inside them
+	auto coreCount = std::max(std::thread::hardware_concurrency(), 1u);
+	auto jobThreadCount = std::min<std::uint32_t>(coreCount, (std::uint32_t)pendingJobs.size());
+	auto workerCount = std::max(coreCount / std::max(jobThreadCount, 1u), 1u);
+
+	std::atomic<std::size_t> nextJob{};
+	std::atomic<bool> jobFailed{};
+	std::atomic<std::size_t> generatedCount{};
+	{
+		std::vector<std::jthread> jobThreads;
+		for(std::uint32_t thread = 0; thread < jobThreadCount; thread++)
 		{
-			for(std::size_t j = 0; j < textureWidth; j++)
+			jobThreads.emplace_back([&]()
 			{
-				auto tileStride = i * tileHeight;
-				finalBitmap[j + ((std::size_t)tileHeight - 1 + tileStride) * textureWidth] = 96;
-				finalBitmap[j + tileStride * textureWidth] = 160;
-			}
+				for(auto i = nextJob++; i < pendingJobs.size(); i = nextJob++)
+				{
+					auto const& job = jobs[pendingJobs[i]];
+					if(!generateAtlas(job, fonts.at(job.fontFile).fontInfo, workerCount))
+					{
+						std::println("Failed to generate {}", job.outputFile);
+						jobFailed = true;
+						continue;
+					}
+
+					std::ofstream hashFile(job.outputFile + ".hash");
+					hashFile << jobHashes[pendingJobs[i]];
+					if(!hashFile)
+					{
+						std::println("Failed to write {}.hash", job.outputFile);
+						jobFailed = true;
+						continue;
+					}
+					std::println("Generated {}", job.outputFile);
+					generatedCount++;
+				}
+			});
 		}
 	}
 
-	//Fill final texture
-	int leftMargin = (tileWidth - fontData.maxWidth) / 2;
-	int upMargin = (tileHeight - fontData.maxHeight) / 2;
-	std::uint64_t glyphRow{}, glyphColumn{};
-	for(std::uint64_t i = 0; i < codepoints.size(); i++)
+	std::println("Generated {} of {} atlases", generatedCount.load(), jobs.size());
+	return !jobFailed;
+}
+
+auto main(int argc, char** argv) -> int
+{
+	if(argc < 2)
 	{
-		auto& data = fontData.codepointData[i];
-		std::println("{:X} padding: {} width: {} height: {} xOffset: {} yOffset: {}",
-					 codepoints[i], padding, data.width, data.height, data.xOffset, data.yOffset);
+		std::println("Usage: BitmapGenerator <file_path> [options]\n"
+					 "       BitmapGenerator --manifest <file_path> [--force]\n"
+					 "\toptions:\n"
+					 "\t\t--width <value>\tSpecify width of a single tile [2..1024]. Default: 32"
+					 "\t\t--height <value>\tSpecify height of a single tile [2..1024]. Default: 64"
+					 "\t\t--output <value>\tSpecify output file, .ktx2 files include a mip chain. Default: tiles.png"
+					 "\t\t--padding <value>\tSpecify glyph padding [0..256]. Default: 4"
+					 "\t\t--debug\tRender debug boundaries on bitmap."
+					 "\t\t--bc4\tCompress output with BC4, only used for .ktx2 output files."
+					 "\t\t--pack\tPack trimmed glyphs tightly and write their rects to a .glyphs file beside the output."
+					 "\t\t--msdf\tGenerate multi-channel sdf with the true distance in alpha, keeps corners sharp in smaller tiles."
+					 "\t\t--compare-search\tAlso run the linear size search and compare its result and timing."
+					 "\t\t--manifest <value>\tGenerate all atlases listed in a JSON manifest, skipping outputs that are up to date."
+					 "\t\t--force\tRegenerate manifest outputs even if they are up to date.");
+		return 1;
+	}
 
-		for(std::uint64_t i = 0; i < data.width; i++)
+	if(argv[1] == "--manifest"sv)
+	{
+		if(argc < 3)
 		{
-			for(std::uint64_t j = 0; j < data.height; j++)
-			{
-				auto horizontalTileStride = glyphColumn * tileWidth;
-				auto verticalTileStride = glyphRow * tileHeight;
-				auto leftOffset = leftMargin + data.xOffset + padding + fontData.leftOffset;
-				auto upOffset = upMargin + fontData.ascent + data.yOffset + padding + fontData.upOffset;
-				finalBitmap[horizontalTileStride + leftOffset + i + (verticalTileStride + upOffset + j) * textureWidth] = data.sdfData[i + j * data.width];
-			}
+			std::println("Missing manifest argument");
+			return 1;
 		}
 
-		glyphColumn++;
-		if(glyphColumn == 16)
+		bool force = argc > 3 && argv[3] == "--force"sv;
+		return runManifest(argv[2], force) ? 0 : 1;
+	}
+
+	//Parse command line args
+	AtlasJob job{argv[1]};
+	for(std::uint32_t i = 2; i < argc; i++)
+	{
+		if(argv[i] == "--width"sv)
+		{
+			job.tileWidth = std::atoi(argv[i + 1]);
+			i++;
+		}
+		else if(argv[i] == "--height"sv)
+		{
+			job.tileHeight = std::atoi(argv[i + 1]);
+			i++;
+		}
+		else if(argv[i] == "--output"sv)
+		{
+			job.outputFile = argv[i + 1];
+			i++;
+		}
+		else if(argv[i] == "--padding"sv)
 		{
-			glyphColumn = 0;
-			glyphRow++;
+			job.padding = std::atoi(argv[i + 1]);
+			i++;
+		}
+		else if(argv[i] == "--debug"sv)
+		{
+			job.debug = true;
+		}
+		else if(argv[i] == "--compare-search"sv)
+		{
+			job.compareSearch = true;
+		}
+		else if(argv[i] == "--bc4"sv)
+		{
+			job.compress = true;
+		}
+		else if(argv[i] == "--pack"sv)
+		{
+			job.pack = true;
+		}
+		else if(argv[i] == "--msdf"sv)
+		{
+			job.multiChannel = true;
 		}
 	}
+	if(!validateJob(job))
+		return 1;
 
-	stbi_write_png(outputFile.c_str(), textureWidth, textureHeight, 1, finalBitmap.data(), 0);
+	auto font = loadFont(job.fontFile);
+	if(!font)
+	{
+		std::println("Failed to load font {}", job.fontFile);
+		return 1;
+	}
 
-	return 0;
-}
\ No newline at end of file
+	return generateAtlas(job, font->fontInfo, std::max(std::thread::hardware_concurrency(), 1u)) ? 0 : 1;
+}
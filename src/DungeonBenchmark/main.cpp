@@ -0,0 +1,80 @@
+import std;
+import Logger;
+import JobSystem;
+import DungeonGenerator;
+
+//Level transitions have to stay well under this
+constexpr double budgetMs{1000.0};
+
+bool parseArgument(std::string_view argument, std::uint64_t& value)
+{
+	auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), value);
+	return error == std::errc{} && end == argument.data() + argument.size();
+}
+
+int main(int argc, char** argv)
+{
+	std::uint64_t runCount{10}, size{4096}, seed{1};
+	if(argc > 4 || (argc > 1 && !parseArgument(argv[1], runCount)) || (argc > 2 && !parseArgument(argv[2], size)) || (argc > 3 && !parseArgument(argv[3], seed)) || runCount == 0)
+	{
+		std::println("Usage: DungeonBenchmark [runs] [size] [seed]");
+		return 1;
+	}
+
+	//The generator and job system log through the same files as the game
+	if(!Logger::init())
+		return 1;
+
+	if(!JobSystem::init())
+	{
+		std::println("Failed to start the job system");
+		return 1;
+	}
+
+	std::vector<double> times;
+	std::optional<std::uint64_t> firstChecksum;
+	std::size_t wallCount{}, cellCount{};
+	for(std::uint64_t run = 0; run < runCount; run++)
+	{
+		auto startTime = std::chrono::steady_clock::now();
+		auto map = DungeonGenerator::generate(seed, static_cast<std::int32_t>(size), static_cast<std::int32_t>(size));
+		std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+		times.push_back(duration.count());
+
+		//FNV-1a over the words, the same seed has to give the same level every run
+		std::uint64_t checksum{0xcbf29ce484222325};
+		for(auto word : map.wallRows)
+			checksum = (checksum ^ word) * 0x100000001b3;
+		if(firstChecksum && *firstChecksum != checksum)
+		{
+			std::println("Run {} generated a different level, checksum {:016x} instead of {:016x}", run, checksum, *firstChecksum);
+			JobSystem::release();
+			return 1;
+		}
+		firstChecksum = checksum;
+
+		wallCount = 0;
+		for(auto word : map.wallRows)
+			wallCount += std::popcount(word);
+		cellCount = std::size_t(map.width) * map.height;
+	}
+
+	auto threadCount = JobSystem::getThreadCount();
+	JobSystem::release();
+
+	std::ranges::sort(times);
+	auto medianTime = times[times.size() / 2];
+	std::println("Generated {}x{} level {} times on {} threads", size, size, runCount, threadCount);
+	std::println("\tMin: {:.2f} ms", times.front());
+	std::println("\t50%: {:.2f} ms", medianTime);
+	std::println("\tMax: {:.2f} ms", times.back());
+	std::println("\tWalls: {:.1f}%", 100.0 * wallCount / cellCount);
+	std::println("\tChecksum: {:016x}", *firstChecksum);
+
+	if(medianTime > budgetMs)
+	{
+		std::println("Over the budget of {} ms", budgetMs);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,181 @@
+import std;
+import Logger;
+import JobSystem;
+import World;
+import FieldOfView;
+
+//Field of view is recomputed on the main thread whenever the player changes cell
+constexpr double budgetUs{100.0};
+
+bool parseArgument(std::string_view argument, std::uint64_t& value)
+{
+	auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), value);
+	return error == std::errc{} && end == argument.data() + argument.size();
+}
+
+//Symmetric shadowcasting one cell at a time straight from World::getIsWall, without the window and the word fast paths of FieldOfView
+class ReferenceScan
+{
+public:
+	static constexpr std::int32_t size{2 * FieldOfView::radius + 1};
+
+	ReferenceScan(std::int32_t newOriginX, std::int32_t newOriginY) : originX{newOriginX}, originY{newOriginY}
+	{
+		visible[FieldOfView::radius * size + FieldOfView::radius] = true;
+		for(std::uint32_t quadrant = 0; quadrant < 4; quadrant++)
+			scan(quadrant, 1, -1, 1, 1, 1);
+	}
+
+	[[nodiscard]] bool getIsVisible(std::int32_t cellX, std::int32_t cellY) const
+	{
+		auto x = cellX - originX + FieldOfView::radius, y = cellY - originY + FieldOfView::radius;
+		return x >= 0 && x < size && y >= 0 && y < size && visible[y * size + x];
+	}
+
+private:
+	//Slopes are (2 * column -/+ 1) / (2 * depth) fractions, compared by cross multiplying
+	void scan(std::uint32_t quadrant, std::int32_t depth, std::int32_t startNumerator, std::int32_t startDenominator, std::int32_t endNumerator, std::int32_t endDenominator)
+	{
+		if(depth > FieldOfView::radius)
+			return;
+
+		//Rounds half up at the start and half down at the end
+		auto minColumn = static_cast<std::int32_t>(std::floor(double(depth) * startNumerator / startDenominator + 0.5));
+		auto maxColumn = static_cast<std::int32_t>(std::ceil(double(depth) * endNumerator / endDenominator - 0.5));
+
+		std::optional<bool> wasWall;
+		for(auto column = minColumn; column <= maxColumn; column++)
+		{
+			auto [cellX, cellY] = getQuadrantCell(quadrant, depth, column);
+			bool isWall = World::getIsWall(cellX, cellY);
+			bool isSymmetric = column * startDenominator >= depth * startNumerator && column * endDenominator <= depth * endNumerator;
+			if((isWall || isSymmetric) && column * column + depth * depth <= FieldOfView::radius * FieldOfView::radius + FieldOfView::radius)
+				visible[(cellY - originY + FieldOfView::radius) * size + cellX - originX + FieldOfView::radius] = true;
+
+			if(wasWall == true && !isWall)
+			{
+				startNumerator = 2 * column - 1;
+				startDenominator = 2 * depth;
+			}
+			if(wasWall == false && isWall)
+				scan(quadrant, depth + 1, startNumerator, startDenominator, 2 * column - 1, 2 * depth);
+			wasWall = isWall;
+		}
+
+		if(wasWall == false)
+			scan(quadrant, depth + 1, startNumerator, startDenominator, endNumerator, endDenominator);
+	}
+
+	std::pair<std::int32_t, std::int32_t> getQuadrantCell(std::uint32_t quadrant, std::int32_t depth, std::int32_t column) const
+	{
+		switch(quadrant)
+		{
+			case 0: return {originX + column, originY - depth};
+			case 1: return {originX + depth, originY + column};
+			case 2: return {originX + column, originY + depth};
+			default: return {originX - depth, originY + column};
+		}
+	}
+
+	std::int32_t originX, originY;
+	std::vector<bool> visible = std::vector<bool>(size * size);
+};
+
+int main(int argc, char** argv)
+{
+	std::uint64_t originCount{200}, seed{1};
+	if(argc > 3 || (argc > 1 && !parseArgument(argv[1], originCount)) || (argc > 2 && !parseArgument(argv[2], seed)) || originCount == 0)
+	{
+		std::println("Usage: FieldOfViewBenchmark [origins] [seed]");
+		return 1;
+	}
+
+	//The world and job system log through the same files as the game
+	if(!Logger::init())
+		return 1;
+
+	if(!JobSystem::init())
+	{
+		std::println("Failed to start the job system");
+		return 1;
+	}
+	World::init(seed);
+
+	auto [levelOffsetX, levelOffsetY] = World::getLevelOffset();
+	std::mt19937_64 random{seed};
+	std::uniform_int_distribution<std::int32_t> cellXDistribution{-levelOffsetX, World::levelSize - 1 - levelOffsetX};
+	std::uniform_int_distribution<std::int32_t> cellYDistribution{-levelOffsetY, World::levelSize - 1 - levelOffsetY};
+
+	std::vector<double> times;
+	std::uint64_t visibleCount{}, mismatchCount{};
+	for(std::uint64_t origin = 0; origin < originCount; origin++)
+	{
+		std::int32_t cellX, cellY;
+		do
+		{
+			cellX = cellXDistribution(random);
+			cellY = cellYDistribution(random);
+		} while(World::getIsLevelWall(cellX, cellY));
+
+		//Everything the field of view can reach has to be resident, or both scans would only see solid chunks
+		auto chunkX = cellX >> Chunk::sizeShift, chunkY = cellY >> Chunk::sizeShift;
+		auto getIsLoaded = [&]()
+		{
+			for(auto y = chunkY - World::viewRadius; y <= chunkY + World::viewRadius; y++)
+				for(auto x = chunkX - World::viewRadius; x <= chunkX + World::viewRadius; x++)
+					if(!World::findChunk(x, y))
+						return false;
+			return true;
+		};
+		do
+		{
+			World::update((cellX + 0.5) * World::cellWidth, (cellY + 0.5) * World::cellHeight);
+			std::this_thread::yield();
+		} while(!getIsLoaded());
+
+		//Includes copying the chunk window, the origin always lands in another chunk
+		auto startTime = std::chrono::steady_clock::now();
+		FieldOfView::update(cellX, cellY);
+		std::chrono::duration<double, std::micro> duration = std::chrono::steady_clock::now() - startTime;
+		times.push_back(duration.count());
+
+		ReferenceScan reference(cellX, cellY);
+		for(auto y = cellY - FieldOfView::radius - 1; y <= cellY + FieldOfView::radius + 1; y++)
+		{
+			for(auto x = cellX - FieldOfView::radius - 1; x <= cellX + FieldOfView::radius + 1; x++)
+			{
+				bool isVisible = FieldOfView::getIsVisible(x, y);
+				visibleCount += isVisible;
+				if(isVisible == reference.getIsVisible(x, y))
+					continue;
+				if(mismatchCount++ < 10)
+					std::println("Cell {},{} seen from {},{} is {} but the reference scan says otherwise", x, y, cellX, cellY, isVisible ? "visible" : "hidden");
+			}
+		}
+	}
+
+	FieldOfView::release();
+	World::release();
+	JobSystem::release();
+
+	std::ranges::sort(times);
+	auto highTime = times[times.size() * 99 / 100];
+	std::println("Computed field of view with radius {} from {} origins", FieldOfView::radius, originCount);
+	std::println("\tMin: {:.1f} us", times.front());
+	std::println("\t50%: {:.1f} us", times[times.size() / 2]);
+	std::println("\t99%: {:.1f} us", highTime);
+	std::println("\tMax: {:.1f} us", times.back());
+	std::println("\tVisible cells: {:.0f} on average", double(visibleCount) / originCount);
+
+	if(mismatchCount != 0)
+	{
+		std::println("{} cells differ from the reference scan", mismatchCount);
+		return 1;
+	}
+	if(highTime > budgetUs)
+	{
+		std::println("Over the budget of {} us", budgetUs);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,146 @@
+import std;
+import Logger;
+import JobSystem;
+import Constants;
+import World;
+import InfluenceMap;
+
+//Has to leave the rest of the tick to the simulation
+constexpr double budgetMs{Constants::tickDuration * 1000.0 / 10.0};
+
+bool parseArgument(std::string_view argument, std::uint64_t& value)
+{
+	auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), value);
+	return error == std::errc{} && end == argument.data() + argument.size();
+}
+
+struct Source
+{
+	InfluenceMap::Layer layer;
+	std::int32_t offsetX, offsetY;
+	float strength;
+};
+
+int main(int argc, char** argv)
+{
+	std::uint64_t tickCount{500}, sourceCount{300}, seed{1};
+	if(argc > 4 || (argc > 1 && !parseArgument(argv[1], tickCount)) || (argc > 2 && !parseArgument(argv[2], sourceCount)) || (argc > 3 && !parseArgument(argv[3], seed)) ||
+	   tickCount == 0)
+	{
+		std::println("Usage: InfluenceMapBenchmark [ticks] [sources] [seed]");
+		return 1;
+	}
+
+	//The job system logs through the same files as the game
+	if(!Logger::init())
+		return 1;
+
+	if(!JobSystem::init())
+	{
+		std::println("Failed to start the job system");
+		return 1;
+	}
+
+	//The area follows the center in whole blocks, cells this close to the center are always inside it
+	constexpr std::int32_t coveredDistance{InfluenceMap::size / 2 - InfluenceMap::blockSize - 1};
+	constexpr std::uint64_t checkInterval{50};
+
+	//Shots and the player are threats that move every tick, the rest are enemies crowding that only move now and then
+	std::mt19937_64 random{seed};
+	std::uniform_int_distribution<std::int32_t> offsetDistribution{-coveredDistance, coveredDistance};
+	std::uniform_int_distribution<std::int32_t> stepDistribution{-1, 1};
+	std::vector<Source> sources;
+	for(std::uint64_t i = 0; i < sourceCount; i++)
+	{
+		bool isThreat = i % 8 == 0;
+		sources.push_back({isThreat ? InfluenceMap::Layer::threat : InfluenceMap::Layer::crowding, offsetDistribution(random), offsetDistribution(random), isThreat ? 4.0f : 1.0f});
+	}
+
+	std::vector<double> times;
+	std::int32_t centerX{}, centerY{};
+	std::uint64_t checkedCount{}, mismatchCount{};
+	double maxError{};
+	for(std::uint64_t tick = 0; tick < tickCount; tick++)
+	{
+		//Walking diagonally the area has to move every few dozen ticks
+		centerX += 1;
+		centerY += tick % 2;
+
+		for(auto& source : sources)
+		{
+			if(source.layer == InfluenceMap::Layer::threat || random() % 4 == 0)
+			{
+				source.offsetX = std::clamp(source.offsetX + stepDistribution(random), -coveredDistance, coveredDistance);
+				source.offsetY = std::clamp(source.offsetY + stepDistribution(random), -coveredDistance, coveredDistance);
+			}
+			InfluenceMap::addSource(source.layer, (centerX + source.offsetX + 0.5) * World::cellWidth, (centerY + source.offsetY + 0.5) * World::cellHeight, source.strength);
+		}
+
+		auto startTime = std::chrono::steady_clock::now();
+		InfluenceMap::update(centerX, centerY);
+		std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+		times.push_back(duration.count());
+
+		if(tick % checkInterval != checkInterval - 1 && tick != tickCount - 1)
+			continue;
+
+		//Every source added to every cell it reaches, without splitting the blur into passes or blocks
+		constexpr std::int32_t checkedSize{2 * coveredDistance + 1};
+		std::array<std::vector<double>, InfluenceMap::layerCount> expected;
+		expected.fill(std::vector<double>(checkedSize * checkedSize));
+		for(auto const& source : sources)
+		{
+			for(auto y = std::max(source.offsetY - InfluenceMap::radius, -coveredDistance); y <= std::min(source.offsetY + InfluenceMap::radius, coveredDistance); y++)
+			{
+				for(auto x = std::max(source.offsetX - InfluenceMap::radius, -coveredDistance); x <= std::min(source.offsetX + InfluenceMap::radius, coveredDistance); x++)
+				{
+					auto falloff = std::pow(double(InfluenceMap::decay), std::abs(x - source.offsetX)) * std::pow(double(InfluenceMap::decay), std::abs(y - source.offsetY));
+					expected[std::to_underlying(source.layer)][(y + coveredDistance) * checkedSize + x + coveredDistance] += source.strength * falloff;
+				}
+			}
+		}
+
+		for(std::uint32_t layer = 0; layer < InfluenceMap::layerCount; layer++)
+		{
+			for(auto y = -coveredDistance; y <= coveredDistance; y++)
+			{
+				for(auto x = -coveredDistance; x <= coveredDistance; x++)
+				{
+					auto expectedValue = expected[layer][(y + coveredDistance) * checkedSize + x + coveredDistance];
+					auto value = InfluenceMap::sample(InfluenceMap::Layer{layer}, (centerX + x + 0.5) * World::cellWidth, (centerY + y + 0.5) * World::cellHeight);
+					auto error = std::abs(value - expectedValue);
+					maxError = std::max(maxError, error);
+					checkedCount++;
+					if(error <= 1e-4 * std::max(1.0, expectedValue))
+						continue;
+					if(mismatchCount++ < 10)
+						std::println("Layer {} at cell {},{} after tick {} holds {} instead of {}", layer, centerX + x, centerY + y, tick, value, expectedValue);
+				}
+			}
+		}
+	}
+
+	auto threadCount = JobSystem::getThreadCount();
+	InfluenceMap::release();
+	JobSystem::release();
+
+	std::ranges::sort(times);
+	auto medianTime = times[times.size() / 2];
+	std::println("Updated {}x{} influence map with {} sources for {} ticks on {} threads", InfluenceMap::size, InfluenceMap::size, sourceCount, tickCount, threadCount);
+	std::println("\tMin: {:.3f} ms", times.front());
+	std::println("\t50%: {:.3f} ms", medianTime);
+	std::println("\tMax: {:.3f} ms", times.back());
+	std::println("\tChecked: {} cells, largest error {:.2e}", checkedCount, maxError);
+
+	if(mismatchCount != 0)
+	{
+		std::println("{} cells differ from summing the sources", mismatchCount);
+		return 1;
+	}
+	if(medianTime > budgetMs)
+	{
+		std::println("Over the budget of {} ms", budgetMs);
+		return 1;
+	}
+	return 0;
+}
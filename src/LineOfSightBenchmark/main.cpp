@@ -0,0 +1,133 @@
+import std;
+import Logger;
+import JobSystem;
+import World;
+import LineOfSight;
+
+//Every enemy near the player checks whether it sees it once a tick
+constexpr double budgetMs{1.0};
+
+bool parseArgument(std::string_view argument, std::uint64_t& value)
+{
+	auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), value);
+	return error == std::errc{} && end == argument.data() + argument.size();
+}
+
+int main(int argc, char** argv)
+{
+	std::uint64_t runCount{20}, queryCount{5000}, seed{1};
+	if(argc > 4 || (argc > 1 && !parseArgument(argv[1], runCount)) || (argc > 2 && !parseArgument(argv[2], queryCount)) || (argc > 3 && !parseArgument(argv[3], seed)) ||
+	   runCount == 0 || queryCount == 0)
+	{
+		std::println("Usage: LineOfSightBenchmark [runs] [queries] [seed]");
+		return 1;
+	}
+
+	//The world and job system log through the same files as the game
+	if(!Logger::init())
+		return 1;
+
+	if(!JobSystem::init())
+	{
+		std::println("Failed to start the job system");
+		return 1;
+	}
+	World::init(seed);
+
+	auto [levelOffsetX, levelOffsetY] = World::getLevelOffset();
+	std::mt19937_64 random{seed};
+	std::uniform_int_distribution<std::int32_t> cellXDistribution{-levelOffsetX, World::levelSize - 1 - levelOffsetX};
+	std::uniform_int_distribution<std::int32_t> cellYDistribution{-levelOffsetY, World::levelSize - 1 - levelOffsetY};
+	std::uniform_int_distribution<std::int32_t> offsetDistribution{-LineOfSight::maxDistance, LineOfSight::maxDistance};
+
+	std::vector<double> coldTimes, cachedTimes;
+	std::uint64_t visibleCount{}, mismatchCount{};
+	for(std::uint64_t run = 0; run < runCount; run++)
+	{
+		std::int32_t playerX, playerY;
+		do
+		{
+			playerX = cellXDistribution(random);
+			playerY = cellYDistribution(random);
+		} while(World::getIsLevelWall(playerX, playerY));
+
+		//Enemies stand on open cells inside the view radius, like the ones that would bother checking
+		std::vector<std::pair<std::int32_t, std::int32_t>> enemies;
+		while(enemies.size() < queryCount)
+		{
+			auto offsetX = offsetDistribution(random), offsetY = offsetDistribution(random);
+			if(offsetX * offsetX + offsetY * offsetY <= LineOfSight::maxDistance * LineOfSight::maxDistance && !World::getIsLevelWall(playerX + offsetX, playerY + offsetY))
+				enemies.emplace_back(playerX + offsetX, playerY + offsetY);
+		}
+
+		auto chunkX = playerX >> Chunk::sizeShift, chunkY = playerY >> Chunk::sizeShift;
+		auto getIsLoaded = [&]()
+		{
+			for(auto y = chunkY - World::viewRadius; y <= chunkY + World::viewRadius; y++)
+				for(auto x = chunkX - World::viewRadius; x <= chunkX + World::viewRadius; x++)
+					if(!World::findChunk(x, y))
+						return false;
+			return true;
+		};
+		do
+		{
+			World::update((playerX + 0.5) * World::cellWidth, (playerY + 0.5) * World::cellHeight);
+			std::this_thread::yield();
+		} while(!getIsLoaded());
+
+		//First batch misses the cache everywhere, the second is answered from it
+		LineOfSight::release();
+		std::array<std::vector<bool>, 2> answers;
+		for(std::uint32_t batch = 0; batch < 2; batch++)
+		{
+			std::vector<std::uint32_t> queries;
+			for(auto [enemyX, enemyY] : enemies)
+				queries.push_back(LineOfSight::request(enemyX, enemyY, playerX, playerY));
+
+			auto startTime = std::chrono::steady_clock::now();
+			LineOfSight::resolve();
+			std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+			(batch == 0 ? coldTimes : cachedTimes).push_back(duration.count());
+
+			for(auto query : queries)
+				answers[batch].push_back(LineOfSight::getIsVisible(query));
+		}
+
+		visibleCount += std::ranges::count(answers[0], true);
+		for(std::size_t i = 0; i < enemies.size(); i++)
+		{
+			if(answers[0][i] == answers[1][i])
+				continue;
+			if(mismatchCount++ < 10)
+				std::println("Line from {},{} to {},{} is {} traced but {} cached", enemies[i].first, enemies[i].second, playerX, playerY,
+							 answers[0][i] ? "clear" : "blocked", answers[1][i] ? "clear" : "blocked");
+		}
+	}
+
+	auto threadCount = JobSystem::getThreadCount();
+	LineOfSight::release();
+	World::release();
+	JobSystem::release();
+
+	std::ranges::sort(coldTimes);
+	std::ranges::sort(cachedTimes);
+	auto medianTime = coldTimes[coldTimes.size() / 2];
+	std::println("Resolved {} batches of {} line of sight checks on {} threads", runCount, queryCount, threadCount);
+	std::println("\tTraced min: {:.3f} ms", coldTimes.front());
+	std::println("\tTraced 50%: {:.3f} ms", medianTime);
+	std::println("\tTraced max: {:.3f} ms", coldTimes.back());
+	std::println("\tCached 50%: {:.3f} ms", cachedTimes[cachedTimes.size() / 2]);
+	std::println("\tVisible: {:.1f}%", 100.0 * visibleCount / (runCount * queryCount));
+
+	if(mismatchCount != 0)
+	{
+		std::println("{} cached answers differ from their traces", mismatchCount);
+		return 1;
+	}
+	if(medianTime > budgetMs)
+	{
+		std::println("Over the budget of {} ms", budgetMs);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,189 @@
+import std;
+import Logger;
+import JobSystem;
+import World;
+import PathFinder;
+
+//Paths across the level that were searched near where they were before, the usual case for a hunter following its target
+constexpr double budgetUs{1000.0};
+
+bool parseArgument(std::string_view argument, std::uint64_t& value)
+{
+	auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), value);
+	return error == std::errc{} && end == argument.data() + argument.size();
+}
+
+//Requests the path and updates until the search handed it back, in microseconds
+std::pair<double, std::vector<PathFinder::Cell>> findPath(PathFinder::Cell from, PathFinder::Cell to)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	auto request = PathFinder::request(from.first, from.second, to.first, to.second);
+	std::optional<std::vector<PathFinder::Cell>> path;
+	while(!(path = PathFinder::takePath(request)))
+	{
+		PathFinder::update();
+		std::this_thread::yield();
+	}
+	std::chrono::duration<double, std::micro> duration = std::chrono::steady_clock::now() - startTime;
+	return {duration.count(), std::move(*path)};
+}
+
+//Steps between neighbouring open cells from the start to the goal, diagonal ones not cutting past walls
+bool getIsValid(std::vector<PathFinder::Cell> const& path, PathFinder::Cell from, PathFinder::Cell to)
+{
+	if(path.empty() || path.front() != from || path.back() != to)
+		return false;
+
+	for(std::size_t i = 1; i < path.size(); i++)
+	{
+		auto [x, y] = path[i];
+		auto stepX = x - path[i - 1].first, stepY = y - path[i - 1].second;
+		if(std::abs(stepX) > 1 || std::abs(stepY) > 1 || (stepX == 0 && stepY == 0) || World::getIsLevelWall(x, y) ||
+		   (stepX != 0 && stepY != 0 && (World::getIsLevelWall(x - stepX, y) || World::getIsLevelWall(x, y - stepY))))
+			return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	std::uint64_t pathCount{20}, seed{1};
+	if(argc > 3 || (argc > 1 && !parseArgument(argv[1], pathCount)) || (argc > 2 && !parseArgument(argv[2], seed)) || pathCount == 0)
+	{
+		std::println("Usage: PathFinderBenchmark [paths] [seed]");
+		return 1;
+	}
+
+	//The world, the search and the job system log through the same files as the game
+	if(!Logger::init())
+		return 1;
+
+	if(!JobSystem::init())
+	{
+		std::println("Failed to start the job system");
+		return 1;
+	}
+	World::init(seed);
+
+	auto [levelOffsetX, levelOffsetY] = World::getLevelOffset();
+	std::mt19937_64 random{seed};
+	std::uniform_int_distribution<std::int32_t> cellXDistribution{-levelOffsetX, World::levelSize - 1 - levelOffsetX};
+	std::uniform_int_distribution<std::int32_t> cellYDistribution{-levelOffsetY, World::levelSize - 1 - levelOffsetY};
+	auto getOpenCell = [&]()
+	{
+		PathFinder::Cell cell;
+		do
+			cell = {cellXDistribution(random), cellYDistribution(random)};
+		while(World::getIsLevelWall(cell.first, cell.second));
+		return cell;
+	};
+
+	//Pockets of the level can be walled off from the rest, both ends are taken from the cells reachable from an open cell that leads through most of the level
+	//Diagonal steps can't cut past walls, so the cells reachable by straight steps are all there are
+	std::vector<std::uint8_t> isReachable;
+	std::uint64_t reachableCount{};
+	auto getIndex = [&](PathFinder::Cell cell) { return std::size_t(cell.first + levelOffsetX) + std::size_t(cell.second + levelOffsetY) * World::levelSize; };
+	while(reachableCount < std::uint64_t(World::levelSize) * World::levelSize / 8)
+	{
+		isReachable.assign(std::size_t(World::levelSize) * World::levelSize, 0);
+		std::vector<PathFinder::Cell> openCells{getOpenCell()};
+		isReachable[getIndex(openCells.front())] = 1;
+		reachableCount = 1;
+		while(!openCells.empty())
+		{
+			auto [x, y] = openCells.back();
+			openCells.pop_back();
+			for(PathFinder::Cell neighbour : {PathFinder::Cell{x + 1, y}, PathFinder::Cell{x - 1, y}, PathFinder::Cell{x, y + 1}, PathFinder::Cell{x, y - 1}})
+			{
+				if(World::getIsLevelWall(neighbour.first, neighbour.second) || isReachable[getIndex(neighbour)])
+					continue;
+				isReachable[getIndex(neighbour)] = 1;
+				reachableCount++;
+				openCells.push_back(neighbour);
+			}
+		}
+	}
+	auto getReachableCell = [&]()
+	{
+		PathFinder::Cell cell;
+		do
+			cell = getOpenCell();
+		while(!isReachable[getIndex(cell)]);
+		return cell;
+	};
+
+	std::vector<double> coldTimes, warmTimes, cachedTimes;
+	std::uint64_t invalidCount{}, missingCount{}, cellCount{};
+	for(std::uint64_t run = 0; run < pathCount; run++)
+	{
+		//Ends at least half the level apart along one axis
+		PathFinder::Cell from, to;
+		do
+		{
+			from = getReachableCell();
+			to = getReachableCell();
+		} while(std::max(std::abs(to.first - from.first), std::abs(to.second - from.second)) < World::levelSize / 2);
+
+		//An open neighbour of the start makes another query that misses the path cache but finds everything the first search built
+		PathFinder::Cell nearFrom{from};
+		for(auto [offsetX, offsetY] : {PathFinder::Cell{1, 0}, PathFinder::Cell{-1, 0}, PathFinder::Cell{0, 1}, PathFinder::Cell{0, -1}})
+		{
+			if(!World::getIsLevelWall(from.first + offsetX, from.second + offsetY))
+			{
+				nearFrom = {from.first + offsetX, from.second + offsetY};
+				break;
+			}
+		}
+
+		auto [coldTime, coldPath] = findPath(from, to);
+		auto [warmTime, warmPath] = findPath(nearFrom, to);
+		auto [cachedTime, cachedPath] = findPath(from, to);
+		coldTimes.push_back(coldTime);
+		warmTimes.push_back(warmTime);
+		cachedTimes.push_back(cachedTime);
+
+		//Both ends are reachable from each other, a missing path is a failed search
+		for(auto const& [path, pathFrom] : {std::pair{&coldPath, from}, std::pair{&warmPath, nearFrom}, std::pair{&cachedPath, from}})
+		{
+			if(path->empty())
+			{
+				if(missingCount++ < 10)
+					std::println("Found no path from {},{} to {},{}", pathFrom.first, pathFrom.second, to.first, to.second);
+			}
+			else if(!getIsValid(*path, pathFrom, to))
+			{
+				if(invalidCount++ < 10)
+					std::println("Path from {},{} to {},{} steps through walls or skips cells", pathFrom.first, pathFrom.second, to.first, to.second);
+			}
+		}
+		cellCount += coldPath.size();
+	}
+
+	auto threadCount = JobSystem::getThreadCount();
+	PathFinder::release();
+	World::release();
+	JobSystem::release();
+
+	std::ranges::sort(coldTimes);
+	std::ranges::sort(warmTimes);
+	std::ranges::sort(cachedTimes);
+	auto medianTime = warmTimes[warmTimes.size() / 2];
+	std::println("Found {} paths across a {}x{} level on {} threads, {} cells long on average", pathCount, World::levelSize, World::levelSize, threadCount, cellCount / pathCount);
+	std::println("\tCold 50%: {:.0f} us", coldTimes[coldTimes.size() / 2]);
+	std::println("\tWarm min: {:.0f} us", warmTimes.front());
+	std::println("\tWarm 50%: {:.0f} us", medianTime);
+	std::println("\tWarm max: {:.0f} us", warmTimes.back());
+	std::println("\tCached 50%: {:.0f} us", cachedTimes[cachedTimes.size() / 2]);
+
+	if(missingCount != 0 || invalidCount != 0)
+	{
+		std::println("{} paths missing, {} invalid", missingCount, invalidCount);
+		return 1;
+	}
+	if(medianTime > budgetUs)
+	{
+		std::println("Over the budget of {} us", budgetUs);
+		return 1;
+	}
+	return 0;
+}